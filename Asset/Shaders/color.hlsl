@@ -11,8 +11,9 @@ cbuffer FrameConstants : register(b0){
     float4 lightIntensity;
 };
 
+// the size must match Frame::maxInstances
 cbuffer ObjectConstants : register(b1){
-    matrix model;
+    matrix models[64];
 };
 
 cbuffer MaterialConstants : register(b2){
@@ -39,10 +40,11 @@ struct PSInput
     float2 uv : TEXCOORD0;
 };
 
-PSInput VSMain(VSInput input)
+PSInput VSMain(VSInput input, uint instanceID : SV_InstanceID)
 {
     PSInput output;
 
+    matrix model = models[instanceID];
     matrix MVP = mul(projView, model);
     output.position = mul(MVP, float4(input.position, 1.0f));
     output.normal = mul(view, mul(model, float4(input.normal, 0.0f)));
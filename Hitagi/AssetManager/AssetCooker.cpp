@@ -0,0 +1,246 @@
+#include "AssetCooker.hpp"
+#include "AssetManager.hpp"
+#include "ThreadManager.hpp"
+#include "TextureCompressor.hpp"
+
+#include "Assimp.hpp"
+#include "BinaryImage.hpp"
+#include "BinaryScene.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+namespace Hitagi::Asset {
+namespace {
+
+// Bump it when the cooked formats or the cooking change, so everything is cooked again
+constexpr uint64_t cookerVersion = 3;
+
+// FNV-1a
+constexpr uint64_t hashSeed = 14695981039346656037ull;
+uint64_t           Hash(const uint8_t* data, size_t size, uint64_t hash = hashSeed) {
+    for (size_t i = 0; i < size; i++) {
+        hash ^= data[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+template <typename T>
+uint64_t Hash(const T& value, uint64_t hash) {
+    return Hash(reinterpret_cast<const uint8_t*>(&value), sizeof(T), hash);
+}
+
+// The sources are read directly, the cache of FileIOManager would keep all of them
+std::optional<Core::Buffer> ReadFile(const std::filesystem::path& path) {
+    std::error_code ec;
+    const auto      size = std::filesystem::file_size(path, ec);
+    std::ifstream   ifs(path, std::ios::binary);
+    if (ec || !ifs) return std::nullopt;
+    if (size == 0) return Core::Buffer{};
+
+    Core::Buffer buffer(size);
+    ifs.read(reinterpret_cast<char*>(buffer.GetData()), buffer.GetDataSize());
+    if (!ifs) return std::nullopt;
+    return buffer;
+}
+
+bool IsInside(const std::filesystem::path& path, const std::filesystem::path& dir) {
+    auto relative = path.lexically_relative(dir);
+    return !relative.empty() && *relative.begin() != "..";
+}
+
+std::filesystem::path NormalizeDir(const std::filesystem::path& dir) {
+    auto result = dir.lexically_normal();
+    // remove the trailing separator
+    return result.has_filename() ? result : result.parent_path();
+}
+
+}  // namespace
+
+AssetCooker::AssetCooker(const std::filesystem::path& sourceDir, const std::filesystem::path& outputDir, CookOptions options)
+    : m_SourceDir(NormalizeDir(sourceDir)), m_OutputDir(NormalizeDir(outputDir)), m_Options(options) {}
+
+AssetCooker::AssetType AssetCooker::GetAssetType(const std::filesystem::path& path) const {
+    auto ext = path.extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return std::tolower(c); });
+
+    if (ext == ".fbx" || ext == ".obj" || ext == ".gltf" || ext == ".glb" || ext == ".dae" || ext == ".blend" || ext == ".3ds")
+        return AssetType::Scene;
+    if (ext == ".png" || ext == ".jpg" || ext == ".jpeg" || ext == ".tga" || ext == ".bmp")
+        return AssetType::Texture;
+    return AssetType::Other;
+}
+
+uint64_t AssetCooker::GetOptionsHash(AssetType type) const {
+    uint64_t hash = Hash(cookerVersion, Hash(type, hashSeed));
+    switch (type) {
+        case AssetType::Scene:
+            hash = Hash(m_Options.packVertices, hash);
+            hash = Hash(m_Options.interleaveVertices, hash);
+            for (auto&& level : m_Options.lodLevels) hash = Hash(level, hash);
+            return hash;
+        case AssetType::Texture:
+            hash = Hash(m_Options.textureCompression, Hash(m_Options.generateMips, hash));
+            for (auto&& suffix : m_Options.linearTextureSuffixes)
+                hash = Hash(reinterpret_cast<const uint8_t*>(suffix.data()), suffix.size() + 1, hash);
+            return hash;
+        default:
+            return hash;
+    }
+}
+
+bool AssetCooker::IsSource(const std::filesystem::path& path) const {
+    return IsInside(path, m_SourceDir) && !IsInside(path, m_OutputDir);
+}
+
+bool AssetCooker::IsLinearTexture(const std::filesystem::path& path) const {
+    auto lower = [](std::string str) {
+        std::transform(str.begin(), str.end(), str.begin(), [](unsigned char c) { return std::tolower(c); });
+        return str;
+    };
+    const auto stem = lower(path.stem().string());
+    return std::any_of(m_Options.linearTextureSuffixes.begin(), m_Options.linearTextureSuffixes.end(),
+                       [&](const std::string& suffix) { return stem.ends_with(lower(suffix)); });
+}
+
+std::filesystem::path AssetCooker::GetCookedPath(const std::filesystem::path& source) const {
+    auto result = m_OutputDir / source.lexically_normal().lexically_relative(m_SourceDir);
+    // the extension is appended, so a.png and a.jpg are cooked to different files
+    switch (GetAssetType(source)) {
+        case AssetType::Scene:
+            return result += ".hscene";
+        case AssetType::Texture:
+            return result += ".htex";
+        default:
+            return result;
+    }
+}
+
+bool AssetCooker::CookFile(const std::filesystem::path& source, const Core::Buffer& content, AssetType type) const {
+    auto       logger = spdlog::get("AssetManager");
+    const auto output = GetCookedPath(source);
+
+    switch (type) {
+        case AssetType::Scene: {
+            auto scene = AssimpParser(m_Options.packVertices, m_Options.interleaveVertices, m_Options.lodLevels).Parse(content, source);
+            // the parser returns an empty scene on an import error
+            if (!scene.SceneGraph || (scene.GeometryNodes.empty() && scene.CameraNodes.empty() && scene.LightNodes.empty())) {
+                logger->error("[Cooker] Can not parse the scene: {}", source.string());
+                return false;
+            }
+            // the textures of the source directory are cooked too
+            auto texturePath = [&](const std::filesystem::path& path) {
+                return IsSource(path) && GetAssetType(path) == AssetType::Texture ? GetCookedPath(path) : path;
+            };
+            return g_FileIOManager->SaveBuffer(WriteBinaryScene(scene, texturePath), output);
+        }
+        case AssetType::Texture: {
+            auto image = g_AssetManager->ParseImage(content, source);
+            if (image.Empty()) {
+                logger->error("[Cooker] Can not parse the texture: {}", source.string());
+                return false;
+            }
+            image = PrepareTexture(std::move(image), m_Options.generateMips, m_Options.textureCompression, !IsLinearTexture(source));
+            return g_FileIOManager->SaveBuffer(WriteBinaryImage(image), output);
+        }
+        default:
+            return g_FileIOManager->SaveBuffer(content, output);
+    }
+}
+
+AssetCooker::Statistics AssetCooker::Cook() {
+    auto logger = spdlog::get("AssetManager");
+    auto begin  = std::chrono::high_resolution_clock::now();
+    LoadDatabase();
+
+    std::vector<std::filesystem::path> sources;
+    for (auto&& entry : std::filesystem::recursive_directory_iterator(m_SourceDir)) {
+        if (entry.is_regular_file() && IsSource(entry.path().lexically_normal()))
+            sources.emplace_back(entry.path().lexically_normal());
+    }
+
+    enum struct Status { Cooked,
+                         Skipped,
+                         Failed };
+    struct Result {
+        std::string key;
+        Record      record;
+        Status      status;
+    };
+
+    auto cook = [this](const std::filesystem::path& source) -> Result {
+        const auto type    = GetAssetType(source);
+        const auto content = ReadFile(source);
+        Result     result{source.lexically_relative(m_SourceDir).generic_string(), Record{}, Status::Failed};
+        if (!content) return result;
+
+        result.record = Record{Hash(content->GetData(), content->GetDataSize()), GetOptionsHash(type)};
+        if (auto iter = m_Database.find(result.key); iter != m_Database.end() && iter->second == result.record && std::filesystem::exists(GetCookedPath(source))) {
+            result.status = Status::Skipped;
+            return result;
+        }
+        result.status = CookFile(source, *content, type) ? Status::Cooked : Status::Failed;
+        return result;
+    };
+
+    std::vector<std::future<Result>> futures;
+    std::vector<Result>              results;
+    for (auto&& source : sources) {
+        if (g_ThreadManager->IsRunning())
+            futures.emplace_back(g_ThreadManager->RunTask(cook, source));
+        else
+            results.emplace_back(cook(source));
+    }
+    for (auto&& future : futures) results.emplace_back(future.get());
+
+    // the failed sources are not recorded, so they are cooked again next time
+    Statistics                              statistics;
+    std::unordered_map<std::string, Record> database;
+    for (auto&& result : results) {
+        switch (result.status) {
+            case Status::Cooked:
+                statistics.cooked++;
+                break;
+            case Status::Skipped:
+                statistics.skipped++;
+                break;
+            case Status::Failed:
+                statistics.failed++;
+                logger->error("[Cooker] Failed to cook {}", result.key);
+                continue;
+        }
+        database.emplace(result.key, result.record);
+    }
+    SaveDatabase(database);
+    m_Database = std::move(database);
+
+    auto end = std::chrono::high_resolution_clock::now();
+    logger->info("[Cooker] {} cooked, {} up to date, {} failed, costs {} ms.", statistics.cooked, statistics.skipped, statistics.failed,
+                 std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count());
+    return statistics;
+}
+
+// A line of the database is "<content hash> <options hash> <source path>" in hex
+void AssetCooker::LoadDatabase() {
+    m_Database.clear();
+    std::ifstream ifs(m_OutputDir / databaseName);
+    for (std::string line; std::getline(ifs, line);) {
+        std::istringstream stream(line);
+        Record             record;
+        std::string        key;
+        if (stream >> std::hex >> record.contentHash >> record.optionsHash && stream.get() == ' ' && std::getline(stream, key))
+            m_Database.emplace(std::move(key), record);
+    }
+}
+
+void AssetCooker::SaveDatabase(const std::unordered_map<std::string, Record>& database) const {
+    std::filesystem::create_directories(m_OutputDir);
+    std::ofstream ofs(m_OutputDir / databaseName);
+    for (auto&& [key, record] : database)
+        ofs << fmt::format("{:016x} {:016x} {}\n", record.contentHash, record.optionsHash, key);
+}
+
+}  // namespace Hitagi::Asset
@@ -0,0 +1,71 @@
+#pragma once
+#include "Image.hpp"
+#include "MeshOptimizer.hpp"
+
+#include <filesystem>
+#include <unordered_map>
+
+namespace Hitagi::Asset {
+
+struct CookOptions {
+    // Pack the vertex attributes of the scenes to the smaller formats. It is off by default,
+    // since the color pipeline reads the normals and texcoords as floats without decoding
+    bool                     packVertices       = false;
+    // Interleave the vertex attributes other than the position
+    bool                     interleaveVertices = true;
+    std::vector<LODLevel>    lodLevels          = defaultLODLevels;
+    bool                     generateMips       = true;
+    PixelFormat              textureCompression = PixelFormat::BC7_UNORM;
+    // The material slots of a texture are unknown when it is cooked, so the textures whose name ends with one of
+    // these suffixes (case insensitive) are taken as non-color maps and filtered as linear, the others as sRGB
+    std::vector<std::string> linearTextureSuffixes = {"_n", "_nrm", "_normal", "_bump", "_height", "_rough", "_roughness", "_metal", "_metallic", "_ao", "_orm", "_mask"};
+};
+
+// Cook the source assets to the formats loaded without importing. Scenes are cooked to binary
+// scenes (.hscene) referring to the cooked textures, textures to binary images (.htex) with mips
+// and compression, and the other files, e.g. shaders and fonts, are copied.
+// The content hashes of the sources are kept in a database in the output directory, so a source
+// is cooked again only when its content or the options change. Sources are cooked on the thread pool.
+class AssetCooker {
+public:
+    struct Statistics {
+        size_t cooked  = 0;
+        size_t skipped = 0;
+        size_t failed  = 0;
+    };
+
+    AssetCooker(const std::filesystem::path& sourceDir, const std::filesystem::path& outputDir, CookOptions options = {});
+
+    Statistics            Cook();
+    std::filesystem::path GetCookedPath(const std::filesystem::path& source) const;
+
+    static constexpr std::string_view databaseName = "cook.db";
+
+private:
+    enum struct AssetType { Scene,
+                            Texture,
+                            Other };
+
+    struct Record {
+        uint64_t contentHash;
+        uint64_t optionsHash;
+        bool     operator==(const Record&) const = default;
+    };
+
+    AssetType GetAssetType(const std::filesystem::path& path) const;
+    uint64_t  GetOptionsHash(AssetType type) const;
+    bool      IsSource(const std::filesystem::path& path) const;
+    bool      IsLinearTexture(const std::filesystem::path& path) const;
+    bool      CookFile(const std::filesystem::path& source, const Core::Buffer& content, AssetType type) const;
+
+    void LoadDatabase();
+    void SaveDatabase(const std::unordered_map<std::string, Record>& database) const;
+
+    std::filesystem::path m_SourceDir;
+    std::filesystem::path m_OutputDir;
+    CookOptions           m_Options;
+    // Keyed by the path relative to the source directory
+    std::unordered_map<std::string, Record> m_Database;
+};
+
+}  // namespace Hitagi::Asset
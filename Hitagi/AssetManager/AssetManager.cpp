@@ -7,8 +7,13 @@
 #include "JPEG.hpp"
 #include "BMP.hpp"
 #include "TGA.hpp"
+#include "BinaryImage.hpp"
 
 #include "Assimp.hpp"
+#include "BinaryScene.hpp"
+
+#include "ThreadManager.hpp"
+#include "TextureCompressor.hpp"
 
 namespace Hitagi {
 std::unique_ptr<Asset::AssetManager> g_AssetManager = std::make_unique<Asset::AssetManager>();
@@ -24,39 +29,121 @@ int AssetManager::Initialize() {
     m_ImageParser[static_cast<size_t>(ImageFormat::JPEG)] = std::make_unique<JpegParser>();
     m_ImageParser[static_cast<size_t>(ImageFormat::TGA)]  = std::make_unique<TgaParser>();
     m_ImageParser[static_cast<size_t>(ImageFormat::BMP)]  = std::make_unique<BmpParser>();
+    m_ImageParser[static_cast<size_t>(ImageFormat::HTEX)] = std::make_unique<BinaryImageParser>();
 
-    m_SceneParser = std::make_unique<AssimpParser>();
+    m_SceneParser       = std::make_unique<AssimpParser>();
+    m_BinarySceneParser = std::make_unique<BinarySceneParser>();
     return 0;
 }
 
 void AssetManager::Tick() {}
 void AssetManager::Finalize() {
+    m_TextureCache.clear();
     m_Logger->info("Finalized.");
     m_Logger = nullptr;
 }
 
-Image AssetManager::ParseImage(const std::filesystem::path& path) const {
-    ImageFormat format = ImageFormat::NUM_SUPPORT;
+ImageFormat AssetManager::GetImageFormat(const Core::Buffer& buf, const std::filesystem::path& path) const {
+    if (auto format = DetectImageFormat(buf); format != ImageFormat::NUM_SUPPORT)
+        return format;
 
     auto ext = path.extension();
     if (ext == ".jpeg" || ext == ".jpg")
-        format = ImageFormat::JPEG;
+        return ImageFormat::JPEG;
     else if (ext == ".bmp")
-        format = ImageFormat::BMP;
+        return ImageFormat::BMP;
     else if (ext == ".tga")
-        format = ImageFormat::TGA;
+        return ImageFormat::TGA;
     else if (ext == ".png")
-        format = ImageFormat::PNG;
+        return ImageFormat::PNG;
+    else if (ext == ".htex")
+        return ImageFormat::HTEX;
+    return ImageFormat::NUM_SUPPORT;
+}
+
+Image AssetManager::ParseImage(const std::filesystem::path& path) const {
+    return ParseImage(*g_FileIOManager->SyncOpenAndReadBinary(path), path);
+}
 
+Image AssetManager::ParseImage(const Core::Buffer& buffer, const std::filesystem::path& path) const {
+    ImageFormat format = GetImageFormat(buffer, path);
     if (format >= ImageFormat::NUM_SUPPORT) {
         m_Logger->error("Unkown image format, and return a empty image");
         return Image{};
     }
-    return m_ImageParser[static_cast<size_t>(format)]->Parse(g_FileIOManager->SyncOpenAndReadBinary(path));
+    return m_ImageParser[static_cast<size_t>(format)]->Parse(buffer);
+}
+
+std::vector<std::future<Image>> AssetManager::ParseImagesAsync(std::span<const std::filesystem::path> paths) const {
+    std::vector<std::future<Image>> result;
+    result.reserve(paths.size());
+    for (auto&& path : paths) {
+        if (g_ThreadManager->IsRunning()) {
+            result.emplace_back(g_ThreadManager->RunTask([this, path] { return ParseImage(path); }));
+        } else {
+            std::promise<Image> promise;
+            promise.set_value(ParseImage(path));
+            result.emplace_back(promise.get_future());
+        }
+    }
+    return result;
+}
+
+std::shared_ptr<const Image> AssetManager::LoadTextureImage(const std::filesystem::path& path, bool sRGB) {
+    std::promise<std::shared_ptr<const Image>> promise;
+    TextureKey                                 key;
+    {
+        std::unique_lock lock(m_TextureCacheMutex);
+        key = {path, m_TextureCompression, m_TextureMipGeneration, sRGB};
+
+        auto [iter, inserted] = m_TextureCache.try_emplace(key);
+        auto& entry           = iter->second;
+        if (auto image = entry.image.lock()) return image;
+        if (entry.loading.valid()) {
+            auto loading = entry.loading;
+            lock.unlock();
+            return loading.get();
+        }
+        // The entries of the released images are dropped, so the cache only grows with the alive images
+        if (inserted) {
+            std::erase_if(m_TextureCache, [&](const auto& item) {
+                return &item.second != &entry && !item.second.loading.valid() && item.second.image.expired();
+            });
+        }
+        entry.loading = promise.get_future().share();
+    }
+
+    std::shared_ptr<const Image> result;
+    try {
+        result = std::make_shared<const Image>(PrepareTexture(ParseImage(path), std::get<2>(key), std::get<1>(key), sRGB));
+    } catch (...) {
+        {
+            std::lock_guard lock(m_TextureCacheMutex);
+            m_TextureCache.erase(key);
+        }
+        promise.set_exception(std::current_exception());
+        throw;
+    }
+
+    {
+        std::lock_guard lock(m_TextureCacheMutex);
+        auto&           entry = m_TextureCache[key];
+        entry.image           = result;
+        entry.loading         = {};
+    }
+    promise.set_value(result);
+    return result;
 }
 
 Scene AssetManager::ParseScene(const std::filesystem::path& path) const {
-    return m_SceneParser->Parse(g_FileIOManager->SyncOpenAndReadBinary(path), path);
+    const auto buffer = g_FileIOManager->SyncOpenAndReadBinary(path);
+    if (IsBinaryScene(*buffer))
+        return m_BinarySceneParser->Parse(*buffer, path);
+    return m_SceneParser->Parse(*buffer, path);
+}
+
+bool AssetManager::SaveScene(const Scene& scene, const std::filesystem::path& path) const {
+    return g_FileIOManager->SaveBuffer(WriteBinaryScene(scene), path);
 }
 
 }  // namespace Hitagi::Asset
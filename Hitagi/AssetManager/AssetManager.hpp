@@ -1,5 +1,8 @@
 #pragma once
 #include <map>
+#include <future>
+#include <span>
+#include <mutex>
 
 #include "FileIOManager.hpp"
 #include "ImageParser.hpp"
@@ -14,11 +17,45 @@ public:
     void Finalize() final;
 
     Image ParseImage(const std::filesystem::path& path) const;
+    // The path is used to guess the format when the magic bytes are unknown
+    Image ParseImage(const Core::Buffer& buffer, const std::filesystem::path& path) const;
+    // Read and decode the images on the thread pool, the futures are in the order of the paths.
+    // The images are decoded on the calling thread if the thread pool is not running.
+    std::vector<std::future<Image>> ParseImagesAsync(std::span<const std::filesystem::path> paths) const;
+    // Binary scenes written by SaveScene are loaded without Assimp
     Scene ParseScene(const std::filesystem::path& path) const;
+    bool  SaveScene(const Scene& scene, const std::filesystem::path& path) const;
+
+    // Load a texture image with the mips and compression settings below, the images are shared by path.
+    // Concurrent loads of a path wait for the same decoding, and an image is released with its last user.
+    // The mips of a color map (sRGB) are filtered in linear space, the ones of the other maps as they are.
+    std::shared_ptr<const Image> LoadTextureImage(const std::filesystem::path& path, bool sRGB);
+
+    // Textures loaded by scene objects are compressed to this format, UNKNOWN keeps them uncompressed.
+    inline void        SetTextureCompression(PixelFormat format) { m_TextureCompression = format; }
+    inline PixelFormat GetTextureCompression() const { return m_TextureCompression; }
+    // Generate the mip levels of textures loaded by scene objects
+    inline void SetTextureMipGeneration(bool enable) { m_TextureMipGeneration = enable; }
+    inline bool GetTextureMipGeneration() const { return m_TextureMipGeneration; }
 
 private:
+    // The format is detected by the magic bytes first, then the extension.
+    ImageFormat GetImageFormat(const Core::Buffer& buf, const std::filesystem::path& path) const;
+
+    // The image is loaded again if the settings or the color space are changed
+    using TextureKey = std::tuple<std::filesystem::path, PixelFormat, bool, bool>;
+    struct TextureCacheEntry {
+        std::weak_ptr<const Image>                       image;
+        std::shared_future<std::shared_ptr<const Image>> loading;
+    };
+
     std::array<std::unique_ptr<ImageParser>, static_cast<size_t>(ImageFormat::NUM_SUPPORT)> m_ImageParser;
     std::unique_ptr<SceneParser>                                                            m_SceneParser;
+    std::unique_ptr<SceneParser>                                                            m_BinarySceneParser;
+    PixelFormat                                                                             m_TextureCompression   = PixelFormat::UNKNOWN;
+    bool                                                                                    m_TextureMipGeneration = true;
+    std::map<TextureKey, TextureCacheEntry>                                                 m_TextureCache;
+    std::mutex                                                                              m_TextureCacheMutex;
 };
 }  // namespace Hitagi::Asset
 
@@ -0,0 +1,267 @@
+#include "BoundingVolumeHierarchy.hpp"
+
+#include <algorithm>
+
+namespace Hitagi::Asset {
+namespace {
+// Half of the surface area, only the ratio matters in the cost
+float HalfArea(const Box& box) {
+    if (box.Empty()) return 0.0f;
+    const vec3f size = box.bbMax - box.bbMin;
+    return size.x * size.y + size.y * size.z + size.z * size.x;
+}
+}  // namespace
+
+void BoundingVolumeHierarchy::Build(const TransformHierarchy& hierarchy, std::vector<Item> items) {
+    m_Nodes.clear();
+    m_Parents.clear();
+    m_Items.clear();
+    m_WorldBounds.clear();
+    m_ItemOfNode.assign(hierarchy.Size(), nullIndex);
+
+    for (auto&& item : items) {
+        if (item.localBound.Empty() || item.hierarchyIndex >= hierarchy.Size()) continue;
+        m_Items.emplace_back(item);
+        m_WorldBounds.emplace_back(Transform(item.localBound, hierarchy.GetWorldTransform(item.hierarchyIndex)));
+    }
+    m_LeafOfItem.assign(m_Items.size(), nullIndex);
+    if (m_Items.empty()) return;
+
+    // A binary tree of n leaves has 2n - 1 nodes at most
+    m_Nodes.reserve(2 * m_Items.size());
+    m_Parents.reserve(2 * m_Items.size());
+    m_Nodes.emplace_back(Node{Box(), 0, static_cast<uint32_t>(m_Items.size())});
+    m_Parents.emplace_back(nullIndex);
+
+    // The children are appended after their parent, so the bounds can be refitted by a reverse pass
+    std::vector<uint32_t> stack = {0};
+    while (!stack.empty()) {
+        const uint32_t index = stack.back();
+        stack.pop_back();
+        Split(index);
+
+        const auto& node = m_Nodes[index];
+        if (node.count == 0) {
+            stack.emplace_back(node.first);
+            stack.emplace_back(node.first + 1);
+        } else {
+            for (uint32_t i = node.first; i < node.first + node.count; i++) {
+                m_LeafOfItem[i]                         = index;
+                m_ItemOfNode[m_Items[i].hierarchyIndex] = i;
+            }
+        }
+    }
+}
+
+void BoundingVolumeHierarchy::Split(uint32_t nodeIndex) {
+    const uint32_t first = m_Nodes[nodeIndex].first, count = m_Nodes[nodeIndex].count;
+
+    Box bound, centroidBound;
+    for (uint32_t i = first; i < first + count; i++) {
+        bound         = Merge(bound, m_WorldBounds[i]);
+        centroidBound = Merge(centroidBound, m_WorldBounds[i].Center());
+    }
+    m_Nodes[nodeIndex].bound = bound;
+    if (count <= maxLeafSize) return;
+
+    auto binOf = [&](const Box& bound, unsigned axis) {
+        const float scale = binCount / (centroidBound.bbMax[axis] - centroidBound.bbMin[axis]);
+        return std::min(binCount - 1, static_cast<size_t>((bound.Center()[axis] - centroidBound.bbMin[axis]) * scale));
+    };
+
+    // Put the centroids into the bins on each axis, and find the boundary of the bins with the least cost
+    // left area * left count + right area * right count
+    int    bestAxis = -1;
+    size_t bestBin  = 0;
+    float  bestCost = std::numeric_limits<float>::max();
+    for (unsigned axis = 0; axis < 3; axis++) {
+        if (centroidBound.bbMax[axis] <= centroidBound.bbMin[axis]) continue;
+
+        struct Bin {
+            Box      bound;
+            uint32_t count = 0;
+        };
+        std::array<Bin, binCount> bins;
+        for (uint32_t i = first; i < first + count; i++) {
+            auto& bin = bins[binOf(m_WorldBounds[i], axis)];
+            bin.bound = Merge(bin.bound, m_WorldBounds[i]);
+            bin.count++;
+        }
+
+        std::array<float, binCount>    leftCosts;
+        std::array<uint32_t, binCount> leftCounts;
+        Box                            leftBound;
+        uint32_t                       leftCount = 0;
+        for (size_t bin = 0; bin < binCount; bin++) {
+            leftBound       = Merge(leftBound, bins[bin].bound);
+            leftCount      += bins[bin].count;
+            leftCosts[bin]  = leftCount * HalfArea(leftBound);
+            leftCounts[bin] = leftCount;
+        }
+        Box      rightBound;
+        uint32_t rightCount = 0;
+        for (size_t bin = binCount - 1; bin > 0; bin--) {
+            rightBound = Merge(rightBound, bins[bin].bound);
+            rightCount += bins[bin].count;
+            if (leftCounts[bin - 1] == 0 || rightCount == 0) continue;
+
+            const float cost = leftCosts[bin - 1] + rightCount * HalfArea(rightBound);
+            if (cost < bestCost) {
+                bestCost = cost;
+                bestAxis = axis;
+                bestBin  = bin;
+            }
+        }
+    }
+
+    // All the centroids are at the same point, split the items in half
+    uint32_t middle = first + count / 2;
+    if (bestAxis >= 0) {
+        middle = first;
+        for (uint32_t i = first; i < first + count; i++) {
+            if (binOf(m_WorldBounds[i], bestAxis) >= bestBin) continue;
+            std::swap(m_Items[i], m_Items[middle]);
+            std::swap(m_WorldBounds[i], m_WorldBounds[middle]);
+            middle++;
+        }
+    }
+
+    const auto left          = static_cast<uint32_t>(m_Nodes.size());
+    m_Nodes[nodeIndex].first = left;
+    m_Nodes[nodeIndex].count = 0;
+    m_Nodes.emplace_back(Node{Box(), first, middle - first});
+    m_Nodes.emplace_back(Node{Box(), middle, first + count - middle});
+    m_Parents.emplace_back(nodeIndex);
+    m_Parents.emplace_back(nodeIndex);
+}
+
+void BoundingVolumeHierarchy::Refit(const TransformHierarchy& hierarchy) {
+    // The tree is built from another hierarchy
+    if (m_Items.empty() || m_ItemOfNode.size() != hierarchy.Size()) return;
+
+    std::vector<uint32_t> leaves;
+    for (auto index : hierarchy.GetChangedNodes()) {
+        const uint32_t item = m_ItemOfNode[index];
+        if (item == nullIndex) continue;
+        m_WorldBounds[item] = Transform(m_Items[item].localBound, hierarchy.GetWorldTransform(index));
+        leaves.emplace_back(m_LeafOfItem[item]);
+    }
+    if (leaves.empty()) return;
+
+    // Walk up from the changed leaves if only a few of them changed, otherwise refit all the nodes
+    if (leaves.size() * 16 < m_Nodes.size()) {
+        for (auto leaf : leaves)
+            for (uint32_t index = leaf; index != nullIndex; index = m_Parents[index]) UpdateBound(index);
+    } else {
+        for (auto index = static_cast<uint32_t>(m_Nodes.size()); index-- > 0;) UpdateBound(index);
+    }
+}
+
+void BoundingVolumeHierarchy::UpdateBound(uint32_t nodeIndex) {
+    auto& node = m_Nodes[nodeIndex];
+    if (node.count == 0) {
+        node.bound = Merge(m_Nodes[node.first].bound, m_Nodes[node.first + 1].bound);
+        return;
+    }
+    Box bound;
+    for (uint32_t i = node.first; i < node.first + node.count; i++) bound = Merge(bound, m_WorldBounds[i]);
+    node.bound = bound;
+}
+
+template <typename Overlap>
+std::vector<std::reference_wrapper<SceneGeometryNode>> BoundingVolumeHierarchy::Collect(Overlap&& overlap) const {
+    std::vector<std::reference_wrapper<SceneGeometryNode>> result;
+    if (m_Nodes.empty()) return result;
+
+    std::vector<uint32_t> stack = {0};
+    while (!stack.empty()) {
+        const uint32_t index = stack.back();
+        stack.pop_back();
+
+        const auto& node        = m_Nodes[index];
+        const auto  containment = overlap(node.bound);
+        if (containment == ContainmentType::Disjoint) continue;
+        if (containment == ContainmentType::Contains) {
+            // The items of a subtree are a contiguous range from its leftmost leaf to its rightmost leaf
+            uint32_t leftmost = index, rightmost = index;
+            while (m_Nodes[leftmost].count == 0) leftmost = m_Nodes[leftmost].first;
+            while (m_Nodes[rightmost].count == 0) rightmost = m_Nodes[rightmost].first + 1;
+            for (uint32_t i = m_Nodes[leftmost].first; i < m_Nodes[rightmost].first + m_Nodes[rightmost].count; i++)
+                result.emplace_back(*m_Items[i].node);
+            continue;
+        }
+        if (node.count == 0) {
+            stack.emplace_back(node.first + 1);
+            stack.emplace_back(node.first);
+            continue;
+        }
+        for (uint32_t i = node.first; i < node.first + node.count; i++)
+            if (overlap(m_WorldBounds[i]) != ContainmentType::Disjoint) result.emplace_back(*m_Items[i].node);
+    }
+    return result;
+}
+
+std::vector<std::reference_wrapper<SceneGeometryNode>> BoundingVolumeHierarchy::Query(const Frustum& frustum) const {
+    return Collect([&](const Box& bound) { return Classify(frustum, bound); });
+}
+
+std::vector<std::reference_wrapper<SceneGeometryNode>> BoundingVolumeHierarchy::Query(const Box& box) const {
+    return Collect([&](const Box& bound) {
+        if (!Intersect(box, bound)) return ContainmentType::Disjoint;
+        return Contains(box, bound) ? ContainmentType::Contains : ContainmentType::Intersects;
+    });
+}
+
+std::vector<std::reference_wrapper<SceneGeometryNode>> BoundingVolumeHierarchy::Query(const Sphere& sphere) const {
+    return Collect([&](const Box& bound) {
+        if (!Intersect(bound, sphere)) return ContainmentType::Disjoint;
+        // The farthest corner of the box is in the sphere
+        vec3f corner(0.0f);
+        for (unsigned i = 0; i < 3; i++)
+            corner[i] = std::max(std::abs(bound.bbMin[i] - sphere.position[i]), std::abs(bound.bbMax[i] - sphere.position[i]));
+        return dot(corner, corner) <= sphere.radius * sphere.radius ? ContainmentType::Contains : ContainmentType::Intersects;
+    });
+}
+
+std::optional<BoundingVolumeHierarchy::RayHit> BoundingVolumeHierarchy::Raycast(const Ray& ray) const {
+    std::optional<RayHit> result;
+    if (m_Nodes.empty()) return result;
+
+    auto rootDistance = Intersect(ray, m_Nodes.front().bound);
+    if (!rootDistance) return result;
+
+    // Visit the nearer child first, and skip the nodes farther than the nearest hit
+    float                                   nearest = std::numeric_limits<float>::infinity();
+    std::vector<std::pair<uint32_t, float>> stack   = {{0, *rootDistance}};
+    while (!stack.empty()) {
+        const auto [index, distance] = stack.back();
+        stack.pop_back();
+        if (distance >= nearest) continue;
+
+        const auto& node = m_Nodes[index];
+        if (node.count != 0) {
+            for (uint32_t i = node.first; i < node.first + node.count; i++) {
+                if (auto hit = Intersect(ray, m_WorldBounds[i]); hit && *hit < nearest) {
+                    nearest = *hit;
+                    result  = RayHit{m_Items[i].node, *hit};
+                }
+            }
+            continue;
+        }
+
+        auto left  = Intersect(ray, m_Nodes[node.first].bound);
+        auto right = Intersect(ray, m_Nodes[node.first + 1].bound);
+        if (left && right) {
+            const bool leftFirst = *left <= *right;
+            stack.emplace_back(leftFirst ? node.first + 1 : node.first, leftFirst ? *right : *left);
+            stack.emplace_back(leftFirst ? node.first : node.first + 1, leftFirst ? *left : *right);
+        } else if (left) {
+            stack.emplace_back(node.first, *left);
+        } else if (right) {
+            stack.emplace_back(node.first + 1, *right);
+        }
+    }
+    return result;
+}
+
+}  // namespace Hitagi::Asset
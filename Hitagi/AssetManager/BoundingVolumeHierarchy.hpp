@@ -0,0 +1,75 @@
+#pragma once
+#include "TransformHierarchy.hpp"
+
+#include <optional>
+#include <span>
+
+namespace Hitagi::Asset {
+
+// A bounding volume hierarchy over the world bounds of the geometry nodes, for culling, picking and the
+// broadphase of physics. It is built with the binned surface area heuristic, and refitted with the nodes
+// changed by the last update of the transform hierarchy. The refitted tree gets worse as the nodes move
+// far, so it should be built again after a large change.
+class BoundingVolumeHierarchy {
+public:
+    static constexpr size_t maxLeafSize = 4;
+    static constexpr size_t binCount    = 16;
+
+    struct Item {
+        SceneGeometryNode* node;
+        // The index of the node in the transform hierarchy
+        size_t             hierarchyIndex;
+        Box                localBound;
+    };
+
+    struct RayHit {
+        SceneGeometryNode* node;
+        float              distance;
+    };
+
+    // The items with an empty bound are ignored, the world bounds are calculated from the hierarchy
+    void Build(const TransformHierarchy& hierarchy, std::vector<Item> items);
+    // Update the bounds of the items whose node changed in the last update of the hierarchy
+    void Refit(const TransformHierarchy& hierarchy);
+
+    std::vector<std::reference_wrapper<SceneGeometryNode>> Query(const Frustum& frustum) const;
+    std::vector<std::reference_wrapper<SceneGeometryNode>> Query(const Box& box) const;
+    std::vector<std::reference_wrapper<SceneGeometryNode>> Query(const Sphere& sphere) const;
+    // The nearest node whose world bound is hit by the ray
+    std::optional<RayHit> Raycast(const Ray& ray) const;
+
+    size_t      Size() const noexcept { return m_Items.size(); }
+    bool        Empty() const noexcept { return m_Items.empty(); }
+    const Item& GetItem(size_t index) const { return m_Items[index]; }
+    // The bound of all the items
+    Box         GetBound() const { return m_Nodes.empty() ? Box() : m_Nodes.front().bound; }
+    // The world bounds of the items are packed in the order of the items, so they can be tested in batches
+    std::span<const Box> GetWorldBounds() const noexcept { return m_WorldBounds; }
+
+private:
+    static constexpr uint32_t nullIndex = std::numeric_limits<uint32_t>::max();
+
+    // The children of an inner node are adjacent, a leaf owns a range of m_Items
+    struct Node {
+        Box      bound;
+        // The first child of an inner node, or the first item of a leaf
+        uint32_t first;
+        // 0 for an inner node
+        uint32_t count;
+    };
+
+    void Split(uint32_t nodeIndex);
+    void UpdateBound(uint32_t nodeIndex);
+    template <typename Overlap>
+    std::vector<std::reference_wrapper<SceneGeometryNode>> Collect(Overlap&& overlap) const;
+
+    std::vector<Node>     m_Nodes;
+    std::vector<uint32_t> m_Parents;
+    std::vector<Item>     m_Items;
+    std::vector<Box>      m_WorldBounds;
+    std::vector<uint32_t> m_LeafOfItem;
+    // Map the index in the transform hierarchy to the item, nullIndex for the nodes not in the tree
+    std::vector<uint32_t> m_ItemOfNode;
+};
+
+}  // namespace Hitagi::Asset
@@ -13,6 +13,23 @@ Image::Image(uint32_t width, uint32_t height, uint32_t bitcount, uint32_t pitch,
       m_Bitcount(bitcount),
       m_Pitch(pitch),
       Core::Buffer(dataSize) {
+    if (bitcount == 8)
+        m_Format = PixelFormat::R8_UNORM;
+    else if (bitcount == 16)
+        m_Format = PixelFormat::R8G8_UNORM;
+    else if (bitcount == 32)
+        m_Format = PixelFormat::R8G8B8A8_UNORM;
+    else if (bitcount == 64)
+        m_Format = PixelFormat::R16G16B16A16_UNORM;
+}
+
+Image::Image(uint32_t width, uint32_t height, PixelFormat format, uint32_t pitch, size_t dataSize)
+    : m_Width(width),
+      m_Height(height),
+      m_Bitcount(GetPixelFormatBitSize(format)),
+      m_Pitch(pitch),
+      m_Format(format),
+      Core::Buffer(dataSize) {
 }
 
 std::ostream& operator<<(std::ostream& out, const Image& image) {
@@ -31,7 +48,8 @@ std::ostream& operator<<(std::ostream& out, const Image& image) {
                "Bit Count {3:>10} bits\n"
                "Pitch     {4:>10} \n"
                "Data Size {5:>10.2f} {6}\n"
-               "{7:-^25}",
-               "Image Info", image.m_Width, image.m_Height, image.m_Bitcount, image.m_Pitch, size, unit[i], "End");
+               "Mip Level {7:>10}\n"
+               "{8:-^25}",
+               "Image Info", image.m_Width, image.m_Height, image.m_Bitcount, image.m_Pitch, size, unit[i], image.GetMipLevels(), "End");
 }
 }  // namespace Hitagi::Asset
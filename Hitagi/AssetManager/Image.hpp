@@ -1,26 +1,85 @@
 #pragma once
 #include <iostream>
+#include <vector>
 #include "Buffer.hpp"
 #include "portable.hpp"
 
 namespace Hitagi::Asset {
+// Layout of the pixels in an image. The block compressed formats store 4x4 pixel
+// blocks, a row of pitch bytes is a row of blocks.
+enum struct PixelFormat : uint8_t {
+    UNKNOWN,
+    R8_UNORM,
+    R8G8_UNORM,
+    R8G8B8A8_UNORM,
+    R16G16B16A16_UNORM,
+    BC1_UNORM,
+    BC3_UNORM,
+    BC4_UNORM,
+    BC5_UNORM,
+    BC7_UNORM,
+};
+
+inline constexpr bool IsBlockCompressed(PixelFormat format) {
+    return format >= PixelFormat::BC1_UNORM && format <= PixelFormat::BC7_UNORM;
+}
+
+// 8 bits per channel, the input formats of the mip generator and the texture compressor
+inline constexpr bool IsUnorm8(PixelFormat format) {
+    return format == PixelFormat::R8_UNORM || format == PixelFormat::R8G8_UNORM || format == PixelFormat::R8G8B8A8_UNORM;
+}
+
+// Bits per pixel
+inline constexpr uint32_t GetPixelFormatBitSize(PixelFormat format) {
+    switch (format) {
+        case PixelFormat::R8_UNORM:
+            return 8;
+        case PixelFormat::R8G8_UNORM:
+            return 16;
+        case PixelFormat::R8G8B8A8_UNORM:
+            return 32;
+        case PixelFormat::R16G16B16A16_UNORM:
+            return 64;
+        case PixelFormat::BC1_UNORM:
+        case PixelFormat::BC4_UNORM:
+            return 4;
+        case PixelFormat::BC3_UNORM:
+        case PixelFormat::BC5_UNORM:
+        case PixelFormat::BC7_UNORM:
+            return 8;
+        default:
+            return 0;
+    }
+}
+
 class Image : public Core::Buffer {
 public:
+    // The format is deduced from the bitcount
     Image(uint32_t width, uint32_t height, uint32_t bitcount, uint32_t pitch, size_t dataSize);
+    Image(uint32_t width, uint32_t height, PixelFormat format, uint32_t pitch, size_t dataSize);
     Image() = default;
 
-    inline uint32_t GetWidth() const { return m_Width; }
-    inline uint32_t GetHeight() const { return m_Height; }
-    inline uint32_t GetBitcount() const { return m_Bitcount; }
-    inline uint32_t GetPitch() const { return m_Pitch; }
+    inline uint32_t    GetWidth() const { return m_Width; }
+    inline uint32_t    GetHeight() const { return m_Height; }
+    inline uint32_t    GetBitcount() const { return m_Bitcount; }
+    inline uint32_t    GetPitch() const { return m_Pitch; }
+    inline PixelFormat GetFormat() const { return m_Format; }
+
+    // The level 0 is the image itself, every following level halves the size of the previous one.
+    inline size_t       GetMipLevels() const { return m_Mips.size() + 1; }
+    inline const Image& GetMip(size_t level) const { return level == 0 ? *this : m_Mips.at(level - 1); }
+    inline void         SetMips(std::vector<Image> mips) { m_Mips = std::move(mips); }
 
     friend std::ostream& operator<<(std::ostream& out, const Image& image);
 
 private:
-    uint32_t m_Width    = 0;
-    uint32_t m_Height   = 0;
-    uint32_t m_Bitcount = 0;
-    uint32_t m_Pitch    = 0;
+    uint32_t    m_Width    = 0;
+    uint32_t    m_Height   = 0;
+    uint32_t    m_Bitcount = 0;
+    uint32_t    m_Pitch    = 0;
+    PixelFormat m_Format   = PixelFormat::UNKNOWN;
+
+    std::vector<Image> m_Mips;
 };
 
 }  // namespace Hitagi::Asset
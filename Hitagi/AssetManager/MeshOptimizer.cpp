@@ -0,0 +1,548 @@
+#include "MeshOptimizer.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <numeric>
+#include <unordered_map>
+
+namespace Hitagi::Asset {
+namespace {
+
+constexpr uint32_t invalidIndex = ~0u;
+
+// The score of a vertex in Forsyth's algorithm, the vertices used recently and the vertices with
+// fewer remaining triangles are preferred. The last triangle is in the top 3 entries of the cache.
+float VertexScore(int cachePosition, uint32_t remaining, size_t cacheSize) {
+    if (remaining == 0) return -1.0f;
+
+    float score = 0.0f;
+    if (cachePosition >= 0) {
+        if (cachePosition < 3)
+            score = 0.75f;
+        else
+            score = std::pow(1.0f - static_cast<float>(cachePosition - 3) / (cacheSize - 3), 1.5f);
+    }
+    return score + 2.0f / std::sqrt(static_cast<float>(remaining));
+}
+
+// FIFO cache of the vertex shader results, a vertex is missed if it is pushed out by cacheSize vertices
+class FifoCache {
+public:
+    FifoCache(size_t vertexCount, size_t cacheSize) : m_Timestamps(vertexCount, 0), m_Time(cacheSize + 1), m_CacheSize(cacheSize) {}
+
+    unsigned Access(uint32_t a, uint32_t b, uint32_t c) { return Access(a) + Access(b) + Access(c); }
+    void     Flush() { m_Time += m_CacheSize + 1; }
+
+private:
+    unsigned Access(uint32_t vertex) {
+        if (m_Time - m_Timestamps[vertex] <= m_CacheSize) return 0;
+        m_Timestamps[vertex] = m_Time++;
+        return 1;
+    }
+
+    std::vector<size_t> m_Timestamps;
+    size_t              m_Time;
+    size_t              m_CacheSize;
+};
+
+std::vector<uint32_t> ReadIndices(const SceneObjectIndexArray& array) {
+    std::vector<uint32_t> result(array.GetIndexCount());
+    const uint8_t*        data = array.GetData();
+    for (size_t i = 0; i < result.size(); i++) {
+        switch (array.GetIndexType()) {
+            case IndexDataType::INT8:
+                result[i] = data[i];
+                break;
+            case IndexDataType::INT16:
+                result[i] = reinterpret_cast<const uint16_t*>(data)[i];
+                break;
+            case IndexDataType::INT32:
+                result[i] = reinterpret_cast<const uint32_t*>(data)[i];
+                break;
+            case IndexDataType::INT64:
+                result[i] = static_cast<uint32_t>(reinterpret_cast<const uint64_t*>(data)[i]);
+                break;
+        }
+    }
+    return result;
+}
+
+const SceneObjectVertexArray* FindPositions(const SceneObjectMesh& mesh) {
+    auto array = mesh.GetVertexArray(VertexAttribute::POSITION);
+    return array && array->GetDataType() == VertexDataType::FLOAT3 ? array : nullptr;
+}
+
+// The symmetric matrix of the squared distances to a set of planes, weighted by the triangle areas
+struct Quadric {
+    double a00 = 0, a01 = 0, a02 = 0, a11 = 0, a12 = 0, a22 = 0;
+    double b0 = 0, b1 = 0, b2 = 0, c = 0;
+    double weight = 0;
+
+    // The plane is dot(normal, p) + d = 0 with a unit normal
+    Quadric() = default;
+    Quadric(const vec3f& normal, float d, float weight)
+        : a00(weight * normal.x * normal.x), a01(weight * normal.x * normal.y), a02(weight * normal.x * normal.z),
+          a11(weight * normal.y * normal.y), a12(weight * normal.y * normal.z), a22(weight * normal.z * normal.z),
+          b0(weight * normal.x * d), b1(weight * normal.y * d), b2(weight * normal.z * d), c(weight * d * d), weight(weight) {}
+
+    Quadric& operator+=(const Quadric& rhs) {
+        a00 += rhs.a00, a01 += rhs.a01, a02 += rhs.a02, a11 += rhs.a11, a12 += rhs.a12, a22 += rhs.a22;
+        b0 += rhs.b0, b1 += rhs.b1, b2 += rhs.b2, c += rhs.c;
+        weight += rhs.weight;
+        return *this;
+    }
+
+    // The mean squared distance of the point to the planes
+    double Error(const vec3f& p) const {
+        if (weight == 0) return 0;
+        const double x = p.x, y = p.y, z = p.z;
+        const double error =
+            a00 * x * x + a11 * y * y + a22 * z * z +
+            2 * (a01 * x * y + a02 * x * z + a12 * y * z) +
+            2 * (b0 * x + b1 * y + b2 * z) + c;
+        return std::max(error, 0.0) / weight;
+    }
+};
+
+// The vertices that must stay: on a border of the mesh, or sharing the position with another vertex
+std::vector<bool> FindLockedVertices(std::span<const uint32_t> indices, std::span<const vec3f> positions) {
+    const size_t vertexCount = positions.size();
+
+    std::vector<uint32_t> order(vertexCount);
+    std::iota(order.begin(), order.end(), 0);
+    auto less = [&](uint32_t lhs, uint32_t rhs) {
+        const auto &a = positions[lhs], &b = positions[rhs];
+        return std::tie(a.x, a.y, a.z) < std::tie(b.x, b.y, b.z);
+    };
+    std::sort(order.begin(), order.end(), less);
+
+    std::vector<uint32_t> weld(vertexCount);
+    std::vector<bool>     locked(vertexCount, false);
+    for (size_t i = 0; i < vertexCount;) {
+        size_t j = i + 1;
+        while (j < vertexCount && !less(order[i], order[j])) j++;
+        for (size_t k = i; k < j; k++) {
+            weld[order[k]]   = order[i];
+            locked[order[k]] = j - i > 1;
+        }
+        i = j;
+    }
+
+    // An edge of the welded vertices used by only one triangle is on a border
+    std::unordered_map<uint64_t, uint32_t> edges;
+    auto                                   key = [&](uint32_t a, uint32_t b) {
+        a = weld[a], b = weld[b];
+        return a < b ? (uint64_t(a) << 32 | b) : (uint64_t(b) << 32 | a);
+    };
+    for (size_t t = 0; t < indices.size() / 3; t++)
+        for (size_t k = 0; k < 3; k++) edges[key(indices[3 * t + k], indices[3 * t + (k + 1) % 3])]++;
+
+    std::vector<bool> border(vertexCount, false);
+    for (auto&& [edge, count] : edges) {
+        if (count == 1) border[edge >> 32] = border[edge & 0xffffffff] = true;
+    }
+    for (size_t v = 0; v < vertexCount; v++) locked[v] = locked[v] || border[weld[v]];
+    return locked;
+}
+
+}  // namespace
+
+void OptimizeVertexCache(std::span<uint32_t> indices, size_t vertexCount, size_t cacheSize) {
+    const size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0 || cacheSize <= 3) return;
+
+    // The triangles using each vertex, the emitted ones are removed from the front of the range
+    std::vector<uint32_t> remaining(vertexCount, 0);
+    for (auto index : indices) remaining[index]++;
+    std::vector<uint32_t> offsets(vertexCount + 1, 0);
+    std::partial_sum(remaining.begin(), remaining.end(), offsets.begin() + 1);
+    std::vector<uint32_t> adjacency(offsets.back());
+    {
+        std::vector<uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+        for (size_t i = 0; i < indices.size(); i++)
+            adjacency[cursor[indices[i]]++] = i / 3;
+    }
+
+    std::vector<int>   cachePosition(vertexCount, -1);
+    std::vector<float> vertexScore(vertexCount);
+    for (size_t v = 0; v < vertexCount; v++)
+        vertexScore[v] = VertexScore(-1, remaining[v], cacheSize);
+
+    std::vector<float> triangleScore(triangleCount);
+    std::vector<bool>  emitted(triangleCount, false);
+    for (size_t t = 0; t < triangleCount; t++)
+        triangleScore[t] = vertexScore[indices[3 * t]] + vertexScore[indices[3 * t + 1]] + vertexScore[indices[3 * t + 2]];
+
+    std::vector<uint32_t> result;
+    result.reserve(indices.size());
+    std::vector<uint32_t> cache, newCache;
+    cache.reserve(cacheSize + 3);
+    newCache.reserve(cacheSize + 3);
+
+    uint32_t best   = std::max_element(triangleScore.begin(), triangleScore.end()) - triangleScore.begin();
+    size_t   cursor = 0;
+    for (size_t i = 0; i < triangleCount; i++) {
+        // No triangle uses the cached vertices, start from the next triangle in the input order
+        if (best == invalidIndex) {
+            while (emitted[cursor]) cursor++;
+            best = cursor;
+        }
+
+        const uint32_t* triangle = &indices[3 * best];
+        result.insert(result.end(), triangle, triangle + 3);
+        emitted[best] = true;
+
+        for (size_t k = 0; k < 3; k++) {
+            const uint32_t v     = triangle[k];
+            auto           begin = adjacency.begin() + offsets[v];
+            auto           end   = begin + remaining[v];
+            std::iter_swap(std::find(begin, end, best), end - 1);
+            remaining[v]--;
+        }
+
+        // The vertices of the triangle go to the front of the LRU cache
+        newCache.assign(triangle, triangle + 3);
+        for (auto v : cache)
+            if (v != triangle[0] && v != triangle[1] && v != triangle[2]) newCache.push_back(v);
+
+        for (size_t k = 0; k < newCache.size(); k++) {
+            const uint32_t v = newCache[k];
+            cachePosition[v] = k < cacheSize ? static_cast<int>(k) : -1;
+            vertexScore[v]   = VertexScore(cachePosition[v], remaining[v], cacheSize);
+        }
+        if (newCache.size() > cacheSize) newCache.resize(cacheSize);
+        std::swap(cache, newCache);
+
+        // Only the triangles of the cached vertices change their scores
+        best           = invalidIndex;
+        float bestScore = -std::numeric_limits<float>::infinity();
+        for (auto v : cache) {
+            for (uint32_t j = 0; j < remaining[v]; j++) {
+                const uint32_t t = adjacency[offsets[v] + j];
+                triangleScore[t] = vertexScore[indices[3 * t]] + vertexScore[indices[3 * t + 1]] + vertexScore[indices[3 * t + 2]];
+                if (triangleScore[t] > bestScore) {
+                    best      = t;
+                    bestScore = triangleScore[t];
+                }
+            }
+        }
+    }
+
+    std::copy(result.begin(), result.end(), indices.begin());
+}
+
+void OptimizeOverdraw(std::span<uint32_t> indices, std::span<const vec3f> positions, float threshold) {
+    constexpr size_t cacheSize     = 16;
+    const size_t     triangleCount = indices.size() / 3;
+    if (triangleCount == 0) return;
+
+    // The triangles of a cluster are [clusters[i], clusters[i + 1])
+    std::vector<size_t> clusters;
+    {
+        FifoCache           cache(positions.size(), cacheSize);
+        // The first triangle always starts a cluster, even if it is degenerate
+        std::vector<size_t> hardBoundaries = {0};
+        cache.Access(indices[0], indices[1], indices[2]);
+        for (size_t t = 1; t < triangleCount; t++) {
+            // All the vertices are missed, so the cache optimizer starts a new strip here
+            if (cache.Access(indices[3 * t], indices[3 * t + 1], indices[3 * t + 2]) == 3) hardBoundaries.push_back(t);
+        }
+        hardBoundaries.push_back(triangleCount);
+
+        for (size_t i = 0; i + 1 < hardBoundaries.size(); i++) {
+            const size_t begin = hardBoundaries[i], end = hardBoundaries[i + 1];
+
+            cache.Flush();
+            size_t misses = 0;
+            for (size_t t = begin; t < end; t++) misses += cache.Access(indices[3 * t], indices[3 * t + 1], indices[3 * t + 2]);
+            const float limit = threshold * misses / (end - begin);
+
+            cache.Flush();
+            clusters.push_back(begin);
+            size_t start = begin;
+            misses       = 0;
+            for (size_t t = begin; t < end; t++) {
+                misses += cache.Access(indices[3 * t], indices[3 * t + 1], indices[3 * t + 2]);
+                if (t + 1 < end && static_cast<float>(misses) / (t + 1 - start) <= limit) {
+                    clusters.push_back(t + 1);
+                    start  = t + 1;
+                    misses = 0;
+                    cache.Flush();
+                }
+            }
+        }
+        clusters.push_back(triangleCount);
+    }
+    const size_t clusterCount = clusters.size() - 1;
+    if (clusterCount <= 1) return;
+
+    // The area weighted centroids and normals of the clusters
+    std::vector<vec3f> centroids(clusterCount, vec3f(0.0f)), normals(clusterCount, vec3f(0.0f));
+    std::vector<float> areas(clusterCount, 0.0f);
+    vec3f              meshCentroid(0.0f);
+    float              meshArea = 0.0f;
+    for (size_t c = 0; c < clusterCount; c++) {
+        for (size_t t = clusters[c]; t < clusters[c + 1]; t++) {
+            const vec3f& a      = positions[indices[3 * t]];
+            const vec3f& b      = positions[indices[3 * t + 1]];
+            const vec3f& p      = positions[indices[3 * t + 2]];
+            const vec3f  normal = cross(b - a, p - a);
+            const float  area   = normal.norm();
+            centroids[c] += area * (a + b + p) / 3.0f;
+            normals[c] += normal;
+            areas[c] += area;
+        }
+        meshCentroid += centroids[c];
+        meshArea += areas[c];
+        if (areas[c] > 0) centroids[c] /= areas[c];
+    }
+    if (meshArea > 0) meshCentroid /= meshArea;
+
+    // The clusters facing away from the center are likely in front of the others
+    std::vector<float> sortKeys(clusterCount, 0.0f);
+    for (size_t c = 0; c < clusterCount; c++) {
+        const float length = normals[c].norm();
+        if (length > 0) sortKeys[c] = dot(centroids[c] - meshCentroid, normals[c] / length);
+    }
+    std::vector<size_t> order(clusterCount);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](size_t lhs, size_t rhs) { return sortKeys[lhs] > sortKeys[rhs]; });
+
+    std::vector<uint32_t> result;
+    result.reserve(indices.size());
+    for (auto c : order)
+        result.insert(result.end(), indices.begin() + 3 * clusters[c], indices.begin() + 3 * clusters[c + 1]);
+    std::copy(result.begin(), result.end(), indices.begin());
+}
+
+std::vector<uint32_t> OptimizeVertexFetch(std::span<uint32_t> indices, size_t vertexCount) {
+    std::vector<uint32_t> remap(vertexCount, invalidIndex);
+    uint32_t              next = 0;
+    for (auto& index : indices) {
+        if (remap[index] == invalidIndex) remap[index] = next++;
+        index = remap[index];
+    }
+    return remap;
+}
+
+float GetACMR(std::span<const uint32_t> indices, size_t vertexCount, size_t cacheSize) {
+    const size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0) return 0.0f;
+
+    FifoCache cache(vertexCount, cacheSize);
+    size_t    misses = 0;
+    for (size_t t = 0; t < triangleCount; t++) misses += cache.Access(indices[3 * t], indices[3 * t + 1], indices[3 * t + 2]);
+    return static_cast<float>(misses) / triangleCount;
+}
+
+std::vector<uint32_t> Simplify(std::span<const uint32_t> indices, std::span<const vec3f> positions,
+                               size_t targetIndexCount, float targetError, float* resultError) {
+    const size_t          vertexCount = positions.size();
+    std::vector<uint32_t> result(indices.begin(), indices.end());
+    double                maxError = 0;
+
+    std::vector<Quadric> quadrics(vertexCount);
+    for (size_t t = 0; t < result.size() / 3; t++) {
+        const vec3f &a = positions[result[3 * t]], &b = positions[result[3 * t + 1]], &c = positions[result[3 * t + 2]];
+        vec3f        normal = cross(b - a, c - a);
+        const float  area   = normal.norm();
+        if (area == 0) continue;
+        normal /= area;
+        const Quadric quadric(normal, -dot(normal, a), area);
+        for (size_t k = 0; k < 3; k++) quadrics[result[3 * t + k]] += quadric;
+    }
+    const auto locked = FindLockedVertices(result, positions);
+
+    struct Collapse {
+        uint32_t from, to;
+        double   error;
+    };
+    std::vector<Collapse> collapses;
+    std::vector<uint32_t> offsets(vertexCount + 1), adjacency;
+    std::vector<uint32_t> target(vertexCount);
+    std::vector<bool>     touched(vertexCount);
+
+    while (result.size() > targetIndexCount) {
+        const size_t triangleCount = result.size() / 3;
+
+        // The triangles around each vertex
+        std::fill(offsets.begin(), offsets.end(), 0);
+        for (auto index : result) offsets[index + 1]++;
+        std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+        adjacency.resize(result.size());
+        {
+            std::vector<uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+            for (size_t i = 0; i < result.size(); i++) adjacency[cursor[result[i]]++] = i / 3;
+        }
+
+        collapses.clear();
+        for (size_t t = 0; t < triangleCount; t++) {
+            for (size_t k = 0; k < 3; k++) {
+                const uint32_t a = result[3 * t + k], b = result[3 * t + (k + 1) % 3];
+                if (!locked[a]) collapses.push_back({a, b, 0});
+                if (!locked[b]) collapses.push_back({b, a, 0});
+            }
+        }
+        std::sort(collapses.begin(), collapses.end(), [](const Collapse& lhs, const Collapse& rhs) {
+            return std::tie(lhs.from, lhs.to) < std::tie(rhs.from, rhs.to);
+        });
+        collapses.erase(std::unique(collapses.begin(), collapses.end(), [](const Collapse& lhs, const Collapse& rhs) {
+                            return lhs.from == rhs.from && lhs.to == rhs.to;
+                        }),
+                        collapses.end());
+        for (auto&& collapse : collapses) {
+            Quadric quadric = quadrics[collapse.from];
+            quadric += quadrics[collapse.to];
+            collapse.error = quadric.Error(positions[collapse.to]);
+        }
+        std::sort(collapses.begin(), collapses.end(), [](const Collapse& lhs, const Collapse& rhs) { return lhs.error < rhs.error; });
+
+        // Apply the cheapest collapses whose neighborhoods do not overlap
+        std::iota(target.begin(), target.end(), 0);
+        std::fill(touched.begin(), touched.end(), false);
+        const double maxCollapseError = static_cast<double>(targetError) * targetError;
+        size_t       removed = 0, toRemove = (result.size() - targetIndexCount + 2) / 3;
+        for (auto&& [from, to, error] : collapses) {
+            if (error > maxCollapseError || removed >= toRemove) break;
+            if (touched[from] || touched[to]) continue;
+
+            // Reject the collapse flipping a triangle
+            bool   flipped        = false;
+            size_t collapsedCount = 0;
+            for (uint32_t i = offsets[from]; i < offsets[from + 1] && !flipped; i++) {
+                const uint32_t* triangle = &result[3 * adjacency[i]];
+                if (triangle[0] == to || triangle[1] == to || triangle[2] == to) {
+                    collapsedCount++;
+                    continue;
+                }
+                std::array<vec3f, 3> points = {positions[triangle[0]], positions[triangle[1]], positions[triangle[2]]};
+                const vec3f          before = cross(points[1] - points[0], points[2] - points[0]);
+                points[std::find(triangle, triangle + 3, from) - triangle] = positions[to];
+                const vec3f after = cross(points[1] - points[0], points[2] - points[0]);
+                flipped           = dot(before, after) <= 0;
+            }
+            if (flipped) continue;
+
+            target[from] = to;
+            quadrics[to] += quadrics[from];
+            maxError = std::max(maxError, error);
+            removed += collapsedCount;
+            for (uint32_t i = offsets[from]; i < offsets[from + 1]; i++)
+                for (size_t k = 0; k < 3; k++) touched[result[3 * adjacency[i] + k]] = true;
+        }
+        if (removed == 0) break;
+
+        // Remove the degenerate triangles
+        size_t count = 0;
+        for (size_t t = 0; t < triangleCount; t++) {
+            const uint32_t a = target[result[3 * t]], b = target[result[3 * t + 1]], c = target[result[3 * t + 2]];
+            if (a == b || b == c || c == a) continue;
+            result[count++] = a, result[count++] = b, result[count++] = c;
+        }
+        result.resize(count);
+    }
+
+    if (resultError) *resultError = static_cast<float>(std::sqrt(maxError));
+    return result;
+}
+
+void OptimizeMesh(SceneObjectMesh& mesh) {
+    const auto& vertexArrays = mesh.GetVertexArrays();
+    if (mesh.GetPrimitiveType() != PrimitiveType::TRI_LIST || vertexArrays.empty()) return;
+
+    const size_t vertexCount = vertexArrays.front().GetVertexCount();
+    auto         indices     = ReadIndices(mesh.GetIndexArray());
+    if (indices.size() % 3 != 0 || std::any_of(indices.begin(), indices.end(), [&](uint32_t index) { return index >= vertexCount; })) {
+        spdlog::get("AssetManager")->warn("[MeshOptimizer] The indices are out of the vertices, the mesh is not optimized.");
+        return;
+    }
+
+    OptimizeVertexCache(indices, vertexCount);
+    if (auto position = FindPositions(mesh))
+        OptimizeOverdraw(indices, std::span(reinterpret_cast<const vec3f*>(position->GetData()), vertexCount));
+    const auto   remap          = OptimizeVertexFetch(indices, vertexCount);
+    const size_t newVertexCount = vertexCount - std::count(remap.begin(), remap.end(), invalidIndex);
+
+    std::vector<SceneObjectVertexArray> newVertexArrays;
+    for (auto&& array : vertexArrays) {
+        const size_t vertexSize = array.GetVertexSize();
+        Core::Buffer buffer(newVertexCount * vertexSize);
+        for (size_t v = 0; v < std::min(vertexCount, array.GetVertexCount()); v++) {
+            if (remap[v] != invalidIndex)
+                std::memcpy(buffer.GetData() + remap[v] * vertexSize, array.GetData() + v * vertexSize, vertexSize);
+        }
+        newVertexArrays.emplace_back(array.GetAttributeName(), array.GetDataType(), std::move(buffer));
+    }
+    mesh.SetVertexArrays(std::move(newVertexArrays));
+
+    // 16 bits indices halve the index memory and the index fetch bandwidth
+    if (newVertexCount <= std::numeric_limits<uint16_t>::max() + 1) {
+        Core::Buffer buffer(indices.size() * sizeof(uint16_t));
+        std::transform(indices.begin(), indices.end(), reinterpret_cast<uint16_t*>(buffer.GetData()),
+                       [](uint32_t index) { return static_cast<uint16_t>(index); });
+        mesh.AddIndexArray(SceneObjectIndexArray(IndexDataType::INT16, std::move(buffer)));
+    } else {
+        Core::Buffer buffer(indices.data(), indices.size() * sizeof(uint32_t));
+        mesh.AddIndexArray(SceneObjectIndexArray(IndexDataType::INT32, std::move(buffer)));
+    }
+}
+
+std::unique_ptr<SceneObjectMesh> SimplifyMesh(const SceneObjectMesh& mesh, float ratio, float targetError, float* resultError) {
+    const auto position = FindPositions(mesh);
+    if (mesh.GetPrimitiveType() != PrimitiveType::TRI_LIST || position == nullptr) return nullptr;
+
+    const auto positions = std::span(reinterpret_cast<const vec3f*>(position->GetData()), position->GetVertexCount());
+    const auto indices   = ReadIndices(mesh.GetIndexArray());
+    if (indices.size() % 3 != 0 || std::any_of(indices.begin(), indices.end(), [&](uint32_t index) { return index >= positions.size(); }))
+        return nullptr;
+
+    const size_t targetIndexCount = static_cast<size_t>(indices.size() / 3 * ratio) * 3;
+    auto         simplified       = Simplify(indices, positions, targetIndexCount, targetError, resultError);
+
+    // The vertices are copied, the unused ones are removed by the optimization
+    auto result = std::make_unique<SceneObjectMesh>();
+    result->SetPrimitiveType(PrimitiveType::TRI_LIST);
+    result->SetVertexArrays(std::vector<SceneObjectVertexArray>(mesh.GetVertexArrays()));
+    result->SetVertexLayout(mesh.GetVertexLayout());
+    result->AddIndexArray(SceneObjectIndexArray(IndexDataType::INT32, Core::Buffer(simplified.data(), simplified.size() * sizeof(uint32_t))));
+    result->SetMaterial(mesh.GetMaterial());
+    OptimizeMesh(*result);
+    return result;
+}
+
+void GenerateLODs(SceneObjectGeometry& geometry, std::span<const LODLevel> levels) {
+    if (geometry.GetLODCount() != 1 || geometry.GetBoundingBox().Empty()) return;
+    const float radius = geometry.GetBoundingBox().Extent().norm();
+    if (radius == 0) return;
+
+    size_t previousCount = 0;
+    for (auto&& mesh : geometry.GetMeshes(0)) previousCount += mesh->GetIndexArray().GetIndexCount() / 3;
+
+    for (auto&& level : levels) {
+        std::vector<std::unique_ptr<SceneObjectMesh>> meshes;
+        size_t                                        count = 0;
+        float                                         error = 0;
+        for (auto&& mesh : geometry.GetMeshes(0)) {
+            float meshError  = 0;
+            auto  simplified = SimplifyMesh(*mesh, level.ratio, level.error * radius, &meshError);
+            // e.g. lines
+            if (simplified == nullptr) return;
+            count += simplified->GetIndexArray().GetIndexCount() / 3;
+            error = std::max(error, meshError);
+            meshes.emplace_back(std::move(simplified));
+        }
+        // Not worth another LOD
+        if (count > previousCount * 0.8) break;
+
+        const size_t lod = geometry.GetLODCount();
+        for (auto&& mesh : meshes) geometry.AddMesh(std::move(mesh), lod);
+        geometry.SetLODError(lod, error / radius);
+        previousCount = count;
+    }
+}
+
+}  // namespace Hitagi::Asset
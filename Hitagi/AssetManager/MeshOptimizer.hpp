@@ -0,0 +1,53 @@
+#pragma once
+#include "SceneObject.hpp"
+
+#include <span>
+
+namespace Hitagi::Asset {
+
+// Reorder the triangles of a triangle list for the post-transform vertex cache with
+// Tom Forsyth's linear-speed algorithm, simulating a LRU cache of cacheSize vertices.
+void OptimizeVertexCache(std::span<uint32_t> indices, size_t vertexCount, size_t cacheSize = 32);
+
+// Split the cache optimized triangles into clusters where the cache restarts, and draw the
+// clusters facing out from the center of the mesh first to reduce the overdraw (Sander et al.).
+// A cluster is split further while its ACMR stays below threshold times the ACMR of the mesh,
+// so the higher threshold trades more vertex cache misses for less overdraw.
+void OptimizeOverdraw(std::span<uint32_t> indices, std::span<const vec3f> positions, float threshold = 1.05f);
+
+// Renumber the vertices in the order they are first used, so the vertices are fetched in order.
+// Return the new index of every vertex, the unused vertices are removed and mapped to ~0u.
+std::vector<uint32_t> OptimizeVertexFetch(std::span<uint32_t> indices, size_t vertexCount);
+
+// The average cache miss per triangle with a FIFO cache of cacheSize vertices, 0.5 is the best for a grid
+float GetACMR(std::span<const uint32_t> indices, size_t vertexCount, size_t cacheSize = 16);
+
+// Collapse the edges of a triangle list with the least quadric error (Garland-Heckbert) until the
+// index count reaches targetIndexCount or the next collapse exceeds targetError. A vertex is only
+// collapsed into one of its neighbors, so the vertex data is kept and only the indices change.
+// The vertices on the borders and attribute seams are locked to keep the mesh watertight.
+// The error is the root mean square distance to the original surface, in the units of the positions.
+std::vector<uint32_t> Simplify(std::span<const uint32_t> indices, std::span<const vec3f> positions,
+                               size_t targetIndexCount, float targetError, float* resultError = nullptr);
+
+// Run the passes above on a triangle list mesh, reorder its vertex arrays and store its indices in
+// INT16 when the vertex count allows. The meshes of the other primitive types are kept as they are.
+void OptimizeMesh(SceneObjectMesh& mesh);
+
+// Return a simplified and optimized copy of a triangle list mesh with a POSITION array, or nullptr.
+// The copy has its own vertex arrays, compacted to the vertices its indices still use.
+std::unique_ptr<SceneObjectMesh> SimplifyMesh(const SceneObjectMesh& mesh, float ratio, float targetError, float* resultError = nullptr);
+
+struct LODLevel {
+    float ratio;  // the target triangle count relative to LOD 0
+    float error;  // the max error relative to the bounding radius of the geometry
+};
+inline const std::vector<LODLevel> defaultLODLevels = {{0.5f, 0.005f}, {0.25f, 0.02f}, {0.1f, 0.05f}};
+
+// Generate the LODs of a geometry that has only LOD 0 by simplifying all its meshes, and record
+// their errors for SceneObjectGeometry::SelectLOD. The generation stops when a level cannot remove
+// enough triangles from the previous one. Every LOD keeps its own compacted copy of the vertex
+// data, so the vertex memory of a geometry grows with each level, at most by the vertices of LOD 0.
+void GenerateLODs(SceneObjectGeometry& geometry, std::span<const LODLevel> levels = defaultLODLevels);
+
+}  // namespace Hitagi::Asset
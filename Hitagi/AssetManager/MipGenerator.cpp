@@ -0,0 +1,176 @@
+#include "MipGenerator.hpp"
+#include "ThreadManager.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <numbers>
+
+namespace Hitagi::Asset {
+namespace {
+
+constexpr float kaiserAlpha = 4.0f;
+// Half width of the Kaiser filter in the pixels of the smaller level
+constexpr float kaiserWidth = 2.0f;
+
+float BesselI0(float x) {
+    float sum = 1.0f, term = 1.0f;
+    for (int k = 1; k < 20; k++) {
+        term *= (x / (2.0f * k)) * (x / (2.0f * k));
+        sum += term;
+        if (term < 1e-7f * sum) break;
+    }
+    return sum;
+}
+
+float Kaiser(float t) {
+    if (std::abs(t) >= kaiserWidth) return 0.0f;
+    const float sinc  = t == 0.0f ? 1.0f : std::sin(std::numbers::pi_v<float> * t) / (std::numbers::pi_v<float> * t);
+    const float ratio = t / kaiserWidth;
+    return sinc * BesselI0(kaiserAlpha * std::sqrt(1.0f - ratio * ratio)) / BesselI0(kaiserAlpha);
+}
+
+struct Tap {
+    uint32_t index;
+    float    weight;
+};
+
+// The weights of the source pixels of every destination pixel along an axis, the edge is clamped
+std::vector<std::vector<Tap>> ComputeTaps(uint32_t srcSize, uint32_t dstSize, MipFilter filter) {
+    const float scale   = static_cast<float>(srcSize) / dstSize;
+    const float support = (filter == MipFilter::Box ? 0.5f : kaiserWidth) * scale;
+
+    std::vector<std::vector<Tap>> result(dstSize);
+    for (uint32_t x = 0; x < dstSize; x++) {
+        const float center = (x + 0.5f) * scale;
+        const auto  begin  = static_cast<int64_t>(std::floor(center - support));
+        const auto  end    = static_cast<int64_t>(std::ceil(center + support));
+
+        float sum = 0.0f;
+        for (int64_t i = begin; i < end; i++) {
+            float weight;
+            if (filter == MipFilter::Box)
+                // coverage of the source pixel
+                weight = std::max(0.0f, std::min<float>(i + 1, center + support) - std::max<float>(i, center - support));
+            else
+                weight = Kaiser((i + 0.5f - center) / scale);
+            if (weight == 0.0f) continue;
+
+            const auto index = static_cast<uint32_t>(std::clamp<int64_t>(i, 0, srcSize - 1));
+            result[x].emplace_back(Tap{index, weight});
+            sum += weight;
+        }
+        for (auto&& tap : result[x]) tap.weight /= sum;
+    }
+    return result;
+}
+
+const std::array<float, 256>& SRGBToLinearTable() {
+    static const auto table = [] {
+        std::array<float, 256> result;
+        for (size_t i = 0; i < 256; i++) {
+            const float c = i / 255.0f;
+            result[i]     = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+        }
+        return result;
+    }();
+    return table;
+}
+
+// Indexed by the linear value in 16 bits
+const std::array<uint8_t, 65536>& LinearToSRGBTable() {
+    static const auto table = [] {
+        std::array<uint8_t, 65536> result;
+        for (size_t i = 0; i < result.size(); i++) {
+            const float c = i / 65535.0f;
+            const float s = c <= 0.0031308f ? c * 12.92f : 1.055f * std::pow(c, 1.0f / 2.4f) - 0.055f;
+            result[i]     = static_cast<uint8_t>(s * 255.0f + 0.5f);
+        }
+        return result;
+    }();
+    return table;
+}
+
+// A level in linear float, the rows are tightly packed
+struct FloatImage {
+    uint32_t           width, height, channels;
+    std::vector<float> data;
+};
+
+FloatImage Resample(const FloatImage& src, uint32_t width, uint32_t height, MipFilter filter) {
+    FloatImage dst{width, height, src.channels, std::vector<float>(static_cast<size_t>(width) * height * src.channels)};
+
+    const auto     horizontal = ComputeTaps(src.width, width, filter);
+    const auto     vertical   = ComputeTaps(src.height, height, filter);
+    const uint32_t srcRowSize = src.width * src.channels;
+
+    g_ThreadManager->ParallelFor(0, height, [&](size_t y) {
+        // vertical pass to a full source row, then horizontal pass to the destination row
+        std::vector<float> row(srcRowSize, 0.0f);
+        for (auto&& tap : vertical[y]) {
+            const float* srcRow = src.data.data() + static_cast<size_t>(tap.index) * srcRowSize;
+            for (uint32_t i = 0; i < srcRowSize; i++) row[i] += tap.weight * srcRow[i];
+        }
+
+        float* dstRow = dst.data.data() + y * width * src.channels;
+        for (uint32_t x = 0; x < width; x++) {
+            float* pixel = dstRow + x * src.channels;
+            for (auto&& tap : horizontal[x]) {
+                const float* srcPixel = row.data() + tap.index * src.channels;
+                for (uint32_t c = 0; c < src.channels; c++) pixel[c] += tap.weight * srcPixel[c];
+            }
+        }
+    });
+    return dst;
+}
+
+FloatImage Decode(const Image& image, bool sRGB) {
+    const uint32_t channels = image.GetBitcount() / 8;
+    FloatImage     result{image.GetWidth(), image.GetHeight(), channels, std::vector<float>(static_cast<size_t>(image.GetWidth()) * image.GetHeight() * channels)};
+
+    const auto& table = SRGBToLinearTable();
+    for (uint32_t y = 0; y < image.GetHeight(); y++) {
+        const uint8_t* src = image.GetData() + y * image.GetPitch();
+        float*         dst = result.data.data() + static_cast<size_t>(y) * image.GetWidth() * channels;
+        for (uint32_t i = 0; i < image.GetWidth() * channels; i++) {
+            // alpha is always linear
+            const bool color = sRGB && channels == 4 && i % 4 != 3;
+            dst[i]           = color ? table[src[i]] : src[i] / 255.0f;
+        }
+    }
+    return result;
+}
+
+Image Encode(const FloatImage& image, bool sRGB) {
+    const uint32_t pitch = (image.width * image.channels + 3) & ~3u;
+    Image          result(image.width, image.height, image.channels * 8, pitch, static_cast<size_t>(pitch) * image.height);
+
+    const auto& table = LinearToSRGBTable();
+    for (uint32_t y = 0; y < image.height; y++) {
+        const float* src = image.data.data() + static_cast<size_t>(y) * image.width * image.channels;
+        uint8_t*     dst = result.GetData() + y * pitch;
+        for (uint32_t i = 0; i < image.width * image.channels; i++) {
+            // the negative lobes of Kaiser filter may overshoot
+            const float value = std::clamp(src[i], 0.0f, 1.0f);
+            const bool  color = sRGB && image.channels == 4 && i % 4 != 3;
+            dst[i]            = color ? table[static_cast<size_t>(value * 65535.0f + 0.5f)] : static_cast<uint8_t>(value * 255.0f + 0.5f);
+        }
+    }
+    return result;
+}
+
+}  // namespace
+
+std::vector<Image> GenerateMips(const Image& image, MipFilter filter, bool sRGB) {
+    std::vector<Image> result;
+    if (image.Empty() || !IsUnorm8(image.GetFormat())) return result;
+
+    FloatImage level = Decode(image, sRGB);
+    while (level.width > 1 || level.height > 1) {
+        level = Resample(level, std::max(1u, level.width / 2), std::max(1u, level.height / 2), filter);
+        result.emplace_back(Encode(level, sRGB));
+    }
+    return result;
+}
+
+}  // namespace Hitagi::Asset
@@ -0,0 +1,17 @@
+#pragma once
+#include "Image.hpp"
+
+namespace Hitagi::Asset {
+
+enum struct MipFilter : uint8_t {
+    Box,
+    Kaiser,  // Kaiser windowed sinc, sharper than box and without its aliasing
+};
+
+// Generate the mip levels following the image, down to 1x1. Each level is filtered from the
+// previous one in linear float, the rows of a level are filtered on the thread pool.
+// The color channels of RGBA8 images are decoded from sRGB when sRGB is true, the others are linear.
+// Return nothing if the image is empty or not 8 bits per channel.
+std::vector<Image> GenerateMips(const Image& image, MipFilter filter = MipFilter::Kaiser, bool sRGB = true);
+
+}  // namespace Hitagi::Asset
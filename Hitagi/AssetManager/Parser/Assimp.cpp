@@ -6,9 +6,25 @@
 #include <spdlog/spdlog.h>
 
 #include "HitagiMath.hpp"
+#include "ThreadManager.hpp"
+
+#include <map>
+#include <optional>
 
 namespace Hitagi::Asset {
 
+namespace {
+std::unique_ptr<SceneObjectMesh> CopyMesh(const SceneObjectMesh& mesh) {
+    auto result = std::make_unique<SceneObjectMesh>();
+    result->SetPrimitiveType(mesh.GetPrimitiveType());
+    result->SetVertexArrays(std::vector<SceneObjectVertexArray>(mesh.GetVertexArrays()));
+    result->AddIndexArray(SceneObjectIndexArray(mesh.GetIndexArray()));
+    result->SetMaterial(mesh.GetMaterial());
+    result->SetVertexLayout(mesh.GetVertexLayout());
+    return result;
+}
+}  // namespace
+
 Scene AssimpParser::Parse(const Core::Buffer& buf, const std::filesystem::path& scenePath) {
     auto logger = spdlog::get("AssetManager");
     if (buf.Empty()) {
@@ -169,27 +185,26 @@ Scene AssimpParser::Parse(const Core::Buffer& buf, const std::filesystem::path&
                 logger->error("[Assimp] Unsupport Primitive Type");
         }
 
+        // The attributes and the indices are converted by independent jobs, each job fills its own
+        // arrays, which are added in the order of the jobs to keep the order of the vertex arrays.
+        using VertexArrays = std::vector<SceneObjectVertexArray>;
+        std::vector<std::function<void(VertexArrays&)>> jobs;
+
         // Read Position
         if (_mesh->HasPositions()) {
-            Core::Buffer positionBuffer(_mesh->mNumVertices * sizeof(vec3f));
-            auto         position = reinterpret_cast<vec3f*>(positionBuffer.GetData());
-            for (size_t i = 0; i < _mesh->mNumVertices; i++)
-                position[i] = vec3f(_mesh->mVertices[i].x, _mesh->mVertices[i].y, _mesh->mVertices[i].z);
-            mesh->AddVertexArray(SceneObjectVertexArray("POSITION", VertexDataType::FLOAT3, std::move(positionBuffer)));
-        }
-
-        // Read Normal
-        if (_mesh->HasNormals()) {
-            Core::Buffer normalBuffer(_mesh->mNumVertices * sizeof(vec3f));
-            auto         normal = reinterpret_cast<vec3f*>(normalBuffer.GetData());
-            for (size_t i = 0; i < _mesh->mNumVertices; i++)
-                normal[i] = vec3f(_mesh->mNormals[i].x, _mesh->mNormals[i].y, _mesh->mNormals[i].z);
-            mesh->AddVertexArray(SceneObjectVertexArray("NORMAL", VertexDataType::FLOAT3, std::move(normalBuffer)));
+            jobs.emplace_back([&](VertexArrays& arrays) {
+                Core::Buffer positionBuffer(_mesh->mNumVertices * sizeof(vec3f));
+                auto         position = reinterpret_cast<vec3f*>(positionBuffer.GetData());
+                for (size_t i = 0; i < _mesh->mNumVertices; i++)
+                    position[i] = vec3f(_mesh->mVertices[i].x, _mesh->mVertices[i].y, _mesh->mVertices[i].z);
+                arrays.emplace_back("POSITION", VertexDataType::FLOAT3, std::move(positionBuffer));
+            });
         }
 
         // Read Color
         for (size_t colorChannels = 0; colorChannels < _mesh->GetNumColorChannels(); colorChannels++) {
-            if (_mesh->HasVertexColors(colorChannels)) {
+            if (!_mesh->HasVertexColors(colorChannels)) continue;
+            jobs.emplace_back([&, colorChannels](VertexArrays& arrays) {
                 Core::Buffer colorBuffer(_mesh->mNumVertices * sizeof(vec4f));
                 auto         color = reinterpret_cast<vec4f*>(colorBuffer.GetData());
                 for (size_t i = 0; i < _mesh->mNumVertices; i++)
@@ -198,51 +213,96 @@ Scene AssimpParser::Parse(const Core::Buffer& buf, const std::filesystem::path&
                                      _mesh->mColors[colorChannels][i].b,
                                      _mesh->mColors[colorChannels][i].a);
                 const auto attr = std::string("COLOR") + (colorChannels == 0 ? "" : std::to_string(colorChannels));
-                mesh->AddVertexArray(SceneObjectVertexArray(attr, VertexDataType::FLOAT4, std::move(colorBuffer)));
-            }
+                SceneObjectVertexArray colorArray(attr, VertexDataType::FLOAT4, std::move(colorBuffer));
+                arrays.emplace_back(m_PackVertices ? colorArray.ConvertTo(VertexDataType::UNORM8_4) : std::move(colorArray));
+            });
         }
 
         // Read UV
         for (size_t UVChannel = 0; UVChannel < _mesh->GetNumUVChannels(); UVChannel++) {
-            if (_mesh->HasTextureCoords(UVChannel)) {
+            if (!_mesh->HasTextureCoords(UVChannel)) continue;
+            jobs.emplace_back([&, UVChannel](VertexArrays& arrays) {
                 Core::Buffer texcoordBuffer(_mesh->mNumVertices * sizeof(vec2f));
-                auto         texcoord = reinterpret_cast<vec2f*>(texcoordBuffer.GetData());
-                for (size_t i = 0; i < _mesh->mNumVertices; i++)
+                auto         texcoord   = reinterpret_cast<vec2f*>(texcoordBuffer.GetData());
+                bool         normalized = true;
+                for (size_t i = 0; i < _mesh->mNumVertices; i++) {
                     texcoord[i] = vec2f(_mesh->mTextureCoords[UVChannel][i].x, _mesh->mTextureCoords[UVChannel][i].y);
+                    normalized  = normalized && texcoord[i].x >= 0 && texcoord[i].x <= 1 && texcoord[i].y >= 0 && texcoord[i].y <= 1;
+                }
 
                 const auto attr = std::string("TEXCOORD") + (UVChannel == 0 ? "" : std::to_string(UVChannel));
-                mesh->AddVertexArray(SceneObjectVertexArray(attr, VertexDataType::FLOAT2, std::move(texcoordBuffer)));
-            }
+                SceneObjectVertexArray texcoordArray(attr, VertexDataType::FLOAT2, std::move(texcoordBuffer));
+                // tiled texcoord out of [0, 1] use half instead of unorm16
+                if (m_PackVertices)
+                    arrays.emplace_back(texcoordArray.ConvertTo(normalized ? VertexDataType::UNORM16_2 : VertexDataType::HALF2));
+                else
+                    arrays.emplace_back(std::move(texcoordArray));
+            });
         }
 
-        // Read Tangent and Bitangent
-        if (_mesh->HasTangentsAndBitangents()) {
-            Core::Buffer tangentBuffer(_mesh->mNumVertices * sizeof(vec3f));
-            auto         tangent = reinterpret_cast<vec3f*>(tangentBuffer.GetData());
-            for (size_t i = 0; i < _mesh->mNumVertices; i++)
-                tangent[i] = vec3f(_mesh->mTangents[i].x, _mesh->mTangents[i].y, _mesh->mTangents[i].z);
-            mesh->AddVertexArray(SceneObjectVertexArray("TANGENT", VertexDataType::FLOAT3, std::move(tangentBuffer)));
-
-            Core::Buffer bitangentBuffer(_mesh->mNumVertices * sizeof(vec3f));
-            auto         bitangent = reinterpret_cast<vec3f*>(bitangentBuffer.GetData());
-            for (size_t i = 0; i < _mesh->mNumVertices; i++)
-                bitangent[i] = vec3f(_mesh->mBitangents[i].x, _mesh->mBitangents[i].y, _mesh->mBitangents[i].z);
-            mesh->AddVertexArray(SceneObjectVertexArray("BITANGENT", VertexDataType::FLOAT3, std::move(bitangentBuffer)));
-        }
+        // Read Normal, Tangent and Bitangent in one job, since the tangent frame is packed with the normal
+        if (_mesh->HasNormals() || _mesh->HasTangentsAndBitangents()) {
+            jobs.emplace_back([&](VertexArrays& arrays) {
+                std::optional<SceneObjectVertexArray> normalArray;
+                if (_mesh->HasNormals()) {
+                    Core::Buffer normalBuffer(_mesh->mNumVertices * sizeof(vec3f));
+                    auto         normal = reinterpret_cast<vec3f*>(normalBuffer.GetData());
+                    for (size_t i = 0; i < _mesh->mNumVertices; i++)
+                        normal[i] = vec3f(_mesh->mNormals[i].x, _mesh->mNormals[i].y, _mesh->mNormals[i].z);
+                    normalArray.emplace("NORMAL", VertexDataType::FLOAT3, std::move(normalBuffer));
+                }
 
-        // Read Indices
-        size_t indicesCount = 0;
-        for (size_t face = 0; face < _mesh->mNumFaces; face++)
-            indicesCount += _mesh->mFaces[face].mNumIndices;
+                if (_mesh->HasTangentsAndBitangents()) {
+                    Core::Buffer tangentBuffer(_mesh->mNumVertices * sizeof(vec3f));
+                    auto         tangent = reinterpret_cast<vec3f*>(tangentBuffer.GetData());
+                    for (size_t i = 0; i < _mesh->mNumVertices; i++)
+                        tangent[i] = vec3f(_mesh->mTangents[i].x, _mesh->mTangents[i].y, _mesh->mTangents[i].z);
+                    SceneObjectVertexArray tangentArray("TANGENT", VertexDataType::FLOAT3, std::move(tangentBuffer));
+
+                    Core::Buffer bitangentBuffer(_mesh->mNumVertices * sizeof(vec3f));
+                    auto         bitangent = reinterpret_cast<vec3f*>(bitangentBuffer.GetData());
+                    for (size_t i = 0; i < _mesh->mNumVertices; i++)
+                        bitangent[i] = vec3f(_mesh->mBitangents[i].x, _mesh->mBitangents[i].y, _mesh->mBitangents[i].z);
+                    SceneObjectVertexArray bitangentArray("BITANGENT", VertexDataType::FLOAT3, std::move(bitangentBuffer));
+
+                    // the bitangent is folded into the tangent frame as a sign
+                    if (m_PackVertices && normalArray) {
+                        arrays.emplace_back(SceneObjectVertexArray::PackTangentFrame(*normalArray, tangentArray, bitangentArray));
+                    } else {
+                        arrays.emplace_back(std::move(tangentArray));
+                        arrays.emplace_back(std::move(bitangentArray));
+                    }
+                }
 
-        Core::Buffer indexBuffer(indicesCount * sizeof(int));
-        auto         indices = reinterpret_cast<int*>(indexBuffer.GetData());
-        for (size_t face = 0; face < _mesh->mNumFaces; face++)
-            for (size_t i = 0; i < _mesh->mFaces[face].mNumIndices; i++)
-                *indices++ = _mesh->mFaces[face].mIndices[i];  // assignment then increase
+                if (normalArray)
+                    arrays.emplace_back(m_PackVertices ? normalArray->ConvertTo(VertexDataType::OCT_NORMAL) : std::move(*normalArray));
+            });
+        }
 
+        // Read Indices
+        Core::Buffer indexBuffer;
+        jobs.emplace_back([&](VertexArrays&) {
+            size_t indicesCount = 0;
+            for (size_t face = 0; face < _mesh->mNumFaces; face++)
+                indicesCount += _mesh->mFaces[face].mNumIndices;
+
+            indexBuffer  = Core::Buffer(indicesCount * sizeof(int));
+            auto indices = reinterpret_cast<int*>(indexBuffer.GetData());
+            for (size_t face = 0; face < _mesh->mNumFaces; face++)
+                for (size_t i = 0; i < _mesh->mFaces[face].mNumIndices; i++)
+                    *indices++ = _mesh->mFaces[face].mIndices[i];  // assignment then increase
+        });
+
+        std::vector<VertexArrays> results(jobs.size());
+        g_ThreadManager->ParallelFor(0, jobs.size(), [&](size_t i) { jobs[i](results[i]); });
+        for (auto&& arrays : results)
+            for (auto&& array : arrays) mesh->AddVertexArray(std::move(array));
         mesh->AddIndexArray(SceneObjectIndexArray(IndexDataType::INT32, std::move(indexBuffer)));
 
+        // reorder for the vertex cache, overdraw and vertex fetch, and narrow the indices
+        OptimizeMesh(*mesh);
+        if (m_InterleaveVertices) mesh->SetVertexLayout(VertexLayout::INTERLEAVED);
+
         const std::string materialRef = _scene->mMaterials[_mesh->mMaterialIndex]->GetName().C_Str();
         mesh->SetMaterial(scene.Materials.at(materialRef));
         return mesh;
@@ -256,12 +316,36 @@ Scene AssimpParser::Parse(const Core::Buffer& buf, const std::filesystem::path&
         return ret;
     };
 
+    // Convert every mesh once on the thread pool, no matter how many nodes use it
+    std::vector<std::unique_ptr<SceneObjectMesh>> meshes(_scene->mNumMeshes);
+    g_ThreadManager->ParallelFor(0, meshes.size(), [&](size_t i) { meshes[i] = createMesh(_scene->mMeshes[i]); });
+
+    // The nodes using the same meshes share a geometry, so the instances only differ in the transforms.
+    // The last geometry using a mesh takes it, and the others copy it.
+    std::map<std::vector<unsigned>, std::shared_ptr<SceneObjectGeometry>> sharedGeometries;
+    std::vector<size_t>                                                   meshUseCount(meshes.size(), 0);
+    std::function<void(const aiNode*)>                                    countMeshUse = [&](const aiNode* _node) {
+        if (_node->mNumMeshes > 0) {
+            auto [iter, inserted] = sharedGeometries.try_emplace(std::vector<unsigned>(_node->mMeshes, _node->mMeshes + _node->mNumMeshes));
+            if (inserted)
+                for (auto index : iter->first) meshUseCount[index]++;
+        }
+        for (size_t i = 0; i < _node->mNumChildren; i++) countMeshUse(_node->mChildren[i]);
+    };
+    countMeshUse(_scene->mRootNode);
+
+    std::vector<std::shared_ptr<SceneObjectGeometry>> geometries;
+
     auto createGeometry = [&](const aiNode* _node) -> std::shared_ptr<SceneObjectGeometry> {
-        auto geometry = std::make_shared<SceneObjectGeometry>();
+        auto& geometry = sharedGeometries.at(std::vector<unsigned>(_node->mMeshes, _node->mMeshes + _node->mNumMeshes));
+        if (geometry) return geometry;
+
+        geometry = std::make_shared<SceneObjectGeometry>();
         for (size_t i = 0; i < _node->mNumMeshes; i++) {
-            auto _mesh = _scene->mMeshes[_node->mMeshes[i]];
-            geometry->AddMesh(createMesh(_mesh));
+            const auto index = _node->mMeshes[i];
+            geometry->AddMesh(--meshUseCount[index] == 0 ? std::move(meshes[index]) : CopyMesh(*meshes[index]));
         }
+        geometries.emplace_back(geometry);
         return geometry;
     };
 
@@ -314,6 +398,9 @@ Scene AssimpParser::Parse(const Core::Buffer& buf, const std::filesystem::path&
 
     scene.SceneGraph = convert(_scene->mRootNode);
 
+    // The scene graph is assembled, then the LODs of the geometries are generated in parallel
+    g_ThreadManager->ParallelFor(0, geometries.size(), [&](size_t i) { GenerateLODs(*geometries[i], m_LODLevels); });
+
     end = std::chrono::high_resolution_clock::now();
     logger->info("[Assimp] Processing costs {} ms.", std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count());
     return scene;
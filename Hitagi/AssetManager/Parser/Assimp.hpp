@@ -1,9 +1,22 @@
 #pragma once
 #include "SceneParser.hpp"
+#include "../MeshOptimizer.hpp"
 
 namespace Hitagi::Asset {
 class AssimpParser : public SceneParser {
 public:
+    // When packVertices is true the normal, tangent frame, color and texcoord
+    // are stored in the compact vertex formats, shaders must decode them.
+    // When interleaveVertices is true the meshes use VertexLayout::INTERLEAVED.
+    // The LODs of every geometry are generated by lodLevels, pass empty to keep LOD 0 only.
+    AssimpParser(bool packVertices = false, bool interleaveVertices = false, std::vector<LODLevel> lodLevels = defaultLODLevels)
+        : m_PackVertices(packVertices), m_InterleaveVertices(interleaveVertices), m_LODLevels(std::move(lodLevels)) {}
+
     Scene Parse(const Core::Buffer& buf,const std::filesystem::path& scenePath) final;
+
+private:
+    bool                  m_PackVertices;
+    bool                  m_InterleaveVertices;
+    std::vector<LODLevel> m_LODLevels;
 };
 }  // namespace Hitagi::Asset
\ No newline at end of file
@@ -2,7 +2,9 @@
 
 #include <spdlog/spdlog.h>
 
-#include "HitagiMath.hpp"
+#include <cstring>
+
+#include "PixelConversion.hpp"
 
 namespace Hitagi::Asset {
 
@@ -13,6 +15,11 @@ Image BmpParser::Parse(const Core::Buffer& buf) {
         return Image{};
     }
 
+    if (buf.GetDataSize() < BITMAP_FILEHEADER_SIZE + sizeof(BITMAP_HEADER)) {
+        logger->warn("[BMP] The header is truncated.");
+        return Image{};
+    }
+
     const auto* fileHeader =
         reinterpret_cast<const BITMAP_FILEHEADER*>(buf.GetData());
     const auto* bmpHeader = reinterpret_cast<const BITMAP_HEADER*>(
@@ -30,26 +37,64 @@ Image BmpParser::Parse(const Core::Buffer& buf) {
         logger->debug("[BMP] Image Comperession: {}", bmpHeader->Compression);
         logger->debug("[BMP] Image Size:         {}", bmpHeader->SizeImage);
 
-        auto  width      = std::abs(bmpHeader->Width);
-        auto  height     = std::abs(bmpHeader->Height);
-        auto  bitcount   = 32;
-        auto  byte_count = bitcount >> 3;
-        auto  pitch      = ((width * bitcount >> 3) + 3) & ~3;
-        auto  dataSize   = pitch * height;
+        const auto     width       = static_cast<uint32_t>(std::abs(bmpHeader->Width));
+        const auto     height      = static_cast<uint32_t>(std::abs(bmpHeader->Height));
+        const uint16_t srcBitcount = bmpHeader->BitCount;
+        // rows are aligned to 4 bytes in the file
+        const size_t srcPitch = ((static_cast<size_t>(width) * srcBitcount + 31) / 32) * 4;
+        // a positive height means the rows are stored from bottom to top, the same as the image
+        const bool topToBottom = bmpHeader->Height < 0;
+
+        if (srcBitcount != 16 && srcBitcount != 24 && srcBitcount != 32) {
+            logger->warn("[BMP] Sorry, only 16, 24 and 32 bits BMP are supported at now.");
+            return Image();
+        }
+        // BI_RGB and BI_BITFIELDS
+        if (bmpHeader->Compression != 0 && bmpHeader->Compression != 3) {
+            logger->warn("[BMP] Compressed BMP is not supported.");
+            return Image();
+        }
+        if (fileHeader->BitsOffset + srcPitch * height > buf.GetDataSize()) {
+            logger->warn("[BMP] The pixel data is truncated.");
+            return Image();
+        }
+        // The red, green and blue masks of BI_BITFIELDS follow the 40 bytes of BITMAPINFOHEADER, and they
+        // are the fields at the same place in the V2 to V5 headers. 16 bits pixels are 5-6-5 or 5-5-5
+        bool rgb565 = false;
+        if (srcBitcount == 16 && bmpHeader->Compression == 3) {
+            constexpr size_t masksOffset = BITMAP_FILEHEADER_SIZE + sizeof(BITMAP_HEADER);
+            if (bmpHeader->HeaderSize < sizeof(BITMAP_HEADER) || masksOffset + 3 * sizeof(uint32_t) > buf.GetDataSize()) {
+                logger->warn("[BMP] The color masks are truncated.");
+                return Image();
+            }
+            uint32_t greenMask;
+            std::memcpy(&greenMask, buf.GetData() + masksOffset + sizeof(uint32_t), sizeof(greenMask));
+            rgb565 = greenMask == 0x07E0;
+        }
+
+        auto  bitcount = 32;
+        auto  pitch    = ((width * bitcount >> 3) + 3) & ~3;
+        auto  dataSize = pitch * height;
         Image img(width, height, bitcount, pitch, dataSize);
-        auto  data = reinterpret_cast<R8G8B8A8Unorm*>(img.GetData());
-        if (bitcount < 24) {
-            logger->warn("[BMP] Sorry, only true color BMP is supported at now.");
-        } else {
-            const uint8_t* sourceData =
-                reinterpret_cast<const uint8_t*>(buf.GetData()) +
-                fileHeader->BitsOffset;
-            for (int32_t y = height - 1; y >= 0; y--) {
-                for (uint32_t x = 0; x < width; x++) {
-                    data->bgra = *reinterpret_cast<const R8G8B8A8Unorm*>(
-                        sourceData + pitch * y + x * byte_count);
-                    data++;
-                }
+
+        const uint8_t* sourceData = buf.GetData() + fileHeader->BitsOffset;
+        for (uint32_t y = 0; y < height; y++) {
+            std::span<const uint8_t> src(sourceData + srcPitch * y, srcPitch);
+            std::span<uint8_t>       dst(img.GetData() + pitch * (topToBottom ? height - 1 - y : y), pitch);
+            switch (srcBitcount) {
+                case 16:
+                    if (rgb565)
+                        RGB565ToRGBA8(src.first(2 * width), dst);
+                    else
+                        RGB555ToRGBA8(src.first(2 * width), dst);
+                    break;
+                case 24:
+                    BGRToRGBA8(src.first(3 * width), dst);
+                    break;
+                case 32:
+                    // the fourth byte of BI_RGB is unused
+                    BGRAToRGBA8(src.first(4 * width), dst, bmpHeader->Compression == 0);
+                    break;
             }
         }
 
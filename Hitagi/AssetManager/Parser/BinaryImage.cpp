@@ -0,0 +1,103 @@
+#include "BinaryImage.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <array>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+namespace Hitagi::Asset {
+namespace {
+
+constexpr std::array<char, 4> magic   = {'H', 'T', 'E', 'X'};
+constexpr uint32_t             version = 1;
+
+struct Header {
+    std::array<char, 4> magic;
+    uint32_t            version;
+    uint32_t            format, mipLevels;
+};
+
+// The data of a level is 16 bytes aligned
+struct LevelRecord {
+    uint32_t width, height, pitch;
+    uint32_t offset, size;
+};
+
+constexpr uint32_t Align(uint32_t offset) { return (offset + 15) & ~15u; }
+
+}  // namespace
+
+Core::Buffer WriteBinaryImage(const Image& image) {
+    const auto levels = static_cast<uint32_t>(image.GetMipLevels());
+
+    std::vector<LevelRecord> records(levels);
+    uint32_t                 offset = Align(sizeof(Header) + levels * sizeof(LevelRecord));
+    for (uint32_t level = 0; level < levels; level++) {
+        auto& mip      = image.GetMip(level);
+        records[level] = {mip.GetWidth(), mip.GetHeight(), mip.GetPitch(), offset, static_cast<uint32_t>(mip.GetDataSize())};
+        offset         = Align(offset + records[level].size);
+    }
+
+    Core::Buffer buffer(offset);
+    std::memset(buffer.GetData(), 0, buffer.GetDataSize());
+    const Header header{magic, version, static_cast<uint32_t>(image.GetFormat()), levels};
+    std::memcpy(buffer.GetData(), &header, sizeof(Header));
+    std::memcpy(buffer.GetData() + sizeof(Header), records.data(), records.size() * sizeof(LevelRecord));
+    for (uint32_t level = 0; level < levels; level++)
+        std::memcpy(buffer.GetData() + records[level].offset, image.GetMip(level).GetData(), records[level].size);
+
+    return buffer;
+}
+
+Image BinaryImageParser::Parse(const Core::Buffer& buf) {
+    auto logger = spdlog::get("AssetManager");
+
+    Header header;
+    if (buf.GetDataSize() < sizeof(Header)) {
+        logger->error("[HTEX] The file is too small, and return a empty image.");
+        return Image{};
+    }
+    std::memcpy(&header, buf.GetData(), sizeof(Header));
+    if (header.magic != magic || header.version != version || header.mipLevels == 0 ||
+        sizeof(Header) + static_cast<uint64_t>(header.mipLevels) * sizeof(LevelRecord) > buf.GetDataSize()) {
+        logger->error("[HTEX] The file is corrupted or of another version, and return a empty image.");
+        return Image{};
+    }
+
+    const auto format  = static_cast<PixelFormat>(header.format);
+    const auto bitSize = header.format <= std::numeric_limits<std::underlying_type_t<PixelFormat>>::max() ? GetPixelFormatBitSize(format) : 0;
+    if (bitSize == 0) {
+        logger->error("[HTEX] The pixel format {} is unknown, and return a empty image.", header.format);
+        return Image{};
+    }
+
+    std::vector<Image> levels;
+    for (uint32_t level = 0; level < header.mipLevels; level++) {
+        LevelRecord record;
+        std::memcpy(&record, buf.GetData() + sizeof(Header) + level * sizeof(LevelRecord), sizeof(LevelRecord));
+        if (static_cast<uint64_t>(record.offset) + record.size > buf.GetDataSize()) {
+            logger->error("[HTEX] The level {} is out of the file, and return a empty image.", level);
+            return Image{};
+        }
+        // A row of a block compressed level is a row of 4x4 blocks
+        const bool     compressed = IsBlockCompressed(format);
+        const uint64_t rows       = compressed ? (record.height + 3) / 4 : record.height;
+        const uint64_t minPitch   = compressed ? (record.width + 3) / 4 * (16 * bitSize / 8) : (static_cast<uint64_t>(record.width) * bitSize + 7) / 8;
+        if (record.width == 0 || record.height == 0 || record.pitch < minPitch || record.size < record.pitch * rows) {
+            logger->error("[HTEX] The level {} is smaller than its size, and return a empty image.", level);
+            return Image{};
+        }
+        Image image(record.width, record.height, format, record.pitch, record.size);
+        std::memcpy(image.GetData(), buf.GetData() + record.offset, record.size);
+        levels.emplace_back(std::move(image));
+    }
+
+    Image result = std::move(levels.front());
+    levels.erase(levels.begin());
+    result.SetMips(std::move(levels));
+    return result;
+}
+
+}  // namespace Hitagi::Asset
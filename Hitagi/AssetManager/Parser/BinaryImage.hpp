@@ -0,0 +1,15 @@
+#pragma once
+#include "ImageParser.hpp"
+
+namespace Hitagi::Asset {
+
+// Engine-native cooked image, the pixels of every mip level are stored in the pixel format
+// used by the GPU, so the image is loaded without decoding.
+class BinaryImageParser : public ImageParser {
+public:
+    Image Parse(const Core::Buffer& buf) final;
+};
+
+Core::Buffer WriteBinaryImage(const Image& image);
+
+}  // namespace Hitagi::Asset
@@ -0,0 +1,636 @@
+#include "BinaryScene.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <cstring>
+#include <span>
+#include <unordered_map>
+
+namespace Hitagi::Asset {
+namespace {
+
+constexpr uint32_t magic   = "HSCN"_i32;
+constexpr uint32_t version = 3;
+
+// All the fields are 4 bytes, so the records can be read in place from a buffer with the default alignment
+struct StringRef {
+    uint32_t offset, size;
+};
+
+struct Section {
+    uint32_t offset, count;
+};
+
+struct Header {
+    uint32_t magic, version, fileSize;
+    Section  strings;  // the count is in bytes
+    Section  textures, materials, cameras, lights, geometries, meshes, vertexArrays, nodes;
+    Section  blob;  // the count is in bytes
+};
+
+constexpr int32_t nullIndex = -1;
+
+struct TextureRecord {
+    StringRef name, path;
+};
+
+struct MaterialRecord {
+    StringRef key, name;
+    vec4f     ambient, diffuse, specular, emission, transparency;
+    float     specularPower, opacity;
+    int32_t   diffuseMap, specularMap, specularPowerMap, emissionMap, opacityMap, transparencyMap, normalMap;
+};
+
+struct CameraRecord {
+    StringRef key;
+    float     aspect, nearClip, farClip, fov;
+};
+
+enum struct LightType : uint32_t { None,
+                                   Point,
+                                   Spot,
+                                   Infinite };
+
+struct LightRecord {
+    StringRef key;
+    LightType type;
+    vec4f     color;
+    float     intensity;
+    uint32_t  castShadow;
+    vec3f     direction;
+    float     innerConeAngle, outerConeAngle;
+};
+
+struct GeometryRecord {
+    StringRef                key;
+    uint32_t                 firstMesh, meshCount;
+    uint32_t                 visible, shadow, motionBlur;
+    SceneObjectCollisionType collisionType;
+    std::array<float, 10>    collisionParameters;
+};
+
+struct MeshRecord {
+    uint32_t      lod;
+    float         lodError;  // the error of the LOD, the same for all the meshes of a LOD
+    uint32_t      firstVertexArray, vertexArrayCount;
+    PrimitiveType primitiveType;
+    VertexLayout  vertexLayout;
+    int32_t       material;
+    IndexDataType indexType;
+    uint32_t      indexOffset, indexSize;
+};
+
+struct VertexArrayRecord {
+    StringRef      attribute;
+    VertexDataType dataType;
+    uint32_t       offset, size;
+};
+
+enum struct NodeType : uint32_t { Empty,
+                                  Geometry,
+                                  Camera,
+                                  Light };
+
+// The nodes are in pre-order, so a parent is always before its children
+struct NodeRecord {
+    StringRef name;
+    NodeType  type;
+    int32_t   parent;
+    int32_t   object;
+    mat4f     transform;
+    // geometry node
+    uint32_t visible, shadow, motionBlur;
+    // camera node
+    vec3f position, up, lookAt;
+};
+
+template <typename... T>
+constexpr bool IsRecord = ((std::is_trivially_copyable_v<T> && alignof(T) <= 4) && ...);
+static_assert(IsRecord<Header, TextureRecord, MaterialRecord, CameraRecord, LightRecord, GeometryRecord, MeshRecord, VertexArrayRecord, NodeRecord>);
+
+bool IsKnown(PrimitiveType type) {
+    switch (type) {
+        case PrimitiveType::None:
+        case PrimitiveType::POINT_LIST:
+        case PrimitiveType::LINE_LIST:
+        case PrimitiveType::LINE_STRIP:
+        case PrimitiveType::TRI_LIST:
+        case PrimitiveType::TRI_FAN:
+        case PrimitiveType::TRI_STRIP:
+        case PrimitiveType::PATCH:
+        case PrimitiveType::LINE_LIST_ADJACENCY:
+        case PrimitiveType::LINE_STRIP_ADJACENCY:
+        case PrimitiveType::TRI_LIST_ADJACENCY:
+        case PrimitiveType::TRI_STRIP_ADJACENCY:
+        case PrimitiveType::RECT_LIST:
+        case PrimitiveType::LINE_LOOP:
+        case PrimitiveType::QUAD_LIST:
+        case PrimitiveType::QUAD_STRIP:
+        case PrimitiveType::POLYGON:
+            return true;
+    }
+    return false;
+}
+
+constexpr uint32_t Align(uint32_t offset, uint32_t alignment = 16) { return (offset + alignment - 1) & ~(alignment - 1); }
+
+class Writer {
+public:
+    Writer(const TexturePathMap& texturePath) : m_TexturePath(texturePath) {}
+    Core::Buffer Write(const Scene& scene);
+
+private:
+    StringRef AddString(std::string_view str);
+    uint32_t  AddBlob(const uint8_t* data, size_t size);
+    int32_t   AddTexture(const std::shared_ptr<SceneObjectTexture>& texture);
+    void      AddNode(const BaseSceneNode& node, int32_t parent);
+
+    template <typename T>
+    Section Place(std::vector<uint8_t>& file, const std::vector<T>& records);
+
+    const TexturePathMap& m_TexturePath;
+    std::string           m_Strings;
+    std::vector<uint8_t>  m_Blob;
+
+    std::vector<TextureRecord>     m_Textures;
+    std::vector<MaterialRecord>    m_Materials;
+    std::vector<CameraRecord>      m_Cameras;
+    std::vector<LightRecord>       m_Lights;
+    std::vector<GeometryRecord>    m_Geometries;
+    std::vector<MeshRecord>        m_Meshes;
+    std::vector<VertexArrayRecord> m_VertexArrays;
+    std::vector<NodeRecord>        m_Nodes;
+
+    std::unordered_map<const void*, int32_t> m_TextureIndex, m_MaterialIndex, m_CameraIndex, m_LightIndex, m_GeometryIndex;
+};
+
+StringRef Writer::AddString(std::string_view str) {
+    StringRef result{static_cast<uint32_t>(m_Strings.size()), static_cast<uint32_t>(str.size())};
+    m_Strings.append(str);
+    return result;
+}
+
+uint32_t Writer::AddBlob(const uint8_t* data, size_t size) {
+    const uint32_t offset = Align(static_cast<uint32_t>(m_Blob.size()));
+    m_Blob.resize(offset + size);
+    if (size != 0) std::memcpy(m_Blob.data() + offset, data, size);
+    return offset;
+}
+
+int32_t Writer::AddTexture(const std::shared_ptr<SceneObjectTexture>& texture) {
+    if (!texture) return nullIndex;
+    if (auto iter = m_TextureIndex.find(texture.get()); iter != m_TextureIndex.end()) return iter->second;
+
+    // the image of an embedded texture is not stored
+    const auto index = static_cast<int32_t>(m_Textures.size());
+    const auto path  = m_TexturePath ? m_TexturePath(texture->GetTexturePath()) : texture->GetTexturePath();
+    m_Textures.emplace_back(TextureRecord{AddString(texture->GetName()), AddString(path.string())});
+    m_TextureIndex.emplace(texture.get(), index);
+    return index;
+}
+
+void Writer::AddNode(const BaseSceneNode& node, int32_t parent) {
+    NodeRecord record{};
+    record.name      = AddString(node.GetName());
+    record.type      = NodeType::Empty;
+    record.parent    = parent;
+    record.object    = nullIndex;
+    record.transform = node.GetCalculatedTransform();
+
+    auto objectIndex = [](const auto& indices, const auto& ref) {
+        auto object = ref.lock();
+        if (!object) return nullIndex;
+        auto iter = indices.find(object.get());
+        return iter == indices.end() ? nullIndex : iter->second;
+    };
+    // the getters of the scene nodes are not const
+    auto& mutableNode = const_cast<BaseSceneNode&>(node);
+    if (auto geometryNode = dynamic_cast<SceneGeometryNode*>(&mutableNode)) {
+        record.type       = NodeType::Geometry;
+        record.object     = objectIndex(m_GeometryIndex, geometryNode->GetSceneObjectRef());
+        record.visible    = geometryNode->Visible();
+        record.shadow     = geometryNode->CastShadow();
+        record.motionBlur = geometryNode->MotionBlur();
+    } else if (auto cameraNode = dynamic_cast<SceneCameraNode*>(&mutableNode)) {
+        record.type     = NodeType::Camera;
+        record.object   = objectIndex(m_CameraIndex, cameraNode->GetSceneObjectRef());
+        record.position = cameraNode->GetLocalPosition();
+        record.up       = cameraNode->GetLocalUp();
+        record.lookAt   = cameraNode->GetLocalLookAt();
+    } else if (auto lightNode = dynamic_cast<SceneLightNode*>(&mutableNode)) {
+        record.type   = NodeType::Light;
+        record.object = objectIndex(m_LightIndex, lightNode->GetSceneObjectRef());
+    }
+
+    const auto index = static_cast<int32_t>(m_Nodes.size());
+    m_Nodes.emplace_back(record);
+    for (auto&& child : node.GetChildren())
+        if (child) AddNode(*child, index);
+}
+
+template <typename T>
+Section Writer::Place(std::vector<uint8_t>& file, const std::vector<T>& records) {
+    const uint32_t offset = Align(static_cast<uint32_t>(file.size()));
+    file.resize(offset + records.size() * sizeof(T));
+    if (!records.empty()) std::memcpy(file.data() + offset, records.data(), records.size() * sizeof(T));
+    return {offset, static_cast<uint32_t>(records.size())};
+}
+
+Core::Buffer Writer::Write(const Scene& scene) {
+    for (auto&& [key, material] : scene.Materials) {
+        if (!material) continue;
+        MaterialRecord record{};
+        record.key              = AddString(key);
+        record.name             = AddString(material->GetName());
+        record.ambient          = material->GetAmbientColor().Value;
+        record.diffuse          = material->GetDiffuseColor().Value;
+        record.specular         = material->GetSpecularColor().Value;
+        record.emission         = material->GetEmission().Value;
+        record.transparency     = material->GetTransparency().Value;
+        record.specularPower    = material->GetSpecularPower().Value;
+        record.opacity          = material->GetOpacity().Value;
+        record.diffuseMap       = AddTexture(material->GetDiffuseColor().ValueMap);
+        record.specularMap      = AddTexture(material->GetSpecularColor().ValueMap);
+        record.specularPowerMap = AddTexture(material->GetSpecularPower().ValueMap);
+        record.emissionMap      = AddTexture(material->GetEmission().ValueMap);
+        record.opacityMap       = AddTexture(material->GetOpacity().ValueMap);
+        record.transparencyMap  = AddTexture(material->GetTransparency().ValueMap);
+        record.normalMap        = AddTexture(material->GetNormal().ValueMap);
+
+        m_MaterialIndex.emplace(material.get(), static_cast<int32_t>(m_Materials.size()));
+        m_Materials.emplace_back(record);
+    }
+
+    for (auto&& [key, camera] : scene.Cameras) {
+        if (!camera) continue;
+        m_CameraIndex.emplace(camera.get(), static_cast<int32_t>(m_Cameras.size()));
+        m_Cameras.emplace_back(CameraRecord{AddString(key), camera->GetAspect(), camera->GetNearClipDistance(), camera->GetFarClipDistance(), camera->GetFov()});
+    }
+
+    // the unsupported lights of the importers are null
+    for (auto&& [key, light] : scene.Lights) {
+        LightRecord record{};
+        record.key  = AddString(key);
+        record.type = LightType::None;
+        if (light) {
+            record.color      = light->GetColor().Value;
+            record.intensity  = light->GetIntensity();
+            record.castShadow = light->CastShadow();
+            if (auto spot = std::dynamic_pointer_cast<SceneObjectSpotLight>(light)) {
+                record.type           = LightType::Spot;
+                record.direction      = spot->GetDirection();
+                record.innerConeAngle = spot->GetInnerConeAngle();
+                record.outerConeAngle = spot->GetOuterConeAngle();
+            } else if (std::dynamic_pointer_cast<SceneObjectInfiniteLight>(light)) {
+                record.type = LightType::Infinite;
+            } else {
+                record.type = LightType::Point;
+            }
+            m_LightIndex.emplace(light.get(), static_cast<int32_t>(m_Lights.size()));
+        }
+        m_Lights.emplace_back(record);
+    }
+
+    for (auto&& [key, geometry] : scene.Geometries) {
+        if (!geometry) continue;
+        // a geometry shared by many keys is written once, the other records refer to its meshes
+        if (auto iter = m_GeometryIndex.find(geometry.get()); iter != m_GeometryIndex.end()) {
+            GeometryRecord record = m_Geometries[iter->second];
+            record.key            = AddString(key);
+            m_Geometries.emplace_back(record);
+            continue;
+        }
+        GeometryRecord record{};
+        record.key           = AddString(key);
+        record.firstMesh     = static_cast<uint32_t>(m_Meshes.size());
+        record.visible       = geometry->Visible();
+        record.shadow        = geometry->CastShadow();
+        record.motionBlur    = geometry->MotionBlur();
+        record.collisionType = geometry->CollisionType();
+        std::copy_n(geometry->CollisionParameters(), record.collisionParameters.size(), record.collisionParameters.begin());
+
+        for (size_t lod = 0; lod < geometry->GetLODCount(); lod++) {
+            for (auto&& mesh : geometry->GetMeshes(lod)) {
+                MeshRecord meshRecord{};
+                meshRecord.lod              = static_cast<uint32_t>(lod);
+                meshRecord.lodError         = geometry->GetLODError(lod);
+                meshRecord.firstVertexArray = static_cast<uint32_t>(m_VertexArrays.size());
+                meshRecord.vertexArrayCount = static_cast<uint32_t>(mesh->GetVertexArraysCount());
+                meshRecord.primitiveType    = mesh->GetPrimitiveType();
+                meshRecord.vertexLayout     = mesh->GetVertexLayout();
+                meshRecord.material         = nullIndex;
+                if (auto material = mesh->GetMaterial().lock())
+                    if (auto iter = m_MaterialIndex.find(material.get()); iter != m_MaterialIndex.end())
+                        meshRecord.material = iter->second;
+
+                const auto& indexArray = mesh->GetIndexArray();
+                meshRecord.indexType   = indexArray.GetIndexType();
+                meshRecord.indexOffset = AddBlob(indexArray.GetData(), indexArray.GetDataSize());
+                meshRecord.indexSize   = static_cast<uint32_t>(indexArray.GetDataSize());
+
+                for (auto&& vertexArray : mesh->GetVertexArrays()) {
+                    m_VertexArrays.emplace_back(VertexArrayRecord{
+                        AddString(vertexArray.GetAttributeName()),
+                        vertexArray.GetDataType(),
+                        AddBlob(vertexArray.GetData(), vertexArray.GetDataSize()),
+                        static_cast<uint32_t>(vertexArray.GetDataSize()),
+                    });
+                }
+                m_Meshes.emplace_back(meshRecord);
+            }
+        }
+        record.meshCount = static_cast<uint32_t>(m_Meshes.size()) - record.firstMesh;
+        m_GeometryIndex.emplace(geometry.get(), static_cast<int32_t>(m_Geometries.size()));
+        m_Geometries.emplace_back(record);
+    }
+
+    if (scene.SceneGraph) AddNode(*scene.SceneGraph, nullIndex);
+
+    std::vector<uint8_t> file(sizeof(Header));
+    Header               header{};
+    header.magic        = magic;
+    header.version      = version;
+    header.textures     = Place(file, m_Textures);
+    header.materials    = Place(file, m_Materials);
+    header.cameras      = Place(file, m_Cameras);
+    header.lights       = Place(file, m_Lights);
+    header.geometries   = Place(file, m_Geometries);
+    header.meshes       = Place(file, m_Meshes);
+    header.vertexArrays = Place(file, m_VertexArrays);
+    header.nodes        = Place(file, m_Nodes);
+    header.strings      = Place(file, std::vector<uint8_t>(m_Strings.begin(), m_Strings.end()));
+    header.blob         = Place(file, m_Blob);
+    header.fileSize     = static_cast<uint32_t>(file.size());
+    std::memcpy(file.data(), &header, sizeof(Header));
+
+    return Core::Buffer(file.data(), file.size());
+}
+
+class Reader {
+public:
+    Reader(const Core::Buffer& buf) : m_Data(buf.GetData()), m_Size(buf.GetDataSize()) {}
+
+    // Return false if the sections are out of the buffer
+    bool Validate();
+
+    template <typename T>
+    std::span<const T> Get(const Section& section) const {
+        return {reinterpret_cast<const T*>(m_Data + section.offset), section.count};
+    }
+    std::string_view GetString(const StringRef& ref) const {
+        return {reinterpret_cast<const char*>(m_Data + m_Header->strings.offset + ref.offset), ref.size};
+    }
+    Core::Buffer GetBlob(uint32_t offset, uint32_t size) const {
+        return Core::Buffer(m_Data + m_Header->blob.offset + offset, size);
+    }
+
+    const Header* m_Header = nullptr;
+
+private:
+    bool InRange(uint64_t offset, uint64_t size) const { return offset + size <= m_Size; }
+    template <typename T>
+    bool CheckSection(const Section& section) const {
+        return section.offset % alignof(T) == 0 && InRange(section.offset, static_cast<uint64_t>(section.count) * sizeof(T));
+    }
+
+    const uint8_t* m_Data;
+    size_t         m_Size;
+};
+
+bool Reader::Validate() {
+    m_Header = reinterpret_cast<const Header*>(m_Data);
+    if (!CheckSection<TextureRecord>(m_Header->textures) ||
+        !CheckSection<MaterialRecord>(m_Header->materials) ||
+        !CheckSection<CameraRecord>(m_Header->cameras) ||
+        !CheckSection<LightRecord>(m_Header->lights) ||
+        !CheckSection<GeometryRecord>(m_Header->geometries) ||
+        !CheckSection<MeshRecord>(m_Header->meshes) ||
+        !CheckSection<VertexArrayRecord>(m_Header->vertexArrays) ||
+        !CheckSection<NodeRecord>(m_Header->nodes) ||
+        !CheckSection<uint8_t>(m_Header->strings) ||
+        !CheckSection<uint8_t>(m_Header->blob))
+        return false;
+
+    auto checkString = [&](const StringRef& ref) { return static_cast<uint64_t>(ref.offset) + ref.size <= m_Header->strings.count; };
+    auto checkBlob   = [&](uint32_t offset, uint32_t size) { return static_cast<uint64_t>(offset) + size <= m_Header->blob.count; };
+    auto checkIndex  = [](int32_t index, uint32_t count) { return index == nullIndex || (index >= 0 && static_cast<uint32_t>(index) < count); };
+
+    for (auto&& texture : Get<TextureRecord>(m_Header->textures))
+        if (!checkString(texture.name) || !checkString(texture.path)) return false;
+    for (auto&& material : Get<MaterialRecord>(m_Header->materials)) {
+        if (!checkString(material.key) || !checkString(material.name)) return false;
+        for (int32_t map : {material.diffuseMap, material.specularMap, material.specularPowerMap, material.emissionMap,
+                            material.opacityMap, material.transparencyMap, material.normalMap})
+            if (!checkIndex(map, m_Header->textures.count)) return false;
+    }
+    for (auto&& camera : Get<CameraRecord>(m_Header->cameras))
+        if (!checkString(camera.key)) return false;
+    for (auto&& light : Get<LightRecord>(m_Header->lights))
+        if (!checkString(light.key)) return false;
+    for (auto&& geometry : Get<GeometryRecord>(m_Header->geometries)) {
+        if (!checkString(geometry.key) || static_cast<uint64_t>(geometry.firstMesh) + geometry.meshCount > m_Header->meshes.count) return false;
+        // a LOD has one mesh at least
+        for (auto&& mesh : Get<MeshRecord>(m_Header->meshes).subspan(geometry.firstMesh, geometry.meshCount))
+            if (mesh.lod >= geometry.meshCount) return false;
+    }
+    for (auto&& mesh : Get<MeshRecord>(m_Header->meshes)) {
+        if (!checkBlob(mesh.indexOffset, mesh.indexSize) || !checkIndex(mesh.material, m_Header->materials.count) ||
+            static_cast<uint64_t>(mesh.firstVertexArray) + mesh.vertexArrayCount > m_Header->vertexArrays.count)
+            return false;
+        // the size of an unknown type is 0, the element count would be divided by it
+        if (SceneObjectIndexArray::GetIndexSize(mesh.indexType) == 0 || !IsKnown(mesh.primitiveType) ||
+            (mesh.vertexLayout != VertexLayout::SEPARATE && mesh.vertexLayout != VertexLayout::INTERLEAVED))
+            return false;
+    }
+    for (auto&& vertexArray : Get<VertexArrayRecord>(m_Header->vertexArrays)) {
+        if (!checkString(vertexArray.attribute) || !checkBlob(vertexArray.offset, vertexArray.size) ||
+            SceneObjectVertexArray::GetVertexSize(vertexArray.dataType) == 0)
+            return false;
+    }
+
+    const auto nodes = Get<NodeRecord>(m_Header->nodes);
+    for (size_t i = 0; i < nodes.size(); i++) {
+        const auto& node = nodes[i];
+        // pre-order, the root has no parent and the parent of the others is before them
+        const bool validParent = i == 0 ? node.parent == nullIndex : node.parent >= 0 && node.parent < static_cast<int64_t>(i);
+        if (!checkString(node.name) || !validParent || node.type > NodeType::Light) return false;
+        const uint32_t objectCount = node.type == NodeType::Geometry ? m_Header->geometries.count
+                                     : node.type == NodeType::Camera ? m_Header->cameras.count
+                                     : node.type == NodeType::Light  ? m_Header->lights.count
+                                                                     : 0;
+        if (!checkIndex(node.object, objectCount)) return false;
+    }
+    return true;
+}
+
+}  // namespace
+
+bool IsBinaryScene(const Core::Buffer& buf) {
+    if (buf.GetDataSize() < sizeof(Header)) return false;
+    uint32_t fileMagic;
+    std::memcpy(&fileMagic, buf.GetData(), sizeof(fileMagic));
+    return fileMagic == magic;
+}
+
+Core::Buffer WriteBinaryScene(const Scene& scene, const TexturePathMap& texturePath) {
+    return Writer(texturePath).Write(scene);
+}
+
+Scene BinarySceneParser::Parse(const Core::Buffer& buf, const std::filesystem::path& scenePath) {
+    auto logger = spdlog::get("AssetManager");
+    if (!IsBinaryScene(buf)) {
+        logger->error("[BinaryScene] The buffer is not a binary scene, and return a empty scene.");
+        return Scene{};
+    }
+
+    auto   begin = std::chrono::high_resolution_clock::now();
+    Reader reader(buf);
+    if (!reader.Validate() || reader.m_Header->version != version || reader.m_Header->fileSize > buf.GetDataSize()) {
+        logger->error("[BinaryScene] The file is corrupted or of another version, and return a empty scene.");
+        return Scene{};
+    }
+    const Header& header = *reader.m_Header;
+    Scene         scene;
+
+    std::vector<std::shared_ptr<SceneObjectTexture>> textures;
+    for (auto&& record : reader.Get<TextureRecord>(header.textures)) {
+        auto texture = std::make_shared<SceneObjectTexture>(std::filesystem::path(reader.GetString(record.path)));
+        texture->SetName(std::string(reader.GetString(record.name)));
+        textures.emplace_back(std::move(texture));
+    }
+
+    std::vector<std::shared_ptr<SceneObjectMaterial>> materials;
+    for (auto&& record : reader.Get<MaterialRecord>(header.materials)) {
+        auto material = std::make_shared<SceneObjectMaterial>(std::string(reader.GetString(record.name)));
+        material->SetColor("ambient", record.ambient);
+        material->SetColor("diffuse", record.diffuse);
+        material->SetColor("specular", record.specular);
+        material->SetColor("emission", record.emission);
+        material->SetColor("transparency", record.transparency);
+        material->SetParam("specular_power", record.specularPower);
+        material->SetParam("opacity", record.opacity);
+
+        const std::pair<std::string_view, int32_t> maps[] = {
+            {"diffuse", record.diffuseMap},
+            {"specular", record.specularMap},
+            {"specular_power", record.specularPowerMap},
+            {"emission", record.emissionMap},
+            {"opacity", record.opacityMap},
+            {"transparency", record.transparencyMap},
+            {"normal", record.normalMap},
+        };
+        for (auto&& [attrib, index] : maps)
+            if (index != nullIndex) material->SetTexture(attrib, textures[index]);
+
+        scene.Materials[std::string(reader.GetString(record.key))] = material;
+        materials.emplace_back(std::move(material));
+    }
+
+    std::vector<std::string_view> cameraKeys;
+    for (auto&& record : reader.Get<CameraRecord>(header.cameras)) {
+        cameraKeys.emplace_back(reader.GetString(record.key));
+        scene.Cameras[std::string(cameraKeys.back())] = std::make_shared<SceneObjectCamera>(record.aspect, record.nearClip, record.farClip, record.fov);
+    }
+
+    std::vector<std::string_view> lightKeys;
+    for (auto&& record : reader.Get<LightRecord>(header.lights)) {
+        std::shared_ptr<SceneObjectLight> light;
+        switch (record.type) {
+            case LightType::Point:
+                light = std::make_shared<SceneObjectPointLight>(record.color, record.intensity);
+                break;
+            case LightType::Spot:
+                light = std::make_shared<SceneObjectSpotLight>(record.color, record.intensity, record.direction, record.innerConeAngle, record.outerConeAngle);
+                break;
+            case LightType::Infinite:
+                light = std::make_shared<SceneObjectInfiniteLight>(record.color, record.intensity);
+                break;
+            default:
+                break;
+        }
+        if (light) light->SetIfCastShadow(record.castShadow);
+        lightKeys.emplace_back(reader.GetString(record.key));
+        scene.Lights[std::string(lightKeys.back())] = light;
+    }
+
+    const auto                    meshes       = reader.Get<MeshRecord>(header.meshes);
+    const auto                    vertexArrays = reader.Get<VertexArrayRecord>(header.vertexArrays);
+    std::vector<std::string_view> geometryKeys;
+    // the records of a shared geometry have the same meshes
+    std::unordered_map<uint32_t, std::shared_ptr<SceneObjectGeometry>> sharedGeometries;
+    for (auto&& record : reader.Get<GeometryRecord>(header.geometries)) {
+        geometryKeys.emplace_back(reader.GetString(record.key));
+        if (auto iter = sharedGeometries.find(record.firstMesh); record.meshCount != 0 && iter != sharedGeometries.end()) {
+            scene.Geometries[std::string(geometryKeys.back())] = iter->second;
+            continue;
+        }
+
+        auto geometry = std::make_shared<SceneObjectGeometry>();
+        geometry->SetVisibility(record.visible);
+        geometry->SetIfCastShadow(record.shadow);
+        geometry->SetIfMotionBlur(record.motionBlur);
+        geometry->SetCollisionType(record.collisionType);
+        geometry->SetCollisionParameters(record.collisionParameters.data(), record.collisionParameters.size());
+
+        for (auto&& meshRecord : meshes.subspan(record.firstMesh, record.meshCount)) {
+            auto mesh = std::make_unique<SceneObjectMesh>();
+            mesh->SetPrimitiveType(meshRecord.primitiveType);
+            mesh->SetVertexLayout(meshRecord.vertexLayout);
+            for (auto&& vertexArray : vertexArrays.subspan(meshRecord.firstVertexArray, meshRecord.vertexArrayCount)) {
+                mesh->AddVertexArray(SceneObjectVertexArray(
+                    reader.GetString(vertexArray.attribute),
+                    vertexArray.dataType,
+                    reader.GetBlob(vertexArray.offset, vertexArray.size)));
+            }
+            mesh->AddIndexArray(SceneObjectIndexArray(meshRecord.indexType, reader.GetBlob(meshRecord.indexOffset, meshRecord.indexSize)));
+            if (meshRecord.material != nullIndex) mesh->SetMaterial(materials[meshRecord.material]);
+            geometry->AddMesh(std::move(mesh), meshRecord.lod);
+            if (meshRecord.lod > 0) geometry->SetLODError(meshRecord.lod, meshRecord.lodError);
+        }
+
+        if (record.meshCount != 0) sharedGeometries.emplace(record.firstMesh, geometry);
+        scene.Geometries[std::string(geometryKeys.back())] = std::move(geometry);
+    }
+
+    std::vector<std::shared_ptr<BaseSceneNode>> nodes;
+    for (auto&& record : reader.Get<NodeRecord>(header.nodes)) {
+        const std::string_view         name = reader.GetString(record.name);
+        std::shared_ptr<BaseSceneNode> node;
+        switch (record.type) {
+            case NodeType::Geometry: {
+                auto geometryNode = std::make_shared<SceneGeometryNode>(name);
+                if (record.object != nullIndex) geometryNode->AddSceneObjectRef(scene.Geometries.at(std::string(geometryKeys[record.object])));
+                geometryNode->SetVisibility(record.visible);
+                geometryNode->SetIfCastShadow(record.shadow);
+                geometryNode->SetIfMotionBlur(record.motionBlur);
+                scene.GeometryNodes[std::string(name)] = geometryNode;
+                node                                   = geometryNode;
+            } break;
+            case NodeType::Camera: {
+                auto cameraNode = std::make_shared<SceneCameraNode>(name, record.position, record.up, record.lookAt);
+                if (record.object != nullIndex) cameraNode->AddSceneObjectRef(scene.Cameras.at(std::string(cameraKeys[record.object])));
+                scene.CameraNodes[std::string(name)] = cameraNode;
+                node                                 = cameraNode;
+            } break;
+            case NodeType::Light: {
+                auto lightNode = std::make_shared<SceneLightNode>(name);
+                if (record.object != nullIndex) lightNode->AddSceneObjectRef(scene.Lights.at(std::string(lightKeys[record.object])));
+                scene.LightNodes[std::string(name)] = lightNode;
+                node                                = lightNode;
+            } break;
+            default:
+                node = std::make_shared<SceneEmptyNode>(name);
+                break;
+        }
+        node->AppendTransform(std::make_shared<SceneObjectTransform>(record.transform));
+        if (record.parent != nullIndex) nodes[record.parent]->AppendChild(std::shared_ptr<BaseSceneNode>(node));
+        nodes.emplace_back(std::move(node));
+    }
+    if (!nodes.empty()) scene.SceneGraph = nodes.front();
+
+    auto end = std::chrono::high_resolution_clock::now();
+    logger->info("[BinaryScene] Loading costs {} ms.", std::chrono::duration_cast<std::chrono::milliseconds>(end - begin).count());
+    return scene;
+}
+
+}  // namespace Hitagi::Asset
@@ -0,0 +1,23 @@
+#pragma once
+#include "SceneParser.hpp"
+
+#include <functional>
+
+namespace Hitagi::Asset {
+
+// Engine-native cooked scene. The file is a header and flat tables of fixed size records
+// (string table, textures, materials, cameras, lights, geometries, meshes, vertex arrays,
+// nodes) followed by a blob of the vertex and index data. All the references are offsets
+// or table indices, so the file can be used in place from a read or memory mapped buffer.
+class BinarySceneParser : public SceneParser {
+public:
+    Scene Parse(const Core::Buffer& buf, const std::filesystem::path& scenePath) final;
+};
+
+using TexturePathMap = std::function<std::filesystem::path(const std::filesystem::path&)>;
+
+bool IsBinaryScene(const Core::Buffer& buf);
+// The texture paths are stored as mapped by texturePath if it is set, e.g. to the cooked textures
+Core::Buffer WriteBinaryScene(const Scene& scene, const TexturePathMap& texturePath = {});
+
+}  // namespace Hitagi::Asset
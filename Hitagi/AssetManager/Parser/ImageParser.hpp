@@ -3,13 +3,42 @@
 #include "../Image.hpp"
 #include "Buffer.hpp"
 
+#include <algorithm>
+#include <array>
+#include <string_view>
+
 namespace Hitagi::Asset {
 enum class ImageFormat : unsigned { PNG,
                                     JPEG,
                                     TGA,
                                     BMP,
+                                    HTEX,  // cooked by AssetCooker
                                     NUM_SUPPORT };
 
+// Detect the format by the magic bytes, return NUM_SUPPORT if unknown.
+// TGA has no magic bytes, only TGA 2.0 files are detected by their footer.
+inline ImageFormat DetectImageFormat(const Core::Buffer& buf) {
+    const uint8_t* data = buf.GetData();
+    const size_t   size = buf.GetDataSize();
+
+    constexpr std::array<uint8_t, 8> pngMagic  = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+    constexpr std::array<uint8_t, 3> jpegMagic = {0xff, 0xd8, 0xff};
+    constexpr std::string_view       tgaFooter = "TRUEVISION-XFILE.";
+
+    if (size >= pngMagic.size() && std::equal(pngMagic.begin(), pngMagic.end(), data))
+        return ImageFormat::PNG;
+    if (size >= jpegMagic.size() && std::equal(jpegMagic.begin(), jpegMagic.end(), data))
+        return ImageFormat::JPEG;
+    if (size >= 2 && data[0] == 'B' && data[1] == 'M')
+        return ImageFormat::BMP;
+    if (size >= 4 && std::equal(data, data + 4, "HTEX"))
+        return ImageFormat::HTEX;
+    // the footer ends with the signature and a '\0'
+    if (size >= 26 && std::equal(tgaFooter.begin(), tgaFooter.end(), data + size - tgaFooter.size() - 1))
+        return ImageFormat::TGA;
+    return ImageFormat::NUM_SUPPORT;
+}
+
 class ImageParser {
 public:
     virtual Image Parse(const Core::Buffer& buf) = 0;
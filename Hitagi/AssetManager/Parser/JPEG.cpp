@@ -3,8 +3,29 @@
 #include <jpeglib.h>
 #include <spdlog/spdlog.h>
 
+#include <csetjmp>
+#include <stdexcept>
+#include <vector>
+
 namespace Hitagi::Asset {
 
+struct JpegErrorManager {
+    jpeg_error_mgr pub;
+    std::jmp_buf   jmpBuffer;
+};
+
+void jpegErrorExit(j_common_ptr cinfo) {
+    char message[JMSG_LENGTH_MAX];
+    (*cinfo->err->format_message)(cinfo, message);
+    spdlog::get("AssetManager")->error("[JPEG] {}", message);
+    std::longjmp(reinterpret_cast<JpegErrorManager*>(cinfo->err)->jmpBuffer, 1);
+}
+
+JpegParser::JpegParser(unsigned scale) : m_Scale(scale) {
+    if (scale != 1 && scale != 2 && scale != 4 && scale != 8)
+        throw std::invalid_argument(fmt::format("JPEG scale must be 1, 2, 4 or 8, but got {}", scale));
+}
+
 Image JpegParser::Parse(const Core::Buffer& buf) {
     auto logger = spdlog::get("AssetManager");
     if (buf.Empty()) {
@@ -13,39 +34,46 @@ Image JpegParser::Parse(const Core::Buffer& buf) {
     }
 
     jpeg_decompress_struct cinfo;
-    jpeg_error_mgr         jerr;
-    cinfo.err = jpeg_std_error(&jerr);
+    JpegErrorManager       jerr;
+    cinfo.err           = jpeg_std_error(&jerr.pub);
+    jerr.pub.error_exit = jpegErrorExit;
+    if (setjmp(jerr.jmpBuffer)) {
+        jpeg_destroy_decompress(&cinfo);
+        return Image{};
+    }
     jpeg_create_decompress(&cinfo);
     jpeg_mem_src(&cinfo, buf.GetData(), buf.GetDataSize());
     jpeg_read_header(&cinfo, true);
     cinfo.out_color_space = JCS_EXT_RGBA;
+    cinfo.scale_num       = 1;
+    cinfo.scale_denom     = m_Scale;
+    jpeg_calc_output_dimensions(&cinfo);
 
-    auto  width    = static_cast<uint32_t>(cinfo.image_width);
-    auto  height   = static_cast<uint32_t>(cinfo.image_height);
+    auto  width    = static_cast<uint32_t>(cinfo.output_width);
+    auto  height   = static_cast<uint32_t>(cinfo.output_height);
     auto  bitcount = 32;
     auto  pitch    = ((width * bitcount >> 3) + 3) & ~3;
     auto  dataSize = pitch * height;
     Image img(width, height, bitcount, pitch, dataSize);
-    jpeg_start_decompress(&cinfo);
 
-    int buffer_height = 1;
-    int row_stride    = cinfo.output_width * cinfo.output_components;
+    // libjpeg writes the scanlines from top to bottom through the row pointers, the image is bottom up
+    std::vector<JSAMPROW> rows(height);
+    for (uint32_t i = 0; i < height; i++)
+        rows[i] = img.GetData() + pitch * (height - 1 - i);
 
-    auto buffer = new JSAMPROW[buffer_height];
-    buffer[0]   = new JSAMPLE[row_stride];
-    auto p      = reinterpret_cast<uint8_t*>(img.GetData()) + (height - 1) * row_stride;
-    while (cinfo.output_scanline < cinfo.output_height) {
-        jpeg_read_scanlines(&cinfo, buffer, 1);
-        std::memcpy(p, buffer[0], row_stride);
-        p -= row_stride;
+    // the objects above are created before this point, so no destructor is skipped by longjmp
+    if (setjmp(jerr.jmpBuffer)) {
+        jpeg_destroy_decompress(&cinfo);
+        return Image{};
     }
+    jpeg_start_decompress(&cinfo);
+    // it decodes as many rows as the decoder buffers in a call, usually the height of an MCU row
+    while (cinfo.output_scanline < cinfo.output_height)
+        jpeg_read_scanlines(&cinfo, rows.data() + cinfo.output_scanline, cinfo.output_height - cinfo.output_scanline);
 
     jpeg_finish_decompress(&cinfo);
     jpeg_destroy_decompress(&cinfo);
 
-    delete[] buffer[0];
-    delete[] buffer;
-
     return img;
 }
-}  // namespace Hitagi::Asset
\ No newline at end of file
+}  // namespace Hitagi::Asset
@@ -4,7 +4,13 @@
 namespace Hitagi::Asset {
 class JpegParser : public ImageParser {
 public:
+    // Decode at 1/scale of the full size with the DCT scaling of libjpeg, scale is 1, 2, 4 or 8.
+    // It is much cheaper than decoding the full image and downsampling it.
+    JpegParser(unsigned scale = 1);
     Image Parse(const Core::Buffer& buf) final;
+
+private:
+    unsigned m_Scale;
 };
 
 }  // namespace Hitagi::Asset
@@ -1,12 +1,11 @@
 #include "PNG.hpp"
 
 #include <iostream>
+#include <bit>
 
 #include <spdlog/spdlog.h>
 #include <png.h>
 
-#include "HitagiMath.hpp"
-
 namespace Hitagi::Asset {
 
 struct ImageSource {
@@ -54,7 +53,7 @@ Image PngParser::Parse(const Core::Buffer& buf) {
     }
 
     if (setjmp(png_jmpbuf(png_tr))) {
-        logger->error("[PNG] Error occur during read_image.");
+        logger->error("[PNG] Error occur during read_info.");
         png_destroy_read_struct(&png_tr, &info_ptr, nullptr);
         return Image();
     }
@@ -65,72 +64,54 @@ Image PngParser::Parse(const Core::Buffer& buf) {
     imgSource.offset = 0;
 
     png_set_read_fn(png_tr, &imgSource, pngReadCallback);
-    png_read_png(
-        png_tr, info_ptr,
-        PNG_TRANSFORM_STRIP_16 | PNG_TRANSFORM_EXPAND | PNG_TRANSFORM_PACKING,
-        nullptr);
-
-    auto  width    = png_get_image_width(png_tr, info_ptr);
-    auto  height   = png_get_image_height(png_tr, info_ptr);
-    auto  bitcount = 32;
+    png_read_info(png_tr, info_ptr);
+
+    const auto width     = png_get_image_width(png_tr, info_ptr);
+    const auto height    = png_get_image_height(png_tr, info_ptr);
+    const auto colorType = png_get_color_type(png_tr, info_ptr);
+    const bool keep16Bit = m_Keep16Bit && png_get_bit_depth(png_tr, info_ptr) == 16;
+
+    // let libpng expand every color type to RGBA, 8 bits or 16 bits per channel
+    png_set_expand(png_tr);
+    if (keep16Bit) {
+        // png is big-endian
+        if constexpr (std::endian::native == std::endian::little) png_set_swap(png_tr);
+    } else {
+        png_set_strip_16(png_tr);
+    }
+    png_set_packing(png_tr);
+    if (colorType == PNG_COLOR_TYPE_GRAY || colorType == PNG_COLOR_TYPE_GRAY_ALPHA)
+        png_set_gray_to_rgb(png_tr);
+    // the filler is added only when there is no alpha channel, including the one expanded from tRNS
+    png_set_add_alpha(png_tr, keep16Bit ? 0xffff : 0xff, PNG_FILLER_AFTER);
+    const int passes = png_set_interlace_handling(png_tr);
+    png_read_update_info(png_tr, info_ptr);
+
+    auto  bitcount = keep16Bit ? 64 : 32;
     auto  pitch    = ((width * bitcount >> 3) + 3) & ~3;
     auto  dataSize = pitch * height;
     Image img(width, height, bitcount, pitch, dataSize);
 
-    png_bytepp rows = png_get_rows(png_tr, info_ptr);
-    auto       p    = reinterpret_cast<R8G8B8A8Unorm*>(img.GetData());
-
-    switch (png_get_color_type(png_tr, info_ptr)) {
-        case PNG_COLOR_TYPE_GRAY: {
-            for (int i = height - 1; i >= 0; i--) {
-                for (int j = 0; j < width; j++) {
-                    p[j].r = rows[i][j];
-                    p[j].g = rows[i][j];
-                    p[j].b = rows[i][j];
-                    p[j].a = 255;
-                }
-                // to next line
-                p += width;
-            }
-        } break;
-        case PNG_COLOR_TYPE_GRAY_ALPHA: {
-            for (int i = height - 1; i >= 0; i--) {
-                for (int j = 0; j < width; j++) {
-                    p[j].r = rows[i][2 * j + 0];
-                    p[j].g = rows[i][2 * j + 0];
-                    p[j].b = rows[i][2 * j + 0];
-                    p[j].a = rows[i][2 * j + 1];
-                }
-                // to next line
-                p += width;
-            }
-        } break;
-        case PNG_COLOR_TYPE_RGB: {
-            for (int i = height - 1; i >= 0; i--) {
-                for (int j = 0; j < width; j++) {
-                    p[j].r = rows[i][3 * j + 0];
-                    p[j].g = rows[i][3 * j + 1];
-                    p[j].b = rows[i][3 * j + 2];
-                    p[j].a = 255;
-                }
-                // to next line
-                p += width;
-            }
-        } break;
-        case PNG_COLOR_TYPE_RGBA: {
-            for (int i = height - 1; i >= 0; i--) {
-                auto _p = reinterpret_cast<R8G8B8A8Unorm*>(rows[i]);
-                std::copy(_p, _p + width, p);
-                // to next line
-                p += width;
-            }
-        } break;
-        default:
-            logger->error("[PNG] Unsupport color type.");
-            return img;
-            break;
+    if (png_get_rowbytes(png_tr, info_ptr) != width * bitcount >> 3) {
+        logger->error("[PNG] Unsupport color type.");
+        png_destroy_read_struct(&png_tr, &info_ptr, nullptr);
+        return Image();
+    }
+
+    // the image is created before this point, so no destructor is skipped by longjmp
+    if (setjmp(png_jmpbuf(png_tr))) {
+        logger->error("[PNG] Error occur during read_row.");
+        png_destroy_read_struct(&png_tr, &info_ptr, nullptr);
+        return Image();
     }
 
+    // decode to the destination rows directly, png rows are stored from top to bottom.
+    // Every pass of an interlaced image updates the rows decoded by the previous passes.
+    for (int pass = 0; pass < passes; pass++)
+        for (uint32_t i = 0; i < height; i++)
+            png_read_row(png_tr, img.GetData() + pitch * (height - 1 - i), nullptr);
+
+    png_read_end(png_tr, nullptr);
     png_destroy_read_struct(&png_tr, &info_ptr, nullptr);
     return img;
 }
@@ -4,6 +4,11 @@
 namespace Hitagi::Asset {
 class PngParser : public ImageParser {
 public:
+    // keep16Bit decodes 16 bits png to R16G16B16A16 instead of stripping them to 8 bits
+    PngParser(bool keep16Bit = false) : m_Keep16Bit(keep16Bit) {}
     Image Parse(const Core::Buffer& buf) final;
+
+private:
+    bool m_Keep16Bit;
 };
 }  // namespace Hitagi::Asset
@@ -0,0 +1,134 @@
+#pragma once
+#include "HitagiMath.hpp"
+
+#include <span>
+
+// Row conversions of the pixel formats found in image files to R8G8B8A8.
+// The input is a row of packed pixels, the output must have 4 bytes per input pixel.
+namespace Hitagi::Asset {
+
+namespace details {
+inline uint8_t Expand5(uint32_t v) { return static_cast<uint8_t>((v << 3) | (v >> 2)); }
+inline uint8_t Expand6(uint32_t v) { return static_cast<uint8_t>((v << 2) | (v >> 4)); }
+}  // namespace details
+
+inline void GrayToRGBA8(std::span<const uint8_t> in, std::span<uint8_t> out) {
+    assert(out.size() >= 4 * in.size());
+#if defined(USE_ISPC)
+    if (ispc::IsSupported()) {
+        ispc::gray8_to_rgba8(in.data(), reinterpret_cast<uint32_t*>(out.data()), in.size());
+        return;
+    }
+#endif  // USE_ISPC
+    for (size_t i = 0; i < in.size(); i++) {
+        out[4 * i] = out[4 * i + 1] = out[4 * i + 2] = in[i];
+        out[4 * i + 3]                               = 255;
+    }
+}
+
+inline void GrayAlphaToRGBA8(std::span<const uint8_t> in, std::span<uint8_t> out) {
+    const size_t count = in.size() / 2;
+    assert(out.size() >= 4 * count);
+#if defined(USE_ISPC)
+    if (ispc::IsSupported()) {
+        ispc::gray_alpha8_to_rgba8(in.data(), reinterpret_cast<uint32_t*>(out.data()), count);
+        return;
+    }
+#endif  // USE_ISPC
+    for (size_t i = 0; i < count; i++) {
+        out[4 * i] = out[4 * i + 1] = out[4 * i + 2] = in[2 * i];
+        out[4 * i + 3]                               = in[2 * i + 1];
+    }
+}
+
+inline void RGBToRGBA8(std::span<const uint8_t> in, std::span<uint8_t> out) {
+    const size_t count = in.size() / 3;
+    assert(out.size() >= 4 * count);
+#if defined(USE_ISPC)
+    if (ispc::IsSupported()) {
+        ispc::rgb8_to_rgba8(in.data(), reinterpret_cast<uint32_t*>(out.data()), count);
+        return;
+    }
+#endif  // USE_ISPC
+    for (size_t i = 0; i < count; i++) {
+        out[4 * i]     = in[3 * i];
+        out[4 * i + 1] = in[3 * i + 1];
+        out[4 * i + 2] = in[3 * i + 2];
+        out[4 * i + 3] = 255;
+    }
+}
+
+inline void BGRToRGBA8(std::span<const uint8_t> in, std::span<uint8_t> out) {
+    const size_t count = in.size() / 3;
+    assert(out.size() >= 4 * count);
+#if defined(USE_ISPC)
+    if (ispc::IsSupported()) {
+        ispc::bgr8_to_rgba8(in.data(), reinterpret_cast<uint32_t*>(out.data()), count);
+        return;
+    }
+#endif  // USE_ISPC
+    for (size_t i = 0; i < count; i++) {
+        out[4 * i]     = in[3 * i + 2];
+        out[4 * i + 1] = in[3 * i + 1];
+        out[4 * i + 2] = in[3 * i];
+        out[4 * i + 3] = 255;
+    }
+}
+
+// opaque ignores the fourth byte, e.g. the unused byte of 32 bits BMP
+inline void BGRAToRGBA8(std::span<const uint8_t> in, std::span<uint8_t> out, bool opaque = false) {
+    const size_t count = in.size() / 4;
+    assert(out.size() >= 4 * count);
+#if defined(USE_ISPC)
+    if (ispc::IsSupported()) {
+        ispc::bgra8_to_rgba8(in.data(), reinterpret_cast<uint32_t*>(out.data()), count, opaque);
+        return;
+    }
+#endif  // USE_ISPC
+    for (size_t i = 0; i < count; i++) {
+        out[4 * i]     = in[4 * i + 2];
+        out[4 * i + 1] = in[4 * i + 1];
+        out[4 * i + 2] = in[4 * i];
+        out[4 * i + 3] = opaque ? 255 : in[4 * i + 3];
+    }
+}
+
+// 16 bits little-endian X1R5G5B5, the top bit is alpha if alphaBit is set
+inline void RGB555ToRGBA8(std::span<const uint8_t> in, std::span<uint8_t> out, bool alphaBit = false) {
+    const size_t count = in.size() / 2;
+    assert(out.size() >= 4 * count);
+#if defined(USE_ISPC)
+    if (ispc::IsSupported()) {
+        ispc::rgb555_to_rgba8(in.data(), reinterpret_cast<uint32_t*>(out.data()), count, alphaBit);
+        return;
+    }
+#endif  // USE_ISPC
+    for (size_t i = 0; i < count; i++) {
+        const uint32_t color = in[2 * i] | (in[2 * i + 1] << 8);
+        out[4 * i]           = details::Expand5((color >> 10) & 0x1f);
+        out[4 * i + 1]       = details::Expand5((color >> 5) & 0x1f);
+        out[4 * i + 2]       = details::Expand5(color & 0x1f);
+        out[4 * i + 3]       = (alphaBit && (color & 0x8000) == 0) ? 0 : 255;
+    }
+}
+
+// 16 bits little-endian R5G6B5
+inline void RGB565ToRGBA8(std::span<const uint8_t> in, std::span<uint8_t> out) {
+    const size_t count = in.size() / 2;
+    assert(out.size() >= 4 * count);
+#if defined(USE_ISPC)
+    if (ispc::IsSupported()) {
+        ispc::rgb565_to_rgba8(in.data(), reinterpret_cast<uint32_t*>(out.data()), count);
+        return;
+    }
+#endif  // USE_ISPC
+    for (size_t i = 0; i < count; i++) {
+        const uint32_t color = in[2 * i] | (in[2 * i + 1] << 8);
+        out[4 * i]           = details::Expand5(color >> 11);
+        out[4 * i + 1]       = details::Expand6((color >> 5) & 0x3f);
+        out[4 * i + 2]       = details::Expand5(color & 0x1f);
+        out[4 * i + 3]       = 255;
+    }
+}
+
+}  // namespace Hitagi::Asset
@@ -2,7 +2,7 @@
 
 #include <spdlog/spdlog.h>
 
-#include "HitagiMath.hpp"
+#include "PixelConversion.hpp"
 
 namespace Hitagi::Asset {
 
@@ -48,73 +48,57 @@ Image TgaParser::Parse(const Core::Buffer& buf) {
     auto    width      = (fileHeader->ImageSpec[5] << 8) + fileHeader->ImageSpec[4];
     auto    height     = (fileHeader->ImageSpec[7] << 8) + fileHeader->ImageSpec[6];
     uint8_t pixelDepth = fileHeader->ImageSpec[8];
-    // rendering the pixel data
-    auto bitcount = 32;
-    // for GPU address alignment
-    auto  pitch    = (width * (bitcount >> 3) + 3) & ~3u;
-    auto  dataSize = pitch * height;
-    Image img(width, height, bitcount, pitch, dataSize);
+    uint8_t descriptor = fileHeader->ImageSpec[9];
 
-    uint8_t alpha_depth = fileHeader->ImageSpec[9] & 0x0F;
+    uint8_t alpha_depth = descriptor & 0x0F;
+    bool    topToBottom = descriptor & 0x20;
     logger->debug("[TGA] Image width:       {}", width);
     logger->debug("[TGA] Image height:      {}", height);
     logger->debug("[TGA] Image Pixel Depth: {}", pixelDepth);
     logger->debug("[TGA] Image Alpha Depth: {}", alpha_depth);
+
+    if (pixelDepth != 15 && pixelDepth != 16 && pixelDepth != 24 && pixelDepth != 32) {
+        logger->warn("[TGA] Unsupported Pixel Depth: {}.", pixelDepth);
+        return Image();
+    }
     // skip Image ID
     data += fileHeader->IDLength;
     // skip the Color Map. since we assume the Color Map Type is 0,
     // nothing to skip
 
-    auto* out = reinterpret_cast<uint8_t*>(img.GetData());
-    // clang-format off
-        for (auto i = 0; i < height; i++) {
-            for (auto j = 0; j < width; j++) {
-                switch (pixelDepth) {
-                    case 15:
-                    {
-                        uint16_t color = *reinterpret_cast<const uint16_t*>(data);
-                        data += 2;
-                        *(out + pitch * i + j * 4)     = ((color & 0x7C00) >> 10); // R
-                        *(out + pitch * i + j * 4 + 1) = ((color & 0x03E0) >> 5);  // G
-                        *(out + pitch * i + j * 4 + 2) = ((color & 0x001F) >> 10); // B
-                        *(out + pitch * i + j * 4 + 3) = 0xFF;                     // A
-                    } break;
-                    case 16:
-                    {
-                        uint16_t color = *reinterpret_cast<const uint16_t*>(data);
-                        data += 2;
-                        *(out + pitch * i + j * 4)     = ((color & 0x7C00) >> 10);     // R
-                        *(out + pitch * i + j * 4 + 1) = ((color & 0x03E0) >> 5);      // G
-                        *(out + pitch * i + j * 4 + 2) = ((color & 0x001F) >> 10);     // B
-                        *(out + pitch * i + j * 4 + 3) = ((color & 0x8000)?0xFF:0x00); // A
-                    } break;
-                    case 24:
-                    {
-                        *(out + pitch * i + j * 4)     = *data; // R
-                        data++;
-                        *(out + pitch * i + j * 4 + 1) = *data; // G
-                        data++;
-                        *(out + pitch * i + j * 4 + 2) = *data; // B
-                        data++;
-                        *(out + pitch * i + j * 4 + 3) = 0xFF;   // A
-                    } break;
-                    case 32:
-                    {
-                        *(out + pitch * i + j * 4)     = *data; // R
-                        data++;
-                        *(out + pitch * i + j * 4 + 1) = *data; // G
-                        data++;
-                        *(out + pitch * i + j * 4 + 2) = *data; // B
-                        data++;
-                        *(out + pitch * i + j * 4 + 3) = *data; // A
-                        data++;
-                    } break;
-                    default:
-                    break;
-                }
-            }
+    // 15 bits pixels are stored in 2 bytes
+    const size_t srcPitch = static_cast<size_t>(width) * ((pixelDepth + 7) >> 3);
+    if (data + srcPitch * height > pDataEnd) {
+        logger->warn("[TGA] The pixel data is truncated.");
+        return Image();
+    }
+
+    // rendering the pixel data
+    auto bitcount = 32;
+    // for GPU address alignment
+    auto  pitch    = (width * (bitcount >> 3) + 3) & ~3u;
+    auto  dataSize = pitch * height;
+    Image img(width, height, bitcount, pitch, dataSize);
+
+    // the rows of the image are stored from bottom to top, the same as tga default origin
+    for (decltype(height) i = 0; i < height; i++, data += srcPitch) {
+        std::span<const uint8_t> src(data, srcPitch);
+        std::span<uint8_t>       dst(img.GetData() + pitch * (topToBottom ? height - 1 - i : i), pitch);
+        switch (pixelDepth) {
+            case 15:
+                RGB555ToRGBA8(src, dst);
+                break;
+            case 16:
+                RGB555ToRGBA8(src, dst, alpha_depth != 0);
+                break;
+            case 24:
+                BGRToRGBA8(src, dst);
+                break;
+            case 32:
+                BGRAToRGBA8(src, dst);
+                break;
         }
-        assert(data <= pDataEnd);
-        return img;
+    }
+    return img;
 }
-}  // namespace Hitagi::Resource
\ No newline at end of file
+}  // namespace Hitagi::Asset
@@ -1,6 +1,30 @@
 #include "Scene.hpp"
+#include "ThreadManager.hpp"
+
+#include <unordered_set>
 
 namespace Hitagi::Asset {
+namespace {
+// Add an object to the pool at the first time it is seen
+template <typename T>
+class ObjectRegistry {
+public:
+    explicit ObjectRegistry(Core::HandlePool<T>& pool) : m_Pool(pool) { m_Pool.Clear(); }
+
+    Core::Handle<T> operator()(const std::shared_ptr<T>& object) {
+        if (!object) return {};
+        auto [iter, inserted] = m_Handles.try_emplace(object.get());
+        if (inserted) iter->second = m_Pool.Add(object);
+        return iter->second;
+    }
+
+    const std::unordered_map<T*, Core::Handle<T>>& GetHandles() const { return m_Handles; }
+
+private:
+    Core::HandlePool<T>&                    m_Pool;
+    std::unordered_map<T*, Core::Handle<T>> m_Handles;
+};
+}  // namespace
 
 std::vector<std::reference_wrapper<SceneGeometryNode>> Scene::GetGeometries() const {
     std::vector<std::reference_wrapper<SceneGeometryNode>> ret;
@@ -52,8 +76,60 @@ std::shared_ptr<SceneLightNode> Scene::GetFirstLightNode() const {
 }
 
 void Scene::LoadResource() {
-    for (auto& material : Materials) {
-        material.second->LoadTextures();
+    // The textures of LoadTextures are loaded on the thread pool together, the textures
+    // of the same path share an image decoded once by AssetManager.
+    std::vector<std::future<void>>          tasks;
+    std::unordered_set<SceneObjectTexture*> visited;
+    for (auto&& [key, material] : Materials) {
+        auto& texture = material->GetDiffuseColor().ValueMap;
+        if (!texture || texture->Loaded() || !visited.emplace(texture.get()).second) continue;
+        if (g_ThreadManager->IsRunning())
+            tasks.emplace_back(g_ThreadManager->RunTask([texture] { texture->LoadTexture(); }));
+        else
+            texture->LoadTexture();
     }
+    for (auto&& task : tasks) task.get();
+}
+
+void Scene::BuildTransformHierarchy() {
+    if (SceneGraph) m_TransformHierarchy.Build(*SceneGraph);
+}
+
+void Scene::UpdateTransforms() {
+    m_TransformHierarchy.Update();
+    m_BoundingVolumeHierarchy.Refit(m_TransformHierarchy);
+}
+
+void Scene::BuildBoundingVolumeHierarchy() {
+    std::vector<BoundingVolumeHierarchy::Item> items;
+    for (size_t i = 0; i < m_TransformHierarchy.Size(); i++) {
+        auto node = dynamic_cast<SceneGeometryNode*>(m_TransformHierarchy.GetNode(i));
+        if (!node) continue;
+        if (auto geometry = GetGeometry(node->GetSceneObjectHandle()))
+            items.emplace_back(BoundingVolumeHierarchy::Item{node, i, geometry->GetBoundingBox()});
+    }
+    m_BoundingVolumeHierarchy.Build(m_TransformHierarchy, std::move(items));
+}
+
+void Scene::RegisterObjects() {
+    ObjectRegistry cameras(m_CameraPool);
+    ObjectRegistry lights(m_LightPool);
+    ObjectRegistry materials(m_MaterialPool);
+    ObjectRegistry geometries(m_GeometryPool);
+
+    // The objects referenced by the nodes or meshes only are registered too
+    for (auto&& [key, camera] : Cameras) cameras(camera);
+    for (auto&& [key, light] : Lights) lights(light);
+    for (auto&& [key, material] : Materials) materials(material);
+    for (auto&& [key, geometry] : Geometries) geometries(geometry);
+
+    for (auto&& [key, node] : CameraNodes) node->SetSceneObjectHandle(cameras(node->GetSceneObjectRef().lock()));
+    for (auto&& [key, node] : LightNodes) node->SetSceneObjectHandle(lights(node->GetSceneObjectRef().lock()));
+    for (auto&& [key, node] : GeometryNodes) node->SetSceneObjectHandle(geometries(node->GetSceneObjectRef().lock()));
+
+    for (auto&& [geometry, handle] : geometries.GetHandles())
+        for (size_t lod = 0; lod < geometry->GetLODCount(); lod++)
+            for (auto&& mesh : geometry->GetMeshes(lod))
+                mesh->SetMaterialHandle(materials(mesh->GetMaterial().lock()));
 }
 }  // namespace Hitagi::Asset
\ No newline at end of file
@@ -1,12 +1,20 @@
 #pragma once
 
 #include "SceneNode.hpp"
+#include "BoundingVolumeHierarchy.hpp"
 
 namespace Hitagi::Asset {
 
 class Scene {
 private:
     std::shared_ptr<SceneObjectMaterial> m_DefaultMaterial;
+    TransformHierarchy                   m_TransformHierarchy;
+    BoundingVolumeHierarchy              m_BoundingVolumeHierarchy;
+
+    Core::HandlePool<SceneObjectCamera>   m_CameraPool;
+    Core::HandlePool<SceneObjectLight>    m_LightPool;
+    Core::HandlePool<SceneObjectMaterial> m_MaterialPool;
+    Core::HandlePool<SceneObjectGeometry> m_GeometryPool;
 
 public:
     std::shared_ptr<BaseSceneNode>                                      SceneGraph;
@@ -34,9 +42,30 @@ public:
     std::shared_ptr<SceneObjectGeometry> GetGeometry(const std::string& key) const;
     std::shared_ptr<SceneObjectMaterial> GetMaterial(const std::string& key) const;
 
+    // Resolve the handles set by RegisterObjects, return nullptr if the handle is invalid
+    SceneObjectCamera*   GetCamera(Core::Handle<SceneObjectCamera> handle) const { return m_CameraPool.Get(handle); }
+    SceneObjectLight*    GetLight(Core::Handle<SceneObjectLight> handle) const { return m_LightPool.Get(handle); }
+    SceneObjectGeometry* GetGeometry(Core::Handle<SceneObjectGeometry> handle) const { return m_GeometryPool.Get(handle); }
+    SceneObjectMaterial* GetMaterial(Core::Handle<SceneObjectMaterial> handle) const { return m_MaterialPool.Get(handle); }
+
     std::shared_ptr<SceneCameraNode> GetFirstCameraNode() const;
     std::shared_ptr<SceneLightNode>  GetFirstLightNode() const;
 
     void LoadResource();
+
+    // Put the objects into the handle pools, and set the handles of the nodes and the materials of the meshes.
+    // It must be called again after objects are added, and the previous handles are invalid then.
+    void RegisterObjects();
+
+    // Flatten the scene graph, it must be called again after the graph changes
+    void BuildTransformHierarchy();
+    // Calculate the world transforms of all the nodes, and refit the bounds of the moved geometry nodes
+    void UpdateTransforms();
+    // Build the spatial index of the geometry nodes, after the objects are registered and the transforms updated.
+    // It must be called again after the graph changes.
+    void BuildBoundingVolumeHierarchy();
+
+    const TransformHierarchy&      GetTransformHierarchy() const { return m_TransformHierarchy; }
+    const BoundingVolumeHierarchy& GetBoundingVolumeHierarchy() const { return m_BoundingVolumeHierarchy; }
 };
 }  // namespace Hitagi::Asset
\ No newline at end of file
@@ -0,0 +1,50 @@
+#include "SceneEntities.hpp"
+
+namespace Hitagi::Asset {
+
+ECS::Entity ImportScene(Scene& scene, ECS::World& world) {
+    if (!scene.SceneGraph) return {};
+
+    if (scene.GetTransformHierarchy().Empty() || scene.GetTransformHierarchy().GetNode(0) != scene.SceneGraph.get()) {
+        scene.BuildTransformHierarchy();
+        scene.UpdateTransforms();
+    }
+    const TransformHierarchy* hierarchy = &scene.GetTransformHierarchy();
+
+    std::vector<ECS::Entity> entities;
+    entities.reserve(hierarchy->Size());
+    for (size_t i = 0; i < hierarchy->Size(); i++) {
+        auto       node   = hierarchy->GetNode(i);
+        const auto entity = entities.emplace_back(world.CreateEntity());
+        const auto parent = hierarchy->GetParent(i);
+
+        world.Emplace<NameComponent>(entity, node->GetName());
+        world.Emplace<SceneNodeComponent>(entity, node);
+        world.Emplace<TransformComponent>(entity, node->GetCalculatedTransform(), node->GetWorldTransform(), node->GetTransformVersion());
+        if (parent != TransformHierarchy::nullIndex)
+            world.Emplace<HierarchyComponent>(entity, entities[parent]);
+
+        if (auto geometryNode = dynamic_cast<SceneGeometryNode*>(node)) {
+            if (auto geometry = geometryNode->GetSceneObjectRef().lock())
+                world.Emplace<GeometryComponent>(entity, geometry, geometry->GetBoundingBox());
+        } else if (auto cameraNode = dynamic_cast<SceneCameraNode*>(node)) {
+            if (auto camera = cameraNode->GetSceneObjectRef().lock())
+                world.Emplace<CameraComponent>(entity, camera);
+        } else if (auto lightNode = dynamic_cast<SceneLightNode*>(node)) {
+            if (auto light = lightNode->GetSceneObjectRef().lock())
+                world.Emplace<LightComponent>(entity, light);
+        }
+    }
+    return entities.front();
+}
+
+void SyncTransforms(ECS::World& world) {
+    world.ParallelEach<SceneNodeComponent, TransformComponent>([](ECS::Entity, SceneNodeComponent& node, TransformComponent& transform) {
+        if (transform.version == node.node->GetTransformVersion()) return;
+        transform.local   = node.node->GetCalculatedTransform();
+        transform.world   = node.node->GetWorldTransform();
+        transform.version = node.node->GetTransformVersion();
+    });
+}
+
+}  // namespace Hitagi::Asset
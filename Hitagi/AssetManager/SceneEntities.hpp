@@ -0,0 +1,52 @@
+#pragma once
+#include "Scene.hpp"
+#include "World.hpp"
+
+namespace Hitagi::Asset {
+
+// The components of the scene nodes imported into an ECS::World
+struct NameComponent {
+    std::string name;
+};
+
+struct HierarchyComponent {
+    ECS::Entity parent;
+};
+
+struct TransformComponent {
+    mat4f    local;
+    mat4f    world;
+    // The transform version of the node when world was copied
+    uint64_t version;
+};
+
+// The node the entity is imported from, the transforms are still updated on the scene graph.
+// The node is owned by the scene, so the world must not outlive the scene it is imported from.
+struct SceneNodeComponent {
+    BaseSceneNode* node;
+};
+
+struct GeometryComponent {
+    std::shared_ptr<SceneObjectGeometry> geometry;
+    // The bounding box of LOD 0 in the space of the node
+    Box                                  localBound;
+};
+
+struct CameraComponent {
+    std::shared_ptr<SceneObjectCamera> camera;
+};
+
+struct LightComponent {
+    std::shared_ptr<SceneObjectLight> light;
+};
+
+// Create an entity for every node of the scene graph in depth-first order, so the parent of an entity is
+// created before it. The transform hierarchy of the scene is built and updated first if it is not built.
+// Return the entity of the root, or a null entity if the scene has no graph.
+// The entities refer to the nodes of the scene, so the world must not outlive the scene.
+ECS::Entity ImportScene(Scene& scene, ECS::World& world);
+
+// Copy the world transforms of the nodes moved since the last call into their TransformComponents on the thread pool
+void SyncTransforms(ECS::World& world);
+
+}  // namespace Hitagi::Asset
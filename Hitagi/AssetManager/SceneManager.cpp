@@ -24,7 +24,9 @@ void SceneManager::Finalize() {
     m_Logger = nullptr;
 }
 
-void SceneManager::Tick() {}
+void SceneManager::Tick() {
+    if (!m_Scene.empty()) m_Scene[m_CurrentSceneIndex].UpdateTransforms();
+}
 
 void SceneManager::SetScene(std::filesystem::path name) {
     m_Scene.emplace_back(g_AssetManager->ParseScene(name));
@@ -52,6 +54,10 @@ void SceneManager::SetScene(std::filesystem::path name) {
 
         scene.SceneGraph->AppendChild(scene.LightNodes["default"]);
     }
+    scene.RegisterObjects();
+    scene.BuildTransformHierarchy();
+    scene.UpdateTransforms();
+    scene.BuildBoundingVolumeHierarchy();
     m_DirtyFlag = true;
 }
 
@@ -11,6 +11,9 @@ protected:
     std::list<std::shared_ptr<BaseSceneNode>>        m_Chlidren;
     std::list<std::shared_ptr<SceneObjectTransform>> m_Transforms;
     mat4f                                            m_RuntimeTransform = mat4f(1.0f);
+    // Written by TransformHierarchy::Update
+    mat4f                                            m_WorldTransform   = mat4f(1.0f);
+    uint64_t                                         m_TransformVersion = 0;
     bool                                             m_Dirty            = true;
 
     virtual void dump(std::ostream& out, unsigned indent) const {}
@@ -21,23 +24,31 @@ public:
 
     virtual ~BaseSceneNode() = default;
 
-    const std::string& GetName() const { return m_Name; }
+    const std::string&                               GetName() const { return m_Name; }
+    const std::list<std::shared_ptr<BaseSceneNode>>& GetChildren() const { return m_Chlidren; }
 
     void AppendChild(std::shared_ptr<BaseSceneNode>&& sub_node) { m_Chlidren.push_back(std::move(sub_node)); }
     void AppendTransform(std::shared_ptr<SceneObjectTransform>&& transform) {
         m_Transforms.push_back(std::move(transform));
+        m_Dirty = true;
     }
 
+    // The local transform of the node, without its parents
     mat4f GetCalculatedTransform() const {
         mat4f result(1.0f);
 
-        for (auto trans : m_Transforms) {
+        for (auto&& trans : m_Transforms) {
             result = static_cast<mat4f>(*trans) * result;
         }
         result = m_RuntimeTransform * result;
         return result;
     }
-    // Get is the node updated
+    // The transform including the parents, as of the last TransformHierarchy::Update
+    const mat4f& GetWorldTransform() const { return m_WorldTransform; }
+    // The version of the TransformHierarchy update that last changed the world transform, so a consumer
+    // can skip the node if the version is the same as the one it used
+    uint64_t GetTransformVersion() const { return m_TransformVersion; }
+    // Get is the local transform changed since the last TransformHierarchy::Update
     bool Dirty() const { return m_Dirty; }
     void ClearDirty() { m_Dirty = false; }
 
@@ -54,6 +65,7 @@ public:
                 if (child) child->Reset(recursive);
     }
 
+    friend class TransformHierarchy;
     friend std::ostream& operator<<(std::ostream& out, const BaseSceneNode& node) {
         static unsigned indent = 0;
         out << fmt::format(
@@ -77,6 +89,8 @@ template <typename T>
 class SceneNode : public BaseSceneNode {
 protected:
     std::weak_ptr<T> m_SceneObjectRef;
+    // Set by Scene::RegisterObjects, resolved by the scene without locking m_SceneObjectRef
+    Core::Handle<T>  m_SceneObjectHandle;
 
     void dump(std::ostream& out, unsigned indent) const override {
         if (auto obj = m_SceneObjectRef.lock()) {
@@ -89,6 +103,8 @@ public:
     SceneNode() = default;
     void             AddSceneObjectRef(std::weak_ptr<T> ref) { m_SceneObjectRef = ref; }
     std::weak_ptr<T> GetSceneObjectRef() { return m_SceneObjectRef; }
+    void             SetSceneObjectHandle(Core::Handle<T> handle) { m_SceneObjectHandle = handle; }
+    Core::Handle<T>  GetSceneObjectHandle() const { return m_SceneObjectHandle; }
 };
 
 using SceneEmptyNode = BaseSceneNode;
@@ -146,6 +162,11 @@ public:
     vec3f GetCameraLookAt() const { return (GetCalculatedTransform() * vec4f(m_LookAt, 0)).xyz; }
     vec3f GetCameraRight() const { return (GetCalculatedTransform() * vec4f(m_Right, 0)).xyz; }
 
+    // In the space of the node, without the transform
+    const vec3f& GetLocalPosition() const { return m_Position; }
+    const vec3f& GetLocalUp() const { return m_Up; }
+    const vec3f& GetLocalLookAt() const { return m_LookAt; }
+
 private:
     vec3f m_Position;
     vec3f m_LookAt;
@@ -1,10 +1,24 @@
 #include "SceneObject.hpp"
 #include "MemoryManager.hpp"
 #include "AssetManager.hpp"
+#include "TextureCompressor.hpp"
 
 #include <variant>
+#include <span>
+#include <charconv>
 
 namespace Hitagi::Asset {
+std::string TypeToString(std::variant<SceneObjectType, VertexDataType, IndexDataType, PrimitiveType> type);
+
+template <typename T>
+std::span<const T> AsSpan(const Core::Buffer& buffer) {
+    return {reinterpret_cast<const T*>(buffer.GetData()), buffer.GetDataSize() / sizeof(T)};
+}
+template <typename T>
+std::span<T> AsSpan(Core::Buffer& buffer) {
+    return {reinterpret_cast<T*>(buffer.GetData()), buffer.GetDataSize() / sizeof(T)};
+}
+
 // Class BaseSceneObject
 BaseSceneObject::BaseSceneObject(SceneObjectType type) : m_Type(type) { m_Guid = xg::newGuid(); }
 BaseSceneObject::BaseSceneObject(const xg::Guid& guid, const SceneObjectType& type) : m_Guid(guid), m_Type(type) {}
@@ -25,18 +39,24 @@ SceneObjectVertexArray::SceneObjectVertexArray(std::string_view attr,
                                                Core::Buffer&&   buffer,
                                                uint32_t         morphIndex)
     : m_Attribute(attr),
+      m_Semantic(ParseAttributeName(attr).first),
+      m_SemanticIndex(ParseAttributeName(attr).second),
       m_DataType(dataType),
       m_VertexCount(buffer.GetDataSize() / GetVertexSize()),
       m_Data(std::move(buffer)),
       m_MorphTargetIndex(morphIndex) {}
 
 const std::string& SceneObjectVertexArray::GetAttributeName() const { return m_Attribute; }
+VertexAttribute    SceneObjectVertexArray::GetAttribute() const { return m_Semantic; }
+uint32_t           SceneObjectVertexArray::GetSemanticIndex() const { return m_SemanticIndex; }
 VertexDataType     SceneObjectVertexArray::GetDataType() const { return m_DataType; }
 size_t             SceneObjectVertexArray::GetDataSize() const { return m_Data.GetDataSize(); }
 const uint8_t*     SceneObjectVertexArray::GetData() const { return m_Data.GetData(); }
 size_t             SceneObjectVertexArray::GetVertexCount() const { return m_VertexCount; }
-size_t             SceneObjectVertexArray::GetVertexSize() const {
-    switch (m_DataType) {
+size_t             SceneObjectVertexArray::GetVertexSize() const { return GetVertexSize(m_DataType); }
+
+size_t SceneObjectVertexArray::GetVertexSize(VertexDataType dataType) {
+    switch (dataType) {
         case VertexDataType::FLOAT1:
             return sizeof(float) * 1;
         case VertexDataType::FLOAT2:
@@ -53,10 +73,90 @@ size_t             SceneObjectVertexArray::GetVertexSize() const {
             return sizeof(double) * 3;
         case VertexDataType::DOUBLE4:
             return sizeof(double) * 4;
+        case VertexDataType::HALF2:
+            return sizeof(half_t) * 2;
+        case VertexDataType::HALF4:
+            return sizeof(half_t) * 4;
+        case VertexDataType::UNORM8_4:
+            return sizeof(uint8_t) * 4;
+        case VertexDataType::UNORM16_2:
+            return sizeof(uint16_t) * 2;
+        case VertexDataType::OCT_NORMAL:
+            return sizeof(int16_t) * 2;
+        case VertexDataType::OCT_TANGENT:
+            return sizeof(int16_t) * 4;
     }
     return 0;
 }
 
+std::pair<VertexAttribute, uint32_t> SceneObjectVertexArray::ParseAttributeName(std::string_view name) {
+    constexpr std::array<std::pair<std::string_view, VertexAttribute>, 6> semantics = {{
+        {"POSITION", VertexAttribute::POSITION},
+        {"NORMAL", VertexAttribute::NORMAL},
+        {"TANGENT", VertexAttribute::TANGENT},
+        {"BITANGENT", VertexAttribute::BITANGENT},
+        {"COLOR", VertexAttribute::COLOR},
+        {"TEXCOORD", VertexAttribute::TEXCOORD},
+    }};
+    for (auto&& [semantic, attribute] : semantics) {
+        if (!name.starts_with(semantic)) continue;
+        // the name is the semantic with an optional index
+        const auto suffix = name.substr(semantic.size());
+        uint32_t   index  = 0;
+        if (suffix.empty()) return {attribute, 0};
+        if (auto [ptr, ec] = std::from_chars(suffix.data(), suffix.data() + suffix.size(), index);
+            ec == std::errc() && ptr == suffix.data() + suffix.size())
+            return {attribute, index};
+    }
+    return {VertexAttribute::CUSTOM, 0};
+}
+
+SceneObjectVertexArray SceneObjectVertexArray::ConvertTo(VertexDataType dataType) const {
+    if (dataType == m_DataType) return *this;
+
+    Core::Buffer buffer(m_VertexCount * GetVertexSize(dataType));
+
+    if ((m_DataType == VertexDataType::FLOAT2 && dataType == VertexDataType::HALF2) || (m_DataType == VertexDataType::FLOAT4 && dataType == VertexDataType::HALF4))
+        PackHalf(AsSpan<float>(m_Data), AsSpan<half_t>(buffer));
+    else if (m_DataType == VertexDataType::FLOAT2 && dataType == VertexDataType::UNORM16_2)
+        PackUnorm16(AsSpan<float>(m_Data), AsSpan<uint16_t>(buffer));
+    else if (m_DataType == VertexDataType::FLOAT4 && dataType == VertexDataType::UNORM8_4)
+        PackUnorm8(AsSpan<float>(m_Data), AsSpan<uint8_t>(buffer));
+    else if (m_DataType == VertexDataType::FLOAT3 && dataType == VertexDataType::OCT_NORMAL)
+        OctEncode(AsSpan<vec3f>(m_Data), AsSpan<Vector<int16_t, 2>>(buffer));
+    else if ((m_DataType == VertexDataType::HALF2 && dataType == VertexDataType::FLOAT2) || (m_DataType == VertexDataType::HALF4 && dataType == VertexDataType::FLOAT4))
+        UnpackHalf(AsSpan<half_t>(m_Data), AsSpan<float>(buffer));
+    else if (m_DataType == VertexDataType::UNORM16_2 && dataType == VertexDataType::FLOAT2)
+        UnpackUnorm16(AsSpan<uint16_t>(m_Data), AsSpan<float>(buffer));
+    else if (m_DataType == VertexDataType::UNORM8_4 && dataType == VertexDataType::FLOAT4)
+        UnpackUnorm8(AsSpan<uint8_t>(m_Data), AsSpan<float>(buffer));
+    else if (m_DataType == VertexDataType::OCT_NORMAL && dataType == VertexDataType::FLOAT3)
+        OctDecode(AsSpan<Vector<int16_t, 2>>(m_Data), AsSpan<vec3f>(buffer));
+    else
+        throw std::invalid_argument(fmt::format("Can not convert vertex array from {} to {}", TypeToString(m_DataType), TypeToString(dataType)));
+
+    return SceneObjectVertexArray(m_Attribute, dataType, std::move(buffer), m_MorphTargetIndex);
+}
+
+SceneObjectVertexArray SceneObjectVertexArray::PackTangentFrame(const SceneObjectVertexArray& normal,
+                                                                const SceneObjectVertexArray& tangent,
+                                                                const SceneObjectVertexArray& bitangent) {
+    if (normal.GetDataType() != VertexDataType::FLOAT3 || tangent.GetDataType() != VertexDataType::FLOAT3 || bitangent.GetDataType() != VertexDataType::FLOAT3)
+        throw std::invalid_argument("Tangent frame can only be packed from FLOAT3 arrays");
+    if (normal.GetVertexCount() != tangent.GetVertexCount() || normal.GetVertexCount() != bitangent.GetVertexCount())
+        throw std::invalid_argument("The vertex count of normal, tangent and bitangent are not the same");
+
+    const size_t count = normal.GetVertexCount();
+    Core::Buffer buffer(count * GetVertexSize(VertexDataType::OCT_TANGENT));
+    EncodeTangentFrame(
+        {reinterpret_cast<const vec3f*>(normal.GetData()), count},
+        {reinterpret_cast<const vec3f*>(tangent.GetData()), count},
+        {reinterpret_cast<const vec3f*>(bitangent.GetData()), count},
+        {reinterpret_cast<Vector<int16_t, 4>*>(buffer.GetData()), count});
+
+    return SceneObjectVertexArray(tangent.GetAttributeName(), VertexDataType::OCT_TANGENT, std::move(buffer), tangent.m_MorphTargetIndex);
+}
+
 // Class SceneObjectIndexArray
 SceneObjectIndexArray::SceneObjectIndexArray(
     const IndexDataType dataType,
@@ -71,8 +171,10 @@ const IndexDataType SceneObjectIndexArray::GetIndexType() const { return m_DataT
 const uint8_t*      SceneObjectIndexArray::GetData() const { return m_Data.GetData(); }
 size_t              SceneObjectIndexArray::GetIndexCount() const { return m_IndexCount; }
 size_t              SceneObjectIndexArray::GetDataSize() const { return m_Data.GetDataSize(); }
-size_t              SceneObjectIndexArray::GetIndexSize() const {
-    switch (m_DataType) {
+size_t              SceneObjectIndexArray::GetIndexSize() const { return GetIndexSize(m_DataType); }
+
+size_t SceneObjectIndexArray::GetIndexSize(IndexDataType dataType) {
+    switch (dataType) {
         case IndexDataType::INT8:
             return sizeof(int8_t);
         case IndexDataType::INT16:
@@ -88,37 +190,89 @@ size_t              SceneObjectIndexArray::GetIndexSize() const {
 // Class SceneObjectMesh
 void SceneObjectMesh::AddIndexArray(SceneObjectIndexArray&& array) { m_IndexArray = std::move(array); }
 void SceneObjectMesh::AddVertexArray(SceneObjectVertexArray&& array) { m_VertexArray.emplace_back(std::move(array)); }
+void SceneObjectMesh::SetVertexArrays(std::vector<SceneObjectVertexArray>&& arrays) { m_VertexArray = std::move(arrays); }
 void SceneObjectMesh::SetPrimitiveType(PrimitiveType type) { m_PrimitiveType = type; }
 void SceneObjectMesh::SetMaterial(const std::weak_ptr<SceneObjectMaterial>& material) { m_Material = material; }
+void SceneObjectMesh::SetMaterialHandle(Core::Handle<SceneObjectMaterial> handle) { m_MaterialHandle = handle; }
+void SceneObjectMesh::SetVertexLayout(VertexLayout layout) { m_VertexLayout = layout; }
 
 const SceneObjectVertexArray& SceneObjectMesh::GetVertexByName(std::string_view name) const {
-    for (auto&& vertex : m_VertexArray)
-        if (vertex.GetAttributeName() == name)
-            return vertex;
+    const auto [attribute, index] = SceneObjectVertexArray::ParseAttributeName(name);
+    if (attribute != VertexAttribute::CUSTOM) {
+        if (auto vertex = GetVertexArray(attribute, index)) return *vertex;
+    } else {
+        for (auto&& vertex : m_VertexArray)
+            if (vertex.GetAttributeName() == name)
+                return vertex;
+    }
     throw std::range_error(fmt::format("No name called{}", name));
 }
+const SceneObjectVertexArray* SceneObjectMesh::GetVertexArray(VertexAttribute attribute, uint32_t semanticIndex) const {
+    for (auto&& vertex : m_VertexArray)
+        if (vertex.GetAttribute() == attribute && vertex.GetSemanticIndex() == semanticIndex)
+            return &vertex;
+    return nullptr;
+}
 size_t                                     SceneObjectMesh::GetVertexArraysCount() const { return m_VertexArray.size(); }
 const std::vector<SceneObjectVertexArray>& SceneObjectMesh::GetVertexArrays() const { return m_VertexArray; }
 
 const SceneObjectIndexArray&       SceneObjectMesh::GetIndexArray() const { return m_IndexArray; }
 const PrimitiveType&               SceneObjectMesh::GetPrimitiveType() const { return m_PrimitiveType; }
 std::weak_ptr<SceneObjectMaterial> SceneObjectMesh::GetMaterial() const { return m_Material; }
+Core::Handle<SceneObjectMaterial>  SceneObjectMesh::GetMaterialHandle() const { return m_MaterialHandle; }
+VertexLayout                       SceneObjectMesh::GetVertexLayout() const { return m_VertexLayout; }
+
+std::vector<VertexStream> SceneObjectMesh::CreateVertexStreams() const {
+    auto createStream = [](std::span<const SceneObjectVertexArray* const> arrays) {
+        VertexStream stream;
+        stream.vertexCount = arrays.front()->GetVertexCount();
+        for (auto array : arrays) {
+            stream.elements.emplace_back(VertexElement{array->GetAttribute(), array->GetSemanticIndex(), array->GetDataType(), stream.stride});
+            stream.stride += array->GetVertexSize();
+            stream.vertexCount = std::min(stream.vertexCount, array->GetVertexCount());
+        }
+
+        stream.data = Core::Buffer(stream.vertexCount * stream.stride);
+        for (size_t i = 0; i < arrays.size(); i++) {
+            const size_t size = arrays[i]->GetVertexSize();
+            uint8_t*     dest = stream.data.GetData() + stream.elements[i].offset;
+            for (size_t v = 0; v < stream.vertexCount; v++, dest += stream.stride)
+                std::memcpy(dest, arrays[i]->GetData() + v * size, size);
+        }
+        return stream;
+    };
+
+    std::vector<VertexStream>                  streams;
+    std::vector<const SceneObjectVertexArray*> interleaved;
+    for (auto&& array : m_VertexArray) {
+        if (m_VertexLayout == VertexLayout::INTERLEAVED && array.GetAttribute() != VertexAttribute::POSITION)
+            interleaved.emplace_back(&array);
+        else
+            streams.emplace_back(createStream(std::array{&array}));
+    }
+    if (!interleaved.empty()) streams.emplace_back(createStream(interleaved));
+    return streams;
+}
 
 // Class SceneObjectTexture
 void SceneObjectTexture::AddTransform(mat4f& matrix) { m_Transforms.push_back(matrix); }
 void SceneObjectTexture::SetName(const std::string& name) { m_Name = name; }
 void SceneObjectTexture::SetName(std::string&& name) { m_Name = std::move(name); }
 void SceneObjectTexture::LoadTexture() {
-    if (m_Image.Empty()) {
-        m_Image = g_AssetManager->ParseImage(m_TexturePath);
-    }
+    if (!m_Image) m_Image = g_AssetManager->LoadTextureImage(m_TexturePath, m_sRGB);
+}
+void SceneObjectTexture::Compress(PixelFormat format) {
+    if (!m_Image || m_Image->Empty() || m_Image->GetFormat() == format) return;
+    // the image may be shared, so it is replaced instead of compressed in place
+    if (auto compressed = CompressImage(*m_Image, format); !compressed.Empty())
+        m_Image = std::make_shared<const Image>(std::move(compressed));
 }
 const std::string& SceneObjectTexture::GetName() const { return m_Name; }
 const Image&       SceneObjectTexture::GetTextureImage() {
-    if (m_Image.Empty()) {
+    if (!m_Image) {
         LoadTexture();
     }
-    return m_Image;
+    return *m_Image;
 }
 
 // Class SceneObjectMaterial
@@ -128,6 +282,9 @@ const Color&       SceneObjectMaterial::GetDiffuseColor() const { return m_Diffu
 const Color&       SceneObjectMaterial::GetSpecularColor() const { return m_Specular; }
 const Parameter&   SceneObjectMaterial::GetSpecularPower() const { return m_SpecularPower; }
 const Color&       SceneObjectMaterial::GetEmission() const { return m_Emission; }
+const Color&       SceneObjectMaterial::GetTransparency() const { return m_Transparency; }
+const Parameter&   SceneObjectMaterial::GetOpacity() const { return m_Opacity; }
+const Normal&      SceneObjectMaterial::GetNormal() const { return m_Normal; }
 void               SceneObjectMaterial::SetName(const std::string& name) { m_Name = name; }
 void               SceneObjectMaterial::SetName(std::string&& name) { m_Name = std::move(name); }
 void               SceneObjectMaterial::SetColor(std::string_view attrib, const vec4f& color) {
@@ -142,6 +299,9 @@ void SceneObjectMaterial::SetParam(std::string_view attrib, const float param) {
     if (attrib == "opacity") m_Opacity = Parameter(param);
 }
 void SceneObjectMaterial::SetTexture(std::string_view attrib, const std::shared_ptr<SceneObjectTexture>& texture) {
+    // a texture used by any color slot is sRGB
+    const bool color = attrib == "ambient" || attrib == "diffuse" || attrib == "specular" || attrib == "emission" || attrib == "transparency";
+    if (texture && color) texture->SetSRGB(true);
     if (attrib == "ambient") m_DiffuseColor = texture;
     if (attrib == "diffuse") m_DiffuseColor = texture;
     if (attrib == "specular") m_Specular = texture;
@@ -161,7 +321,7 @@ void SceneObjectGeometry::SetIfCastShadow(bool shadow) { m_Shadow = shadow; }
 void SceneObjectGeometry::SetIfMotionBlur(bool motion_blur) { m_MotionBlur = motion_blur; }
 void SceneObjectGeometry::SetCollisionType(SceneObjectCollisionType collisionType) { m_CollisionType = collisionType; }
 void SceneObjectGeometry::SetCollisionParameters(const float* param, int32_t count) {
-    assert(count > 0 && count < 10);
+    assert(count > 0 && count <= 10);
     memcpy(m_CollisionParameters.data(), param, sizeof(float) * count);
 }
 const bool                     SceneObjectGeometry::Visible() const { return m_Visible; }
@@ -171,12 +331,36 @@ const SceneObjectCollisionType SceneObjectGeometry::CollisionType() const { retu
 const float*                   SceneObjectGeometry::CollisionParameters() const { return m_CollisionParameters.data(); }
 
 void SceneObjectGeometry::AddMesh(std::unique_ptr<SceneObjectMesh> mesh, size_t level) {
-    if (level >= m_MeshesLOD.size()) m_MeshesLOD.resize(level + 1);
+    if (level >= m_MeshesLOD.size()) {
+        m_MeshesLOD.resize(level + 1);
+        m_LODErrors.resize(level + 1, std::numeric_limits<float>::infinity());
+        m_LODErrors[0] = 0.0f;
+    }
+    if (level == 0) {
+        if (auto array = mesh->GetVertexArray(VertexAttribute::POSITION); array && array->GetDataType() == VertexDataType::FLOAT3) {
+            auto positions = std::span(reinterpret_cast<const vec3f*>(array->GetData()), array->GetVertexCount());
+            m_BoundingBox  = Merge(m_BoundingBox, BoundingBox(positions));
+        }
+    }
     m_MeshesLOD[level].emplace_back(mesh.release());
 }
 const std::vector<std::unique_ptr<SceneObjectMesh>>& SceneObjectGeometry::GetMeshes(size_t lod) const {
     return m_MeshesLOD[lod];
 }
+size_t SceneObjectGeometry::GetLODCount() const { return m_MeshesLOD.size(); }
+void   SceneObjectGeometry::SetLODError(size_t lod, float error) {
+    assert(lod < m_LODErrors.size());
+    m_LODErrors[lod] = error;
+}
+float  SceneObjectGeometry::GetLODError(size_t lod) const { return m_LODErrors[lod]; }
+size_t SceneObjectGeometry::SelectLOD(float screenSize, float maxScreenError) const {
+    // the LODs without a known error are never selected
+    for (size_t lod = m_LODErrors.size(); lod-- > 1;) {
+        if (m_LODErrors[lod] * screenSize <= maxScreenError) return lod;
+    }
+    return 0;
+}
+const Box& SceneObjectGeometry::GetBoundingBox() const { return m_BoundingBox; }
 
 // Class SceneObjectLight
 void SceneObjectLight::SetIfCastShadow(bool shadow) { m_CastShadows = shadow; }
@@ -198,6 +382,7 @@ void SceneObjectLight::SetTexture(std::string_view attrib, std::string_view text
 void         SceneObjectLight::SetAttenuation(AttenFunc func) { m_LightAttenuation = func; }
 const Color& SceneObjectLight::GetColor() { return m_LightColor; }
 float        SceneObjectLight::GetIntensity() { return m_Intensity; }
+bool         SceneObjectLight::CastShadow() const { return m_CastShadows; }
 
 // Class SceneObjectOmniLight
 // Class SceneObjectSpotLight
@@ -347,6 +532,29 @@ std::ostream& operator<<(std::ostream& out, const SceneObjectVertexArray& obj) {
             case VertexDataType::DOUBLE4:
                 std::cout << *(reinterpret_cast<const Vector<double, 4>*>(data) + i) << " ";
                 break;
+            case VertexDataType::HALF2: {
+                auto v = reinterpret_cast<const half_t*>(data) + 2 * i;
+                std::cout << vec2f(HalfToFloat(v[0]), HalfToFloat(v[1])) << " ";
+            } break;
+            case VertexDataType::HALF4: {
+                auto v = reinterpret_cast<const half_t*>(data) + 4 * i;
+                std::cout << vec4f(HalfToFloat(v[0]), HalfToFloat(v[1]), HalfToFloat(v[2]), HalfToFloat(v[3])) << " ";
+            } break;
+            case VertexDataType::UNORM8_4: {
+                auto v = reinterpret_cast<const uint8_t*>(data) + 4 * i;
+                std::cout << vec4f(UnpackUnorm8(v[0]), UnpackUnorm8(v[1]), UnpackUnorm8(v[2]), UnpackUnorm8(v[3])) << " ";
+            } break;
+            case VertexDataType::UNORM16_2: {
+                auto v = reinterpret_cast<const uint16_t*>(data) + 2 * i;
+                std::cout << vec2f(UnpackUnorm16(v[0]), UnpackUnorm16(v[1])) << " ";
+            } break;
+            case VertexDataType::OCT_NORMAL:
+                std::cout << OctDecode(*(reinterpret_cast<const Vector<int16_t, 2>*>(data) + i)) << " ";
+                break;
+            case VertexDataType::OCT_TANGENT: {
+                auto frame = *(reinterpret_cast<const Vector<int16_t, 4>*>(data) + i);
+                std::cout << vec4f(OctDecode(Vector<int16_t, 2>(frame.x, frame.y)), frame.z < 0 ? -1.0f : 1.0f) << " ";
+            } break;
             default:
                 break;
         }
@@ -397,8 +605,8 @@ std::ostream& operator<<(std::ostream& out, const SceneObjectTexture& obj) {
     out << static_cast<const BaseSceneObject&>(obj) << std::endl;
     out << "Coord Index: " << obj.m_TexCoordIndex << std::endl;
     out << "Name:        " << obj.m_Name << std::endl;
-    if (!obj.m_Image.Empty()) out << "Image:\n"
-                                  << obj.m_Image;
+    if (obj.m_Image && !obj.m_Image->Empty()) out << "Image:\n"
+                                                  << *obj.m_Image;
     return out;
 }
 std::ostream& operator<<(std::ostream& out, const SceneObjectMaterial& obj) {
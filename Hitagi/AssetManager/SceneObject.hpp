@@ -1,7 +1,9 @@
 #pragma once
 #include "HitagiMath.hpp"
+#include "Geometry.hpp"
 #include "Image.hpp"
 #include "Buffer.hpp"
+#include "Handle.hpp"
 
 #include <crossguid/guid.hpp>
 
@@ -45,6 +47,13 @@ enum struct VertexDataType : int32_t {
     DOUBLE2 = "DUB2"_i32,
     DOUBLE3 = "DUB3"_i32,
     DOUBLE4 = "DUB4"_i32,
+    // packed formats
+    HALF2       = "HLF2"_i32,
+    HALF4       = "HLF4"_i32,
+    UNORM8_4    = "UN84"_i32,  // e.g. color
+    UNORM16_2   = "U162"_i32,  // e.g. texcoord in [0, 1]
+    OCT_NORMAL  = "OCTN"_i32,  // octahedral unit vector as 2 snorm16
+    OCT_TANGENT = "OCTT"_i32,  // octahedral tangent, bitangent sign and padding as 4 snorm16
 };
 
 enum struct IndexDataType : int32_t {
@@ -76,6 +85,39 @@ enum struct PrimitiveType : int32_t {
     // clang-format on
 };
 
+// The semantic of a vertex array, the arrays of a semantic are told apart by the semantic index,
+// e.g. the array named TEXCOORD1 is (TEXCOORD, 1). The arrays of the other names are CUSTOM.
+enum struct VertexAttribute : int32_t {
+    CUSTOM    = "CUST"_i32,
+    POSITION  = "POSI"_i32,
+    NORMAL    = "NORM"_i32,
+    TANGENT   = "TANG"_i32,
+    BITANGENT = "BTAN"_i32,
+    COLOR     = "COLR"_i32,
+    TEXCOORD  = "TEXC"_i32,
+};
+
+// How the vertex arrays of a mesh are laid out in the vertex buffers
+enum struct VertexLayout : int32_t {
+    SEPARATE    = "SEPA"_i32,  // a stream per vertex array
+    INTERLEAVED = "INTL"_i32,  // a position stream, for the depth only passes, and a stream of all the other arrays
+};
+
+struct VertexElement {
+    VertexAttribute attribute;
+    uint32_t        semanticIndex;
+    VertexDataType  dataType;
+    size_t          offset;
+};
+
+// The vertex data bound to an input slot
+struct VertexStream {
+    Core::Buffer               data;
+    size_t                     stride      = 0;
+    size_t                     vertexCount = 0;
+    std::vector<VertexElement> elements;
+};
+
 class BaseSceneObject {
 protected:
     xg::Guid        m_Guid;
@@ -100,29 +142,38 @@ public:
 
 class SceneObjectTexture : public BaseSceneObject {
 protected:
-    uint32_t              m_TexCoordIndex = 0;
-    std::string           m_Name;
-    std::filesystem::path m_TexturePath;
-    Image                 m_Image;
-    std::vector<mat4f>    m_Transforms;
+    uint32_t                     m_TexCoordIndex = 0;
+    std::string                  m_Name;
+    std::filesystem::path        m_TexturePath;
+    std::shared_ptr<const Image> m_Image;
+    std::vector<mat4f>           m_Transforms;
+    // The color maps are sRGB, set by the material slots. The others are linear.
+    bool                         m_sRGB = false;
 
 public:
     SceneObjectTexture() : BaseSceneObject(SceneObjectType::TEXTURE) {}
     SceneObjectTexture(const std::filesystem::path& path)
         : BaseSceneObject(SceneObjectType::TEXTURE), m_TexCoordIndex(0), m_Name(path.filename().string()), m_TexturePath(path) {}
     SceneObjectTexture(uint32_t coordIndex, Image image)
-        : BaseSceneObject(SceneObjectType::TEXTURE), m_TexCoordIndex(coordIndex), m_Image(std::move(image)) {}
+        : BaseSceneObject(SceneObjectType::TEXTURE), m_TexCoordIndex(coordIndex), m_Image(std::make_shared<const Image>(std::move(image))) {}
     SceneObjectTexture(uint32_t coordIndex, Image&& image)
-        : BaseSceneObject(SceneObjectType::TEXTURE), m_TexCoordIndex(coordIndex), m_Image(std::move(image)) {}
+        : BaseSceneObject(SceneObjectType::TEXTURE), m_TexCoordIndex(coordIndex), m_Image(std::make_shared<const Image>(std::move(image))) {}
     SceneObjectTexture(SceneObjectTexture&)  = default;
     SceneObjectTexture(SceneObjectTexture&&) = default;
 
     void                 AddTransform(mat4f& matrix);
     void                 SetName(const std::string& name);
     void                 SetName(std::string&& name);
+    void                 SetSRGB(bool sRGB) { m_sRGB = sRGB; }
+    bool                 IsSRGB() const { return m_sRGB; }
+    // The image is shared with the other textures of the same path by AssetManager
     void                 LoadTexture();
+    // Keep the uncompressed image if it can not be compressed to the format
+    void                 Compress(PixelFormat format);
     const std::string&   GetName() const;
     const Image&         GetTextureImage();
+    const auto&          GetTexturePath() const { return m_TexturePath; }
+    bool                 Loaded() const { return m_Image != nullptr; }
     friend std::ostream& operator<<(std::ostream& out, const SceneObjectTexture& obj);
 };
 
@@ -196,7 +247,10 @@ public:
     const Color&         GetDiffuseColor() const;
     const Color&         GetSpecularColor() const;
     const Color&         GetEmission() const;
+    const Color&         GetTransparency() const;
     const Parameter&     GetSpecularPower() const;
+    const Parameter&     GetOpacity() const;
+    const Normal&        GetNormal() const;
     void                 SetName(const std::string& name);
     void                 SetName(std::string&& name);
     void                 SetColor(std::string_view attrib, const vec4f& color);
@@ -221,16 +275,29 @@ public:
     ~SceneObjectVertexArray()                                   = default;
 
     const std::string&   GetAttributeName() const;
+    VertexAttribute      GetAttribute() const;
+    uint32_t             GetSemanticIndex() const;
     VertexDataType       GetDataType() const;
     size_t               GetDataSize() const;
     const uint8_t*       GetData() const;
     size_t               GetVertexCount() const;
     size_t               GetVertexSize() const;
-    friend std::ostream& operator<<(std::ostream& out, const SceneObjectVertexArray& obj);
+    // Convert between a float type and its packed counterparts, e.g. FLOAT3 <-> OCT_NORMAL.
+    // OCT_TANGENT needs the normals, so it is built by SceneObjectVertexArray::PackTangentFrame.
+    SceneObjectVertexArray ConvertTo(VertexDataType dataType) const;
+    friend std::ostream&   operator<<(std::ostream& out, const SceneObjectVertexArray& obj);
+
+    static size_t                               GetVertexSize(VertexDataType dataType);
+    static std::pair<VertexAttribute, uint32_t> ParseAttributeName(std::string_view name);
+    static SceneObjectVertexArray               PackTangentFrame(const SceneObjectVertexArray& normal,
+                                                                 const SceneObjectVertexArray& tangent,
+                                                                 const SceneObjectVertexArray& bitangent);
 
 private:
-    std::string    m_Attribute;
-    VertexDataType m_DataType;
+    std::string     m_Attribute;
+    VertexAttribute m_Semantic;
+    uint32_t        m_SemanticIndex;
+    VertexDataType  m_DataType;
     size_t         m_VertexCount;
     Core::Buffer   m_Data;
 
@@ -258,6 +325,9 @@ public:
     size_t               GetIndexSize() const;
     friend std::ostream& operator<<(std::ostream& out, const SceneObjectIndexArray& obj);
 
+    // 0 for an unknown data type
+    static size_t GetIndexSize(IndexDataType dataType);
+
 private:
     IndexDataType m_DataType;
     size_t        m_IndexCount;
@@ -275,7 +345,10 @@ protected:
     std::vector<SceneObjectVertexArray> m_VertexArray;
     SceneObjectIndexArray               m_IndexArray;
     std::weak_ptr<SceneObjectMaterial>  m_Material;
+    // Set by Scene::RegisterObjects, resolved by the scene without locking m_Material
+    Core::Handle<SceneObjectMaterial>   m_MaterialHandle;
     PrimitiveType                       m_PrimitiveType;
+    VertexLayout                        m_VertexLayout = VertexLayout::SEPARATE;
 
     bool m_Visible;
     bool m_Shadow;
@@ -288,21 +361,33 @@ public:
         : BaseSceneObject(SceneObjectType::MESH),
           m_IndexArray(std::move(mesh.m_IndexArray)),
           m_VertexArray(std::move(mesh.m_VertexArray)),
-          m_PrimitiveType(mesh.m_PrimitiveType) {}
+          m_PrimitiveType(mesh.m_PrimitiveType),
+          m_VertexLayout(mesh.m_VertexLayout) {}
 
     // Set some things
     void AddIndexArray(SceneObjectIndexArray&& array);
     void AddVertexArray(SceneObjectVertexArray&& array);
+    void SetVertexArrays(std::vector<SceneObjectVertexArray>&& arrays);
     void SetPrimitiveType(PrimitiveType type);
     void SetMaterial(const std::weak_ptr<SceneObjectMaterial>& material);
+    void SetMaterialHandle(Core::Handle<SceneObjectMaterial> handle);
+    void SetVertexLayout(VertexLayout layout);
 
     // Get some things
     const SceneObjectVertexArray&              GetVertexByName(std::string_view name) const;
+    // Return nullptr if the mesh has no such array
+    const SceneObjectVertexArray*              GetVertexArray(VertexAttribute attribute, uint32_t semanticIndex = 0) const;
     size_t                                     GetVertexArraysCount() const;
     const std::vector<SceneObjectVertexArray>& GetVertexArrays() const;
     const SceneObjectIndexArray&               GetIndexArray() const;
     const PrimitiveType&                       GetPrimitiveType() const;
     std::weak_ptr<SceneObjectMaterial>         GetMaterial() const;
+    Core::Handle<SceneObjectMaterial>          GetMaterialHandle() const;
+    VertexLayout                               GetVertexLayout() const;
+
+    // Build the vertex streams of the layout for uploading, the elements of an interleaved stream
+    // are in the order of the vertex arrays
+    std::vector<VertexStream> CreateVertexStreams() const;
 
     friend std::ostream& operator<<(std::ostream& out, const SceneObjectMesh& obj);
 };
@@ -313,12 +398,16 @@ protected:
     //  0  | meshes array[0] include multiple meshes at 0 LOD
     // ... | ...
     std::vector<std::vector<std::unique_ptr<SceneObjectMesh>>> m_MeshesLOD;
-
-    bool                     m_Visible;
-    bool                     m_Shadow;
-    bool                     m_MotionBlur;
+    // The geometric error of each LOD relative to the bounding radius, infinity if unknown
+    std::vector<float> m_LODErrors;
+    // The bounding box of the positions of LOD 0
+    Box m_BoundingBox;
+
+    bool                     m_Visible    = true;
+    bool                     m_Shadow     = true;
+    bool                     m_MotionBlur = false;
     SceneObjectCollisionType m_CollisionType{SceneObjectCollisionType::NONE};
-    std::array<float, 10>    m_CollisionParameters;
+    std::array<float, 10>    m_CollisionParameters{};
 
 public:
     SceneObjectGeometry()
@@ -335,6 +424,13 @@ public:
     const float*                                         CollisionParameters() const;
     void                                                 AddMesh(std::unique_ptr<SceneObjectMesh> mesh, size_t level = 0);
     const std::vector<std::unique_ptr<SceneObjectMesh>>& GetMeshes(size_t lod = 0) const;
+    size_t                                               GetLODCount() const;
+    void                                                 SetLODError(size_t lod, float error);
+    float                                                GetLODError(size_t lod) const;
+    // Return the coarsest LOD whose error is within maxScreenError on the screen. The screen size is
+    // the projected bounding radius relative to the half height of the view, errors are in the same unit.
+    size_t                                               SelectLOD(float screenSize, float maxScreenError) const;
+    const Box&                                           GetBoundingBox() const;
     friend std::ostream&                                 operator<<(std::ostream& out, const SceneObjectGeometry& obj);
 };
 
@@ -366,6 +462,7 @@ public:
     void         SetAttenuation(AttenFunc func);
     const Color& GetColor();
     float        GetIntensity();
+    bool         CastShadow() const;
 };
 
 class SceneObjectPointLight : public SceneObjectLight {
@@ -386,14 +483,20 @@ public:
     SceneObjectSpotLight(const vec4f& color = vec4f(1.0f), float intensity = 100.0f,
                          const vec3f& direction = vec3f(0.0f), float innerConeAngle = std::numbers::pi / 3.0f,
                          float outerConeAngle = std::numbers::pi / 4.0f)
-        : SceneObjectLight(color, intensity), m_InnerConeAngle(innerConeAngle), m_OuterConeAngle(outerConeAngle) {}
+        : SceneObjectLight(color, intensity), m_Direction(direction), m_InnerConeAngle(innerConeAngle), m_OuterConeAngle(outerConeAngle) {}
+
+    const vec3f& GetDirection() const { return m_Direction; }
+    float        GetInnerConeAngle() const { return m_InnerConeAngle; }
+    float        GetOuterConeAngle() const { return m_OuterConeAngle; }
 
     friend std::ostream& operator<<(std::ostream& out, const SceneObjectSpotLight& obj);
 };
 
 class SceneObjectInfiniteLight : public SceneObjectLight {
 public:
-    using SceneObjectLight::SceneObjectLight;
+    SceneObjectInfiniteLight(const vec4f& color = vec4f(1.0f), float intensity = 100.0f)
+        : SceneObjectLight(color, intensity) {}
+
     friend std::ostream& operator<<(std::ostream& out, const SceneObjectInfiniteLight& obj);
 };
 
@@ -0,0 +1,394 @@
+#include "TextureCompressor.hpp"
+#include "MipGenerator.hpp"
+#include "ThreadManager.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace Hitagi::Asset {
+namespace {
+
+// RGBA of a 4x4 block, row major. The missing channels of R8 and R8G8 images are {0, 0, 255}.
+using Block = std::array<std::array<uint8_t, 4>, 16>;
+
+// The pixels out of the image are clamped to the edge, it happens on the small mip levels.
+Block FetchBlock(const Image& image, uint32_t bx, uint32_t by) {
+    const uint32_t channels = image.GetBitcount() / 8;
+    Block          block;
+    for (uint32_t y = 0; y < 4; y++) {
+        const uint8_t* row = image.GetData() + std::min(4 * by + y, image.GetHeight() - 1) * image.GetPitch();
+        for (uint32_t x = 0; x < 4; x++) {
+            const uint8_t* pixel = row + std::min(4 * bx + x, image.GetWidth() - 1) * channels;
+            auto&          out   = block[4 * y + x];
+            out                  = {0, 0, 0, 255};
+            for (uint32_t c = 0; c < channels; c++) out[c] = pixel[c];
+        }
+    }
+    return block;
+}
+
+template <unsigned N>
+using Color = std::array<float, N>;
+
+template <unsigned N>
+float Distance(const std::array<uint8_t, 4>& pixel, const Color<N>& color) {
+    float result = 0;
+    for (unsigned c = 0; c < N; c++) {
+        const float d = pixel[c] - color[c];
+        result += d * d;
+    }
+    return result;
+}
+
+// Endpoints at the extremes of the principal axis of the block colors
+template <unsigned N>
+std::pair<Color<N>, Color<N>> PrincipalEndpoints(const Block& block) {
+    Color<N> mean{}, min, max;
+    min.fill(255.0f);
+    max.fill(0.0f);
+    for (auto&& pixel : block) {
+        for (unsigned c = 0; c < N; c++) {
+            mean[c] += pixel[c] / 16.0f;
+            min[c] = std::min<float>(min[c], pixel[c]);
+            max[c] = std::max<float>(max[c], pixel[c]);
+        }
+    }
+
+    std::array<Color<N>, N> covariance{};
+    for (auto&& pixel : block)
+        for (unsigned i = 0; i < N; i++)
+            for (unsigned j = 0; j < N; j++)
+                covariance[i][j] += (pixel[i] - mean[i]) * (pixel[j] - mean[j]);
+
+    // power iteration starting from the diagonal of the bounding box
+    Color<N> axis;
+    for (unsigned c = 0; c < N; c++) axis[c] = max[c] - min[c];
+    for (int iteration = 0; iteration < 8; iteration++) {
+        Color<N> next{};
+        float    norm = 0;
+        for (unsigned i = 0; i < N; i++) {
+            for (unsigned j = 0; j < N; j++) next[i] += covariance[i][j] * axis[j];
+            norm = std::max(norm, std::abs(next[i]));
+        }
+        if (norm == 0) break;
+        for (unsigned c = 0; c < N; c++) axis[c] = next[c] / norm;
+    }
+
+    float axisLength = 0;
+    for (unsigned c = 0; c < N; c++) axisLength += axis[c] * axis[c];
+    if (axisLength == 0) return {mean, mean};
+
+    float minT = std::numeric_limits<float>::max(), maxT = std::numeric_limits<float>::lowest();
+    for (auto&& pixel : block) {
+        float t = 0;
+        for (unsigned c = 0; c < N; c++) t += (pixel[c] - mean[c]) * axis[c];
+        minT = std::min(minT, t);
+        maxT = std::max(maxT, t);
+    }
+
+    Color<N> hi, lo;
+    for (unsigned c = 0; c < N; c++) {
+        hi[c] = std::clamp(mean[c] + axis[c] * maxT / axisLength, 0.0f, 255.0f);
+        lo[c] = std::clamp(mean[c] + axis[c] * minT / axisLength, 0.0f, 255.0f);
+    }
+    return {hi, lo};
+}
+
+// Least squares endpoints for given interpolation weights, pixel = (1 - t) * e0 + t * e1
+template <unsigned N>
+bool FitEndpoints(const Block& block, const std::array<float, 16>& t, Color<N>& e0, Color<N>& e1) {
+    float    aa = 0, ab = 0, bb = 0;
+    Color<N> ap{}, bp{};
+    for (size_t i = 0; i < 16; i++) {
+        const float a = 1.0f - t[i], b = t[i];
+        aa += a * a;
+        ab += a * b;
+        bb += b * b;
+        for (unsigned c = 0; c < N; c++) {
+            ap[c] += a * block[i][c];
+            bp[c] += b * block[i][c];
+        }
+    }
+    const float det = aa * bb - ab * ab;
+    if (std::abs(det) < 1e-6f) return false;
+    for (unsigned c = 0; c < N; c++) {
+        e0[c] = std::clamp((bb * ap[c] - ab * bp[c]) / det, 0.0f, 255.0f);
+        e1[c] = std::clamp((aa * bp[c] - ab * ap[c]) / det, 0.0f, 255.0f);
+    }
+    return true;
+}
+
+//---------------------------------------------------------------
+// BC1
+//---------------------------------------------------------------
+uint16_t ToRGB565(const Color<3>& color) {
+    const auto r = static_cast<uint16_t>(std::lround(color[0] * 31.0f / 255.0f));
+    const auto g = static_cast<uint16_t>(std::lround(color[1] * 63.0f / 255.0f));
+    const auto b = static_cast<uint16_t>(std::lround(color[2] * 31.0f / 255.0f));
+    return (r << 11) | (g << 5) | b;
+}
+
+Color<3> FromRGB565(uint16_t color) {
+    const unsigned r = color >> 11, g = (color >> 5) & 0x3f, b = color & 0x1f;
+    return {static_cast<float>((r << 3) | (r >> 2)), static_cast<float>((g << 2) | (g >> 4)), static_cast<float>((b << 3) | (b >> 2))};
+}
+
+struct BC1Candidate {
+    uint16_t c0, c1;
+    uint32_t indices;
+    float    error;
+};
+
+// Four color mode only, c0 > c1 is kept so BC1 blocks never switch to the punch through mode
+BC1Candidate EvaluateBC1(const Block& block, uint16_t c0, uint16_t c1) {
+    if (c0 < c1) std::swap(c0, c1);
+
+    const Color<3>                p0 = FromRGB565(c0), p1 = FromRGB565(c1);
+    std::array<Color<3>, 4>       palette;
+    constexpr std::array<int, 4> weights = {0, 3, 1, 2};  // thirds of p1
+    for (size_t k = 0; k < 4; k++)
+        for (unsigned c = 0; c < 3; c++)
+            palette[k][c] = std::floor(((3 - weights[k]) * p0[c] + weights[k] * p1[c]) / 3.0f);
+
+    BC1Candidate result{c0, c1, 0, 0};
+    if (c0 == c1) {
+        for (auto&& pixel : block) result.error += Distance<3>(pixel, p0);
+        return result;
+    }
+    for (size_t i = 0; i < 16; i++) {
+        uint32_t best      = 0;
+        float    bestError = Distance<3>(block[i], palette[0]);
+        for (uint32_t k = 1; k < 4; k++) {
+            if (float error = Distance<3>(block[i], palette[k]); error < bestError) {
+                best      = k;
+                bestError = error;
+            }
+        }
+        result.indices |= best << (2 * i);
+        result.error += bestError;
+    }
+    return result;
+}
+
+uint64_t EncodeBC1(const Block& block) {
+    auto [hi, lo] = PrincipalEndpoints<3>(block);
+    auto best     = EvaluateBC1(block, ToRGB565(hi), ToRGB565(lo));
+
+    constexpr std::array<float, 4> weights = {0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f};
+    for (int iteration = 0; iteration < 2 && best.error > 0 && best.c0 != best.c1; iteration++) {
+        std::array<float, 16> t;
+        for (size_t i = 0; i < 16; i++) t[i] = weights[(best.indices >> (2 * i)) & 0x3];
+        Color<3> e0, e1;
+        if (!FitEndpoints<3>(block, t, e0, e1)) break;
+        auto candidate = EvaluateBC1(block, ToRGB565(e0), ToRGB565(e1));
+        if (candidate.error >= best.error) break;
+        best = candidate;
+    }
+    return best.c0 | (static_cast<uint64_t>(best.c1) << 16) | (static_cast<uint64_t>(best.indices) << 32);
+}
+
+//---------------------------------------------------------------
+// BC4, eight values mode
+//---------------------------------------------------------------
+uint64_t EncodeBC4(const Block& block, unsigned channel) {
+    uint8_t hi = 0, lo = 255;
+    for (auto&& pixel : block) {
+        hi = std::max(hi, pixel[channel]);
+        lo = std::min(lo, pixel[channel]);
+    }
+    uint64_t result = hi | (static_cast<uint64_t>(lo) << 8);
+    if (hi == lo) return result;
+
+    for (size_t i = 0; i < 16; i++) {
+        // position between hi (0) and lo (7), the palette order is hi, lo, then the 6 interpolated values
+        const auto position = static_cast<uint64_t>(std::lround(7.0f * (hi - block[i][channel]) / (hi - lo)));
+        const auto index    = position == 0 ? 0 : (position == 7 ? 1 : position + 1);
+        result |= index << (16 + 3 * i);
+    }
+    return result;
+}
+
+//---------------------------------------------------------------
+// BC7 mode 6, RGBA 7.7.7.7 endpoints with a unique p-bit, 4 bits indices
+//---------------------------------------------------------------
+constexpr std::array<int, 16> bc7Weights = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+struct BC7Candidate {
+    std::array<uint8_t, 4>  q0, q1;  // 7 bits endpoints
+    uint8_t                 p0, p1;
+    std::array<uint8_t, 16> indices;
+    float                   error;
+};
+
+BC7Candidate EvaluateBC7(const Block& block, const Color<4>& hi, const Color<4>& lo) {
+    BC7Candidate best{};
+    best.error = std::numeric_limits<float>::max();
+    for (uint8_t p0 = 0; p0 < 2; p0++) {
+        for (uint8_t p1 = 0; p1 < 2; p1++) {
+            BC7Candidate candidate{};
+            candidate.p0 = p0;
+            candidate.p1 = p1;
+
+            Color<4> e0, e1;
+            for (unsigned c = 0; c < 4; c++) {
+                candidate.q0[c] = static_cast<uint8_t>(std::clamp<long>(std::lround((hi[c] - p0) / 2.0f), 0, 127));
+                candidate.q1[c] = static_cast<uint8_t>(std::clamp<long>(std::lround((lo[c] - p1) / 2.0f), 0, 127));
+                e0[c]           = (candidate.q0[c] << 1) | p0;
+                e1[c]           = (candidate.q1[c] << 1) | p1;
+            }
+            std::array<Color<4>, 16> palette;
+            for (size_t k = 0; k < 16; k++)
+                for (unsigned c = 0; c < 4; c++)
+                    palette[k][c] = static_cast<float>((static_cast<int>((64 - bc7Weights[k]) * e0[c] + bc7Weights[k] * e1[c]) + 32) >> 6);
+
+            for (size_t i = 0; i < 16 && candidate.error < best.error; i++) {
+                uint8_t index     = 0;
+                float   bestError = Distance<4>(block[i], palette[0]);
+                for (uint8_t k = 1; k < 16; k++) {
+                    if (float error = Distance<4>(block[i], palette[k]); error < bestError) {
+                        index     = k;
+                        bestError = error;
+                    }
+                }
+                candidate.indices[i] = index;
+                candidate.error += bestError;
+            }
+            if (candidate.error < best.error) best = candidate;
+        }
+    }
+    return best;
+}
+
+struct BitWriter {
+    std::array<uint64_t, 2> bits{};
+    unsigned                position = 0;
+
+    void Write(uint64_t value, unsigned count) {
+        const unsigned word = position / 64, offset = position % 64;
+        bits[word] |= value << offset;
+        if (offset + count > 64) bits[word + 1] |= value >> (64 - offset);
+        position += count;
+    }
+};
+
+std::array<uint64_t, 2> EncodeBC7(const Block& block) {
+    auto [hi, lo] = PrincipalEndpoints<4>(block);
+    auto best     = EvaluateBC7(block, hi, lo);
+
+    if (best.error > 0) {
+        std::array<float, 16> t;
+        for (size_t i = 0; i < 16; i++) t[i] = bc7Weights[best.indices[i]] / 64.0f;
+        Color<4> e0, e1;
+        if (FitEndpoints<4>(block, t, e0, e1)) {
+            auto candidate = EvaluateBC7(block, e0, e1);
+            if (candidate.error < best.error) best = candidate;
+        }
+    }
+
+    // the msb of the anchor index is implicitly 0
+    if (best.indices[0] >= 8) {
+        std::swap(best.q0, best.q1);
+        std::swap(best.p0, best.p1);
+        for (auto&& index : best.indices) index = 15 - index;
+    }
+
+    BitWriter writer;
+    writer.Write(1 << 6, 7);  // mode 6
+    for (unsigned c = 0; c < 4; c++) {
+        writer.Write(best.q0[c], 7);
+        writer.Write(best.q1[c], 7);
+    }
+    writer.Write(best.p0, 1);
+    writer.Write(best.p1, 1);
+    writer.Write(best.indices[0], 3);
+    for (size_t i = 1; i < 16; i++) writer.Write(best.indices[i], 4);
+    return writer.bits;
+}
+
+Image EncodeBlocks(const Image& image, PixelFormat format) {
+    const uint32_t blocksX   = (image.GetWidth() + 3) / 4;
+    const uint32_t blocksY   = (image.GetHeight() + 3) / 4;
+    const uint32_t blockSize = GetPixelFormatBitSize(format) * 16 / 8;
+    const uint32_t pitch     = blocksX * blockSize;
+
+    Image result(image.GetWidth(), image.GetHeight(), format, pitch, pitch * blocksY);
+
+    g_ThreadManager->ParallelFor(0, blocksY, [&](size_t by) {
+        uint8_t* out = result.GetData() + by * pitch;
+        for (uint32_t bx = 0; bx < blocksX; bx++, out += blockSize) {
+            const auto block = FetchBlock(image, bx, by);
+            switch (format) {
+                case PixelFormat::BC1_UNORM: {
+                    const uint64_t color = EncodeBC1(block);
+                    std::memcpy(out, &color, sizeof(color));
+                } break;
+                case PixelFormat::BC3_UNORM: {
+                    const uint64_t alpha = EncodeBC4(block, 3), color = EncodeBC1(block);
+                    std::memcpy(out, &alpha, sizeof(alpha));
+                    std::memcpy(out + sizeof(alpha), &color, sizeof(color));
+                } break;
+                case PixelFormat::BC4_UNORM: {
+                    const uint64_t red = EncodeBC4(block, 0);
+                    std::memcpy(out, &red, sizeof(red));
+                } break;
+                case PixelFormat::BC5_UNORM: {
+                    const uint64_t red = EncodeBC4(block, 0), green = EncodeBC4(block, 1);
+                    std::memcpy(out, &red, sizeof(red));
+                    std::memcpy(out + sizeof(red), &green, sizeof(green));
+                } break;
+                case PixelFormat::BC7_UNORM: {
+                    const auto bits = EncodeBC7(block);
+                    std::memcpy(out, bits.data(), sizeof(bits));
+                } break;
+                default:
+                    break;
+            }
+        }
+    });
+    return result;
+}
+
+}  // namespace
+
+Image CompressImage(const Image& image, PixelFormat format) {
+    auto logger = spdlog::get("AssetManager");
+
+    const auto sourceFormat = image.GetFormat();
+    if (image.Empty() || !IsUnorm8(sourceFormat) || !IsBlockCompressed(format)) {
+        if (logger) logger->warn("[Texture Compressor] Can not compress the image, it is empty, not 8 bits per channel or the target format is not supported.");
+        return Image{};
+    }
+    if (image.GetWidth() % 4 != 0 || image.GetHeight() % 4 != 0) {
+        if (logger) logger->warn("[Texture Compressor] The size of image ({}x{}) is not a multiple of 4.", image.GetWidth(), image.GetHeight());
+        return Image{};
+    }
+
+    Image result = EncodeBlocks(image, format);
+
+    std::vector<Image> mips;
+    for (size_t level = 1; level < image.GetMipLevels(); level++)
+        mips.emplace_back(EncodeBlocks(image.GetMip(level), format));
+    result.SetMips(std::move(mips));
+
+    return result;
+}
+
+Image PrepareTexture(Image image, bool generateMips, PixelFormat format, bool sRGB) {
+    if (image.Empty() || !IsUnorm8(image.GetFormat())) return image;
+
+    if (generateMips && image.GetMipLevels() == 1)
+        image.SetMips(GenerateMips(image, MipFilter::Kaiser, sRGB));
+    // Keep the uncompressed image if it can not be compressed to the format
+    if (format != PixelFormat::UNKNOWN && image.GetFormat() != format) {
+        if (auto compressed = CompressImage(image, format); !compressed.Empty())
+            return compressed;
+    }
+    return image;
+}
+
+}  // namespace Hitagi::Asset
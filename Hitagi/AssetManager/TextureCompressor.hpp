@@ -0,0 +1,16 @@
+#pragma once
+#include "Image.hpp"
+
+namespace Hitagi::Asset {
+// Encode an 8 bits per channel image to a block compressed format (BC1, BC3, BC4, BC5 or BC7).
+// Blocks rows are encoded on the thread pool when it is running. BC7 only uses mode 6
+// (single subset RGBA), which suits smooth color textures. The mip levels are compressed too.
+// Return an empty image when the format is not supported or the size is not a multiple of 4.
+Image CompressImage(const Image& image, PixelFormat format);
+
+// Generate the mips of the image if it has none, then compress it to the format unless it is UNKNOWN.
+// The steps that do not apply, e.g. to an image cooked already, keep the image as it is.
+// sRGB is true for the color maps, the data of the others, e.g. normal and roughness maps, is filtered as linear.
+Image PrepareTexture(Image image, bool generateMips, PixelFormat format, bool sRGB);
+
+}  // namespace Hitagi::Asset
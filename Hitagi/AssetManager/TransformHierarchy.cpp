@@ -0,0 +1,106 @@
+#include "TransformHierarchy.hpp"
+#include "ThreadManager.hpp"
+
+namespace Hitagi::Asset {
+
+void TransformHierarchy::Build(BaseSceneNode& root) {
+    m_Nodes.clear();
+    m_Parents.clear();
+
+    // Iterative, so a long chain of nodes does not overflow the stack
+    std::vector<std::pair<BaseSceneNode*, size_t>> stack = {{&root, nullIndex}};
+    while (!stack.empty()) {
+        auto [node, parent] = stack.back();
+        stack.pop_back();
+
+        const size_t index = m_Nodes.size();
+        m_Nodes.emplace_back(node);
+        m_Parents.emplace_back(parent);
+        // Push in reverse to keep the order of the children
+        auto& children = node->GetChildren();
+        for (auto iter = children.rbegin(); iter != children.rend(); iter++)
+            if (*iter) stack.emplace_back(iter->get(), index);
+    }
+
+    const size_t count = m_Nodes.size();
+    m_SubtreeSizes.assign(count, 1);
+    for (size_t i = count; i-- > 1;) m_SubtreeSizes[m_Parents[i]] += m_SubtreeSizes[i];
+
+    m_LocalTransforms.assign(count, mat4f(1.0f));
+    m_WorldTransforms.assign(count, mat4f(1.0f));
+    m_Pending.assign(count, false);
+    m_ChangedNodes.clear();
+    for (auto node : m_Nodes) node->m_Dirty = true;
+
+    m_Spine.clear();
+    m_Ranges.clear();
+    for (size_t i = 0; i < count;) {
+        if (m_SubtreeSizes[i] > subtreeGrain) {
+            m_Spine.emplace_back(i++);
+            continue;
+        }
+        const size_t end = i + m_SubtreeSizes[i];
+        if (!m_Ranges.empty() && m_Ranges.back().second == i && end - m_Ranges.back().first <= subtreeGrain)
+            m_Ranges.back().second = end;
+        else
+            m_Ranges.emplace_back(i, end);
+        i = end;
+    }
+}
+
+// The parents of the spine are in the spine, and the parents of the ranges are in the spine or in the
+// same range, so the spine is propagated in order first and then the ranges are independent.
+template <typename Func>
+void TransformHierarchy::Schedule(Func&& func) {
+    for (auto index : m_Spine) func(index, index + 1);
+    g_ThreadManager->ParallelFor(0, m_Ranges.size(), [&](size_t i) { func(m_Ranges[i].first, m_Ranges[i].second); });
+}
+
+// A node is calculated if it is pending or its parent is, then it is pending until the changes are collected
+void TransformHierarchy::PropagateRange(size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++) {
+        const size_t parent = m_Parents[i];
+        if (parent == nullIndex) {
+            if (m_Pending[i]) m_WorldTransforms[i] = m_LocalTransforms[i];
+        } else if (m_Pending[i] || m_Pending[parent]) {
+            m_Pending[i]         = true;
+            m_WorldTransforms[i] = m_WorldTransforms[parent] * m_LocalTransforms[i];
+        }
+    }
+}
+
+void TransformHierarchy::CollectChanges() {
+    m_ChangedNodes.clear();
+    for (size_t i = 0; i < m_Pending.size(); i++) {
+        if (!m_Pending[i]) continue;
+        m_ChangedNodes.emplace_back(i);
+        m_Pending[i] = false;
+    }
+}
+
+void TransformHierarchy::Update() {
+    m_Version++;
+    Schedule([this](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            if (!m_Nodes[i]->m_Dirty) continue;
+            m_LocalTransforms[i] = m_Nodes[i]->GetCalculatedTransform();
+            m_Pending[i]         = true;
+            m_Nodes[i]->m_Dirty  = false;
+        }
+        PropagateRange(begin, end);
+        for (size_t i = begin; i < end; i++) {
+            if (!m_Pending[i]) continue;
+            m_Nodes[i]->m_WorldTransform   = m_WorldTransforms[i];
+            m_Nodes[i]->m_TransformVersion = m_Version;
+        }
+    });
+    CollectChanges();
+}
+
+void TransformHierarchy::Propagate() {
+    m_Version++;
+    Schedule([this](size_t begin, size_t end) { PropagateRange(begin, end); });
+    CollectChanges();
+}
+
+}  // namespace Hitagi::Asset
@@ -0,0 +1,68 @@
+#pragma once
+#include "SceneNode.hpp"
+
+#include <limits>
+
+namespace Hitagi::Asset {
+
+// A flat copy of the transforms of a scene graph. The nodes are stored in depth-first order, so a parent
+// is always before its children and the nodes of a subtree are a contiguous range. The world transforms
+// are propagated in one linear pass over the arrays, and the small subtrees are propagated on the thread pool.
+// Only the dirty nodes and their descendants are calculated, and they are listed in GetChangedNodes.
+class TransformHierarchy {
+public:
+    static constexpr size_t nullIndex = std::numeric_limits<size_t>::max();
+    // The subtrees up to this size are propagated as one task, the nodes above them on the calling thread
+    static constexpr size_t subtreeGrain = 1024;
+
+    TransformHierarchy() = default;
+    explicit TransformHierarchy(BaseSceneNode& root) { Build(root); }
+
+    // Flatten the graph under root, it must be built again after the graph changes. All the nodes are dirty.
+    void Build(BaseSceneNode& root);
+    // Read the local transforms of the dirty nodes, then calculate the world transforms of them and their
+    // descendants and write them back with the new version
+    void Update();
+    // Calculate the world transforms from the local transforms set since the last update in the arrays only
+    void Propagate();
+
+    size_t         Size() const noexcept { return m_Nodes.size(); }
+    bool           Empty() const noexcept { return m_Nodes.empty(); }
+    BaseSceneNode* GetNode(size_t index) const { return m_Nodes[index]; }
+    size_t         GetParent(size_t index) const { return m_Parents[index]; }
+    size_t         GetSubtreeSize(size_t index) const { return m_SubtreeSizes[index]; }
+    const mat4f&   GetLocalTransform(size_t index) const { return m_LocalTransforms[index]; }
+    const mat4f&   GetWorldTransform(size_t index) const { return m_WorldTransforms[index]; }
+    void           SetLocalTransform(size_t index, const mat4f& transform) {
+        m_LocalTransforms[index] = transform;
+        m_Pending[index]         = true;
+    }
+
+    // Increased by every update
+    uint64_t GetVersion() const noexcept { return m_Version; }
+    // The indices of the nodes whose world transform changed in the last update, in depth-first order
+    const std::vector<size_t>& GetChangedNodes() const noexcept { return m_ChangedNodes; }
+
+private:
+    template <typename Func>
+    void Schedule(Func&& func);
+    void PropagateRange(size_t begin, size_t end);
+    void CollectChanges();
+
+    std::vector<BaseSceneNode*> m_Nodes;
+    std::vector<size_t>         m_Parents;
+    std::vector<size_t>         m_SubtreeSizes;
+    std::vector<mat4f>          m_LocalTransforms;
+    std::vector<mat4f>          m_WorldTransforms;
+    // Not vector<bool>, so the ranges can be written in parallel
+    std::vector<uint8_t>        m_Pending;
+    std::vector<size_t>         m_ChangedNodes;
+    uint64_t                    m_Version = 0;
+
+    // The nodes of the subtrees larger than subtreeGrain, and the ranges of the smaller subtrees below them.
+    // The adjacent small subtrees are merged into one range up to subtreeGrain nodes.
+    std::vector<size_t>                    m_Spine;
+    std::vector<std::pair<size_t, size_t>> m_Ranges;
+};
+
+}  // namespace Hitagi::Asset
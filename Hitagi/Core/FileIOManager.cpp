@@ -31,28 +31,51 @@ bool FileIOManager::IsFileChanged(const std::filesystem::path& filePath) const {
     return m_FileStateCache.at(hash) < std::filesystem::last_write_time(filePath);
 }
 
-const Buffer& FileIOManager::SyncOpenAndReadBinary(const std::filesystem::path& filePath) {
+std::shared_ptr<const Buffer> FileIOManager::SyncOpenAndReadBinary(const std::filesystem::path& filePath) {
     if (!std::filesystem::exists(filePath)) {
         m_Logger->warn("File dose not exist. {}", filePath);
         return m_EmptyBuffer;
     }
-    if (!IsFileChanged(filePath)) {
-        m_Logger->debug("Use cahce: {}", filePath.filename());
-        return m_FileCache.at(std::filesystem::hash_value(filePath));
+    {
+        std::lock_guard lock(m_CacheMutex);
+        if (!IsFileChanged(filePath)) {
+            m_Logger->debug("Use cahce: {}", filePath.filename());
+            return m_FileCache.at(std::filesystem::hash_value(filePath));
+        }
     }
     auto fileSize = std::filesystem::file_size(filePath);
     m_Logger->info("Open file: {} ({} bytes)", filePath, fileSize);
-    Buffer        buffer(fileSize);
+    auto          buffer = std::make_shared<Buffer>(fileSize);
     std::ifstream ifs(filePath, std::ios::binary);
-    ifs.read(reinterpret_cast<char*>(buffer.GetData()), buffer.GetDataSize());
+    ifs.read(reinterpret_cast<char*>(buffer->GetData()), buffer->GetDataSize());
     ifs.close();
 
-    // store cache
-    PathHash hash          = std::filesystem::hash_value(filePath);
+    // store cache, the buffer replaced here is released by its last reader
+    std::lock_guard lock(m_CacheMutex);
+    PathHash        hash   = std::filesystem::hash_value(filePath);
     m_FileStateCache[hash] = std::filesystem::last_write_time(filePath);
-    m_FileCache[hash]      = std::move(buffer);
+    m_FileCache[hash]      = buffer;
 
-    return m_FileCache[hash];
+    return buffer;
+}
+
+bool FileIOManager::SaveBuffer(const Buffer& buffer, const std::filesystem::path& filePath) {
+    std::error_code ec;
+    if (filePath.has_parent_path()) std::filesystem::create_directories(filePath.parent_path(), ec);
+
+    std::ofstream ofs(filePath, std::ios::binary);
+    if (!ofs) {
+        m_Logger->error("Can not open file: {}", filePath);
+        return false;
+    }
+    ofs.write(reinterpret_cast<const char*>(buffer.GetData()), buffer.GetDataSize());
+    ofs.close();
+    m_Logger->info("Save file: {} ({} bytes)", filePath, buffer.GetDataSize());
+
+    // the file may be rewritten within the resolution of the write time
+    std::lock_guard lock(m_CacheMutex);
+    m_FileStateCache.erase(std::filesystem::hash_value(filePath));
+    return !ofs.fail();
 }
 
 }  // namespace Hitagi::Core
\ No newline at end of file
@@ -1,6 +1,8 @@
 #pragma once
 #include <filesystem>
 #include <unordered_map>
+#include <memory>
+#include <mutex>
 
 #include "IRuntimeModule.hpp"
 #include "Buffer.hpp"
@@ -13,15 +15,20 @@ public:
     void Finalize() final;
     void Tick() final;
 
-    const Buffer& SyncOpenAndReadBinary(const std::filesystem::path& filePath);
+    // It is thread safe, the file is read out of the lock of the cache. The buffer is shared with the cache,
+    // and stays valid for the caller when the cached one is replaced by a newer content of the file.
+    std::shared_ptr<const Buffer> SyncOpenAndReadBinary(const std::filesystem::path& filePath);
+    // Write the buffer to the file, the parent directories are created if needed
+    bool SaveBuffer(const Buffer& buffer, const std::filesystem::path& filePath);
 
 private:
     bool IsFileChanged(const std::filesystem::path& filePath) const;
 
     using PathHash = size_t;
     std::unordered_map<PathHash, std::filesystem::file_time_type> m_FileStateCache;
-    std::unordered_map<PathHash, Buffer>                          m_FileCache;
-    Buffer                                                        m_EmptyBuffer;
+    std::unordered_map<PathHash, std::shared_ptr<const Buffer>>   m_FileCache;
+    std::shared_ptr<const Buffer>                                 m_EmptyBuffer = std::make_shared<const Buffer>();
+    std::mutex                                                    m_CacheMutex;
 };
 
 }  // namespace Hitagi::Core
@@ -0,0 +1,68 @@
+#pragma once
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <vector>
+
+namespace Hitagi::Core {
+
+// A reference to an object in a HandlePool of T. The slot of the object records a generation that is
+// increased when the object is removed, so a handle is validated by comparing the generations in O(1),
+// without the reference counting of weak_ptr.
+template <typename T>
+struct Handle {
+    static constexpr uint32_t nullIndex = std::numeric_limits<uint32_t>::max();
+
+    uint32_t index      = nullIndex;
+    uint32_t generation = 0;
+
+    bool IsNull() const noexcept { return index == nullIndex; }
+    bool operator==(const Handle&) const = default;
+};
+
+// The pool owns its objects, the removed slots are reused with a new generation
+template <typename T>
+class HandlePool {
+public:
+    Handle<T> Add(std::shared_ptr<T> object) {
+        if (!m_FreeIndices.empty()) {
+            const uint32_t index = m_FreeIndices.back();
+            m_FreeIndices.pop_back();
+            m_Slots[index].object = std::move(object);
+            return {index, m_Slots[index].generation};
+        }
+        m_Slots.emplace_back(Slot{std::move(object), 0});
+        return {static_cast<uint32_t>(m_Slots.size() - 1), 0};
+    }
+
+    void Remove(Handle<T> handle) {
+        if (!Valid(handle)) return;
+        m_Slots[handle.index].object = nullptr;
+        m_Slots[handle.index].generation++;
+        m_FreeIndices.emplace_back(handle.index);
+    }
+
+    bool Valid(Handle<T> handle) const noexcept {
+        return handle.index < m_Slots.size() && m_Slots[handle.index].generation == handle.generation && m_Slots[handle.index].object;
+    }
+    // Return nullptr if the handle is null or the object is removed
+    T* Get(Handle<T> handle) const noexcept { return Valid(handle) ? m_Slots[handle.index].object.get() : nullptr; }
+
+    // Remove all the objects, the handles of them are invalid
+    void Clear() {
+        for (uint32_t index = 0; index < m_Slots.size(); index++)
+            Remove({index, m_Slots[index].generation});
+    }
+
+    size_t Size() const noexcept { return m_Slots.size() - m_FreeIndices.size(); }
+
+private:
+    struct Slot {
+        std::shared_ptr<T> object;
+        uint32_t           generation;
+    };
+    std::vector<Slot>     m_Slots;
+    std::vector<uint32_t> m_FreeIndices;
+};
+
+}  // namespace Hitagi::Core
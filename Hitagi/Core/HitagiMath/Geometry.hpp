@@ -1,5 +1,11 @@
 #pragma once
-#include "Vector.hpp"
+#include "HitagiMath.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+#include <optional>
+#include <span>
 
 namespace Hitagi {
 struct Geometry {};
@@ -30,9 +36,16 @@ struct Squrae : public Geometry {
     float length, width;
 };
 
+// Axis aligned bounding box. A default constructed box is empty (min > max),
+// so it can be used as the initial value of a merge.
 struct Box : public Geometry {
+    Box() : bbMin(std::numeric_limits<float>::max()), bbMax(std::numeric_limits<float>::lowest()) {}
     Box(const vec3f& bbMin, const vec3f& bbMax) : bbMin(bbMin), bbMax(bbMax) {}
     vec3f bbMin, bbMax;
+
+    bool  Empty() const noexcept { return bbMin.x > bbMax.x || bbMin.y > bbMax.y || bbMin.z > bbMax.z; }
+    vec3f Center() const noexcept { return 0.5f * (bbMin + bbMax); }
+    vec3f Extent() const noexcept { return 0.5f * (bbMax - bbMin); }
 };
 
 struct Circle : public Geometry {
@@ -47,4 +60,437 @@ struct Sphere : public Geometry {
     float radius;
 };
 
+// Oriented bounding box, the axes are orthonormal.
+struct OBB : public Geometry {
+    OBB(const vec3f& center, const std::array<vec3f, 3>& axes, const vec3f& halfExtent)
+        : center(center), axes(axes), halfExtent(halfExtent) {}
+    // Build from a local box and its (affine) transform.
+    OBB(const Box& box, const mat4f& trans) : center(0.0f), axes{vec3f(0.0f), vec3f(0.0f), vec3f(0.0f)}, halfExtent(box.Extent()) {
+        center = (trans * vec4f(box.Center(), 1.0f)).xyz;
+        for (unsigned i = 0; i < 3; i++) {
+            vec3f axis(trans[0][i], trans[1][i], trans[2][i]);
+            float length = axis.norm();
+            axes[i]      = length > 0 ? axis / length : vec3f(0.0f);
+            halfExtent[i] *= length;
+        }
+    }
+    vec3f                center;
+    std::array<vec3f, 3> axes;
+    vec3f                halfExtent;
+};
+
+struct Ray : public Geometry {
+    Ray(const vec3f& origin, const vec3f& direction) : origin(origin), direction(direction) {}
+    vec3f origin, direction;
+
+    vec3f At(float t) const noexcept { return origin + t * direction; }
+};
+
+// The six planes are stored as (normal, distance) with normals pointing
+// inward, in the order left, right, bottom, top, near, far.
+struct Frustum : public Geometry {
+    // Extract the planes from a projection * view matrix (Gribb-Hartmann).
+    Frustum(const mat4f& projView) {
+        for (unsigned i = 0; i < 3; i++) {
+            planes[2 * i]     = projView[3] + projView[i];
+            planes[2 * i + 1] = projView[3] - projView[i];
+        }
+        for (auto&& plane : planes) {
+            float length = vec3f(plane.xyz).norm();
+            if (length > 0) plane /= length;
+        }
+    }
+    std::array<vec4f, 6> planes;
+};
+
+static_assert(sizeof(Box) == 6 * sizeof(float), "Box must be tightly packed for batch kernels.");
+static_assert(sizeof(Sphere) == 4 * sizeof(float), "Sphere must be tightly packed for batch kernels.");
+static_assert(sizeof(Frustum) == 24 * sizeof(float), "Frustum must be tightly packed for batch kernels.");
+
+enum struct ContainmentType {
+    Disjoint,
+    Intersects,
+    Contains
+};
+
+//---------------------------------------------------------------
+// Distance and closest point
+//---------------------------------------------------------------
+inline float Distance(const Plane& plane, const vec3f& point) {
+    return dot(normalize(plane.normal), point - plane.position);
+}
+
+inline vec3f ClosestPoint(const Plane& plane, const vec3f& point) {
+    auto normal = normalize(plane.normal);
+    return point - dot(normal, point - plane.position) * normal;
+}
+
+inline vec3f ClosestPoint(const Line& line, const vec3f& point) {
+    vec3f ab     = line.to - line.from;
+    float length = dot(ab, ab);
+    if (length == 0) return line.from;
+    float t = std::clamp(dot(point - line.from, ab) / length, 0.0f, 1.0f);
+    return line.from + t * ab;
+}
+
+inline vec3f ClosestPoint(const Box& box, const vec3f& point) {
+    return Min(Max(point, box.bbMin), box.bbMax);
+}
+
+inline vec3f ClosestPoint(const Sphere& sphere, const vec3f& point) {
+    vec3f d      = point - sphere.position;
+    float length = d.norm();
+    if (length <= sphere.radius) return point;
+    return sphere.position + (sphere.radius / length) * d;
+}
+
+inline vec3f ClosestPoint(const OBB& obb, const vec3f& point) {
+    vec3f d      = point - obb.center;
+    vec3f result = obb.center;
+    for (unsigned i = 0; i < 3; i++) {
+        float dist = std::clamp(dot(d, obb.axes[i]), -obb.halfExtent[i], obb.halfExtent[i]);
+        result += dist * obb.axes[i];
+    }
+    return result;
+}
+
+// Real-Time Collision Detection, 5.1.5
+inline vec3f ClosestPoint(const Triangle& triangle, const vec3f& point) {
+    const auto& [a, b, c] = triangle.points;
+
+    vec3f ab = b - a, ac = c - a, ap = point - a;
+    float d1 = dot(ab, ap), d2 = dot(ac, ap);
+    if (d1 <= 0 && d2 <= 0) return a;
+
+    vec3f bp = point - b;
+    float d3 = dot(ab, bp), d4 = dot(ac, bp);
+    if (d3 >= 0 && d4 <= d3) return b;
+
+    float vc = d1 * d4 - d3 * d2;
+    if (vc <= 0 && d1 >= 0 && d3 <= 0) return a + (d1 / (d1 - d3)) * ab;
+
+    vec3f cp = point - c;
+    float d5 = dot(ab, cp), d6 = dot(ac, cp);
+    if (d6 >= 0 && d5 <= d6) return c;
+
+    float vb = d5 * d2 - d1 * d6;
+    if (vb <= 0 && d2 >= 0 && d6 <= 0) return a + (d2 / (d2 - d6)) * ac;
+
+    float va = d3 * d6 - d5 * d4;
+    if (va <= 0 && (d4 - d3) >= 0 && (d5 - d6) >= 0) return b + ((d4 - d3) / ((d4 - d3) + (d5 - d6))) * (c - b);
+
+    float denom = 1.0f / (va + vb + vc);
+    return a + (vb * denom) * ab + (vc * denom) * ac;
+}
+
+//---------------------------------------------------------------
+// Merge and transform
+//---------------------------------------------------------------
+inline Box Merge(const Box& box, const vec3f& point) {
+    return Box(Min(box.bbMin, point), Max(box.bbMax, point));
+}
+
+inline Box Merge(const Box& lhs, const Box& rhs) {
+    return Box(Min(lhs.bbMin, rhs.bbMin), Max(lhs.bbMax, rhs.bbMax));
+}
+
+inline Sphere Merge(const Sphere& lhs, const Sphere& rhs) {
+    vec3f d    = rhs.position - lhs.position;
+    float dist = d.norm();
+    if (dist + rhs.radius <= lhs.radius) return lhs;
+    if (dist + lhs.radius <= rhs.radius) return rhs;
+    float radius = 0.5f * (dist + lhs.radius + rhs.radius);
+    return Sphere(lhs.position + ((radius - lhs.radius) / dist) * d, radius);
+}
+
+// Transform an AABB by an affine matrix and return the AABB of the result (Arvo's method).
+inline Box Transform(const Box& box, const mat4f& trans) {
+    if (box.Empty()) return box;
+    vec3f center = box.Center(), extent = box.Extent();
+    vec3f newCenter(0.0f), newExtent(0.0f);
+    for (unsigned row = 0; row < 3; row++) {
+        newCenter[row] = trans[row][3];
+        for (unsigned col = 0; col < 3; col++) {
+            newCenter[row] += trans[row][col] * center[col];
+            newExtent[row] += std::abs(trans[row][col]) * extent[col];
+        }
+    }
+    return Box(newCenter - newExtent, newCenter + newExtent);
+}
+
+inline Sphere Transform(const Sphere& sphere, const mat4f& trans) {
+    float scale = 0;
+    for (unsigned col = 0; col < 3; col++)
+        scale = std::max(scale, vec3f(trans[0][col], trans[1][col], trans[2][col]).norm());
+    return Sphere((trans * vec4f(sphere.position, 1.0f)).xyz, sphere.radius * scale);
+}
+
+//---------------------------------------------------------------
+// Containment
+//---------------------------------------------------------------
+inline bool Contains(const Box& box, const vec3f& point) {
+    return point.x >= box.bbMin.x && point.x <= box.bbMax.x &&
+           point.y >= box.bbMin.y && point.y <= box.bbMax.y &&
+           point.z >= box.bbMin.z && point.z <= box.bbMax.z;
+}
+
+inline bool Contains(const Box& box, const Box& other) {
+    return Contains(box, other.bbMin) && Contains(box, other.bbMax);
+}
+
+inline bool Contains(const Sphere& sphere, const vec3f& point) {
+    vec3f d = point - sphere.position;
+    return dot(d, d) <= sphere.radius * sphere.radius;
+}
+
+inline bool Contains(const Frustum& frustum, const vec3f& point) {
+    for (auto&& plane : frustum.planes)
+        if (dot(vec3f(plane.xyz), point) + plane.w < 0) return false;
+    return true;
+}
+
+inline ContainmentType Classify(const Frustum& frustum, const Box& box) {
+    auto result = ContainmentType::Contains;
+    for (auto&& plane : frustum.planes) {
+        vec3f normal = plane.xyz;
+        // the vertex farthest along the normal and its opposite
+        vec3f positive(normal.x >= 0 ? box.bbMax.x : box.bbMin.x,
+                       normal.y >= 0 ? box.bbMax.y : box.bbMin.y,
+                       normal.z >= 0 ? box.bbMax.z : box.bbMin.z);
+        vec3f negative(normal.x >= 0 ? box.bbMin.x : box.bbMax.x,
+                       normal.y >= 0 ? box.bbMin.y : box.bbMax.y,
+                       normal.z >= 0 ? box.bbMin.z : box.bbMax.z);
+        if (dot(normal, positive) + plane.w < 0) return ContainmentType::Disjoint;
+        if (dot(normal, negative) + plane.w < 0) result = ContainmentType::Intersects;
+    }
+    return result;
+}
+
+inline ContainmentType Classify(const Frustum& frustum, const Sphere& sphere) {
+    auto result = ContainmentType::Contains;
+    for (auto&& plane : frustum.planes) {
+        float dist = dot(vec3f(plane.xyz), sphere.position) + plane.w;
+        if (dist < -sphere.radius) return ContainmentType::Disjoint;
+        if (dist < sphere.radius) result = ContainmentType::Intersects;
+    }
+    return result;
+}
+
+//---------------------------------------------------------------
+// Intersection
+//---------------------------------------------------------------
+inline bool Intersect(const Box& lhs, const Box& rhs) {
+    return lhs.bbMin.x <= rhs.bbMax.x && lhs.bbMax.x >= rhs.bbMin.x &&
+           lhs.bbMin.y <= rhs.bbMax.y && lhs.bbMax.y >= rhs.bbMin.y &&
+           lhs.bbMin.z <= rhs.bbMax.z && lhs.bbMax.z >= rhs.bbMin.z;
+}
+
+inline bool Intersect(const Sphere& lhs, const Sphere& rhs) {
+    vec3f d = rhs.position - lhs.position;
+    float r = lhs.radius + rhs.radius;
+    return dot(d, d) <= r * r;
+}
+
+inline bool Intersect(const Box& box, const Sphere& sphere) {
+    vec3f d = ClosestPoint(box, sphere.position) - sphere.position;
+    return dot(d, d) <= sphere.radius * sphere.radius;
+}
+
+inline bool Intersect(const OBB& obb, const Sphere& sphere) {
+    vec3f d = ClosestPoint(obb, sphere.position) - sphere.position;
+    return dot(d, d) <= sphere.radius * sphere.radius;
+}
+
+// Separating axis test, Real-Time Collision Detection, 4.4.1
+inline bool Intersect(const OBB& a, const OBB& b) {
+    constexpr float epsilon = 1e-6f;
+
+    mat3f rotation, absRotation;
+    for (unsigned i = 0; i < 3; i++)
+        for (unsigned j = 0; j < 3; j++) {
+            rotation[i][j]    = dot(a.axes[i], b.axes[j]);
+            absRotation[i][j] = std::abs(rotation[i][j]) + epsilon;
+        }
+
+    vec3f d = b.center - a.center;
+    vec3f t(dot(d, a.axes[0]), dot(d, a.axes[1]), dot(d, a.axes[2]));
+
+    float ra, rb;
+    for (unsigned i = 0; i < 3; i++) {
+        ra = a.halfExtent[i];
+        rb = b.halfExtent[0] * absRotation[i][0] + b.halfExtent[1] * absRotation[i][1] + b.halfExtent[2] * absRotation[i][2];
+        if (std::abs(t[i]) > ra + rb) return false;
+    }
+    for (unsigned i = 0; i < 3; i++) {
+        ra = a.halfExtent[0] * absRotation[0][i] + a.halfExtent[1] * absRotation[1][i] + a.halfExtent[2] * absRotation[2][i];
+        rb = b.halfExtent[i];
+        if (std::abs(t[0] * rotation[0][i] + t[1] * rotation[1][i] + t[2] * rotation[2][i]) > ra + rb) return false;
+    }
+    // cross product axes a[i] x b[j]
+    for (unsigned i = 0; i < 3; i++) {
+        unsigned i1 = (i + 1) % 3, i2 = (i + 2) % 3;
+        for (unsigned j = 0; j < 3; j++) {
+            unsigned j1 = (j + 1) % 3, j2 = (j + 2) % 3;
+            ra = a.halfExtent[i1] * absRotation[i2][j] + a.halfExtent[i2] * absRotation[i1][j];
+            rb = b.halfExtent[j1] * absRotation[i][j2] + b.halfExtent[j2] * absRotation[i][j1];
+            if (std::abs(t[i2] * rotation[i1][j] - t[i1] * rotation[i2][j]) > ra + rb) return false;
+        }
+    }
+    return true;
+}
+
+inline bool Intersect(const Frustum& frustum, const Box& box) {
+    return Classify(frustum, box) != ContainmentType::Disjoint;
+}
+
+inline bool Intersect(const Frustum& frustum, const Sphere& sphere) {
+    return Classify(frustum, sphere) != ContainmentType::Disjoint;
+}
+
+// Return the ray parameter of the nearest hit, the ray is treated as a half line.
+inline std::optional<float> Intersect(const Ray& ray, const Box& box) {
+    float tMin = 0, tMax = std::numeric_limits<float>::max();
+    for (unsigned i = 0; i < 3; i++) {
+        if (std::abs(ray.direction[i]) < std::numeric_limits<float>::epsilon()) {
+            if (ray.origin[i] < box.bbMin[i] || ray.origin[i] > box.bbMax[i]) return std::nullopt;
+            continue;
+        }
+        float invD = 1.0f / ray.direction[i];
+        float t1   = (box.bbMin[i] - ray.origin[i]) * invD;
+        float t2   = (box.bbMax[i] - ray.origin[i]) * invD;
+        if (t1 > t2) std::swap(t1, t2);
+        tMin = std::max(tMin, t1);
+        tMax = std::min(tMax, t2);
+        if (tMin > tMax) return std::nullopt;
+    }
+    return tMin;
+}
+
+inline std::optional<float> Intersect(const Ray& ray, const Sphere& sphere) {
+    vec3f m = ray.origin - sphere.position;
+    float a = dot(ray.direction, ray.direction);
+    float b = dot(m, ray.direction);
+    float c = dot(m, m) - sphere.radius * sphere.radius;
+    if (a == 0 || (c > 0 && b > 0)) return std::nullopt;
+    float discr = b * b - a * c;
+    if (discr < 0) return std::nullopt;
+    return std::max(0.0f, (-b - std::sqrt(discr)) / a);
+}
+
+inline std::optional<float> Intersect(const Ray& ray, const Plane& plane) {
+    float denom = dot(plane.normal, ray.direction);
+    if (std::abs(denom) < std::numeric_limits<float>::epsilon()) return std::nullopt;
+    float t = dot(plane.normal, plane.position - ray.origin) / denom;
+    if (t < 0) return std::nullopt;
+    return t;
+}
+
+// Moller-Trumbore
+inline std::optional<float> Intersect(const Ray& ray, const Triangle& triangle) {
+    const auto& [a, b, c] = triangle.points;
+
+    vec3f e1 = b - a, e2 = c - a;
+    vec3f p   = cross(ray.direction, e2);
+    float det = dot(e1, p);
+    if (std::abs(det) < std::numeric_limits<float>::epsilon()) return std::nullopt;
+    float invDet = 1.0f / det;
+
+    vec3f s = ray.origin - a;
+    float u = dot(s, p) * invDet;
+    if (u < 0 || u > 1) return std::nullopt;
+
+    vec3f q = cross(s, e1);
+    float v = dot(ray.direction, q) * invDet;
+    if (v < 0 || u + v > 1) return std::nullopt;
+
+    float t = dot(e2, q) * invDet;
+    if (t < 0) return std::nullopt;
+    return t;
+}
+
+//---------------------------------------------------------------
+// Batch kernels
+// The results are written as 0/1 bytes, missing rays are written as infinity.
+//---------------------------------------------------------------
+inline Box BoundingBox(std::span<const vec3f> points) {
+    Box result;
+    if (points.empty()) return result;
+#if defined(USE_ISPC)
+    if (ispc::IsSupported()) {
+        ispc::bounding_box(reinterpret_cast<const float*>(points.data()), result.bbMin, result.bbMax, points.size());
+        return result;
+    }
+#endif  // USE_ISPC
+    for (auto&& point : points) result = Merge(result, point);
+    return result;
+}
+
+inline void Intersect(const Frustum& frustum, std::span<const Box> boxes, std::span<uint8_t> result) {
+    assert(result.size() >= boxes.size());
+#if defined(USE_ISPC)
+    if (ispc::IsSupported()) {
+        ispc::frustum_intersect_boxes(reinterpret_cast<const float*>(frustum.planes.data()), reinterpret_cast<const float*>(boxes.data()), result.data(), boxes.size());
+        return;
+    }
+#endif  // USE_ISPC
+    for (size_t i = 0; i < boxes.size(); i++) result[i] = Intersect(frustum, boxes[i]);
+}
+
+inline void Intersect(const Frustum& frustum, std::span<const Sphere> spheres, std::span<uint8_t> result) {
+    assert(result.size() >= spheres.size());
+#if defined(USE_ISPC)
+    if (ispc::IsSupported()) {
+        ispc::frustum_intersect_spheres(reinterpret_cast<const float*>(frustum.planes.data()), reinterpret_cast<const float*>(spheres.data()), result.data(), spheres.size());
+        return;
+    }
+#endif  // USE_ISPC
+    for (size_t i = 0; i < spheres.size(); i++) result[i] = Intersect(frustum, spheres[i]);
+}
+
+inline void Intersect(const Box& box, std::span<const Box> boxes, std::span<uint8_t> result) {
+    assert(result.size() >= boxes.size());
+#if defined(USE_ISPC)
+    if (ispc::IsSupported()) {
+        ispc::box_intersect_boxes(box.bbMin, box.bbMax, reinterpret_cast<const float*>(boxes.data()), result.data(), boxes.size());
+        return;
+    }
+#endif  // USE_ISPC
+    for (size_t i = 0; i < boxes.size(); i++) result[i] = Intersect(box, boxes[i]);
+}
+
+inline void Intersect(const Sphere& sphere, std::span<const Box> boxes, std::span<uint8_t> result) {
+    assert(result.size() >= boxes.size());
+#if defined(USE_ISPC)
+    if (ispc::IsSupported()) {
+        ispc::sphere_intersect_boxes(sphere.position, sphere.radius, reinterpret_cast<const float*>(boxes.data()), result.data(), boxes.size());
+        return;
+    }
+#endif  // USE_ISPC
+    for (size_t i = 0; i < boxes.size(); i++) result[i] = Intersect(boxes[i], sphere);
+}
+
+inline void Intersect(const Ray& ray, std::span<const Box> boxes, std::span<float> result) {
+    assert(result.size() >= boxes.size());
+#if defined(USE_ISPC)
+    if (ispc::IsSupported()) {
+        ispc::ray_intersect_boxes(ray.origin, ray.direction, reinterpret_cast<const float*>(boxes.data()), result.data(), boxes.size());
+        return;
+    }
+#endif  // USE_ISPC
+    for (size_t i = 0; i < boxes.size(); i++)
+        result[i] = Intersect(ray, boxes[i]).value_or(std::numeric_limits<float>::infinity());
+}
+
+// Transform each box by its own matrix
+inline void Transform(std::span<const Box> boxes, std::span<const mat4f> transforms, std::span<Box> result) {
+    assert(transforms.size() >= boxes.size() && result.size() >= boxes.size());
+#if defined(USE_ISPC)
+    if (ispc::IsSupported()) {
+        ispc::transform_boxes(reinterpret_cast<const float*>(boxes.data()), reinterpret_cast<const float*>(transforms.data()), reinterpret_cast<float*>(result.data()), boxes.size());
+        return;
+    }
+#endif  // USE_ISPC
+    for (size_t i = 0; i < boxes.size(); i++) result[i] = Transform(boxes[i], transforms[i]);
+}
+
 }  // namespace Hitagi
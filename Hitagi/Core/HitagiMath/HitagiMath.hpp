@@ -1,7 +1,6 @@
 #pragma once
 #include "./Vector.hpp"
 #include "./Matrix.hpp"
-#include "./Geometry.hpp"
 
 #include <numbers>
 
@@ -379,4 +378,6 @@ inline size_t align(size_t x, size_t a) {
     return (x + a - 1) & ~(a - 1);
 }
 
-}  // namespace Hitagi
\ No newline at end of file
+}  // namespace Hitagi
+#include "./Geometry.hpp"
+#include "./Packing.hpp"
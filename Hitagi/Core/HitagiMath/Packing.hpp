@@ -0,0 +1,232 @@
+#pragma once
+#include "HitagiMath.hpp"
+
+#include <bit>
+#include <span>
+
+// Compact vertex attribute encodings: half floats, unorm8/unorm16 and octahedral unit vectors.
+namespace Hitagi {
+
+using half_t = uint16_t;
+
+inline half_t FloatToHalf(float value) {
+    const uint32_t bits = std::bit_cast<uint32_t>(value);
+    const uint32_t sign = (bits >> 16) & 0x8000;
+    const uint32_t abs  = bits & 0x7fffffff;
+
+    // NaN and Inf
+    if (abs >= 0x7f800000) return sign | 0x7c00 | (abs > 0x7f800000 ? 0x200 : 0);
+    // overflow
+    if (abs >= 0x477ff000) return sign | 0x7c00;
+    // denormal half
+    if (abs < 0x38800000) {
+        if (abs < 0x33000000) return sign;
+        const uint32_t mantissa = (abs & 0x007fffff) | 0x00800000;
+        const uint32_t shift    = 113 - (abs >> 23) + 13;
+        uint32_t       result   = mantissa >> shift;
+        // round to nearest even
+        const uint32_t rest = mantissa & ((1u << shift) - 1), half = 1u << (shift - 1);
+        if (rest > half || (rest == half && (result & 1))) result++;
+        return sign | result;
+    }
+    uint32_t result = abs - 0x38000000;
+    result += 0x0fff + ((result >> 13) & 1);
+    return sign | (result >> 13);
+}
+
+inline float HalfToFloat(half_t value) {
+    const uint32_t sign     = static_cast<uint32_t>(value & 0x8000) << 16;
+    const uint32_t exponent = (value >> 10) & 0x1f;
+    uint32_t       mantissa = value & 0x3ff;
+
+    if (exponent == 0x1f) return std::bit_cast<float>(sign | 0x7f800000 | (mantissa << 13));
+    if (exponent == 0) {
+        if (mantissa == 0) return std::bit_cast<float>(sign);
+        // normalize the denormal
+        int e = -1;
+        do {
+            e++;
+            mantissa <<= 1;
+        } while ((mantissa & 0x400) == 0);
+        return std::bit_cast<float>(sign | ((112 - e) << 23) | ((mantissa & 0x3ff) << 13));
+    }
+    return std::bit_cast<float>(sign | ((exponent + 112) << 23) | (mantissa << 13));
+}
+
+inline uint8_t PackUnorm8(float value) {
+    return static_cast<uint8_t>(std::clamp(value, 0.0f, 1.0f) * 255.0f + 0.5f);
+}
+inline float UnpackUnorm8(uint8_t value) { return value * (1.0f / 255.0f); }
+
+inline uint16_t PackUnorm16(float value) {
+    return static_cast<uint16_t>(std::clamp(value, 0.0f, 1.0f) * 65535.0f + 0.5f);
+}
+inline float UnpackUnorm16(uint16_t value) { return value * (1.0f / 65535.0f); }
+
+inline int16_t PackSnorm16(float value) {
+    value = std::clamp(value, -1.0f, 1.0f) * 32767.0f;
+    return static_cast<int16_t>(value >= 0 ? value + 0.5f : value - 0.5f);
+}
+inline float UnpackSnorm16(int16_t value) { return std::max(value * (1.0f / 32767.0f), -1.0f); }
+
+// Octahedral encoding of a unit vector (Cigolle et al. 2014), a degenerate vector is encoded as +Z
+inline Vector<int16_t, 2> OctEncode(const vec3f& v) {
+    auto sign = [](float x) { return x >= 0 ? 1.0f : -1.0f; };
+
+    const float l1 = std::abs(v.x) + std::abs(v.y) + std::abs(v.z);
+    // also true for NaN and infinity, which can not be converted to int16
+    if (!(l1 > 0.0f && l1 <= std::numeric_limits<float>::max())) return {0, 0};
+    const float invL1 = 1.0f / l1;
+    float       x = v.x * invL1, y = v.y * invL1;
+    if (v.z < 0) {
+        const float tx = (1.0f - std::abs(y)) * sign(x);
+        const float ty = (1.0f - std::abs(x)) * sign(y);
+        x              = tx;
+        y              = ty;
+    }
+    return {PackSnorm16(x), PackSnorm16(y)};
+}
+
+inline vec3f OctDecode(const Vector<int16_t, 2>& v) {
+    vec3f       result(UnpackSnorm16(v.x), UnpackSnorm16(v.y), 0.0f);
+    result.z      = 1.0f - std::abs(result.x) - std::abs(result.y);
+    const float t = std::max(-result.z, 0.0f);
+    result.x += result.x >= 0 ? -t : t;
+    result.y += result.y >= 0 ? -t : t;
+    return normalize(result);
+}
+
+// Tangent frame as {oct(tangent), bitangent sign, 0}, the bitangent is sign * cross(normal, tangent).
+inline Vector<int16_t, 4> EncodeTangentFrame(const vec3f& normal, const vec3f& tangent, const vec3f& bitangent) {
+    auto oct = OctEncode(tangent);
+    return {oct.x, oct.y, static_cast<int16_t>(dot(cross(normal, tangent), bitangent) < 0 ? -32767 : 32767), 0};
+}
+
+inline std::pair<vec3f, vec3f> DecodeTangentFrame(const vec3f& normal, const Vector<int16_t, 4>& frame) {
+    vec3f tangent = OctDecode(Vector<int16_t, 2>(frame.x, frame.y));
+    return {tangent, (frame.z < 0 ? -1.0f : 1.0f) * cross(normal, tangent)};
+}
+
+//---------------------------------------------------------------
+// Batch kernels, the spans of components are flat.
+//---------------------------------------------------------------
+inline void PackHalf(std::span<const float> in, std::span<half_t> out) {
+    assert(out.size() >= in.size());
+#if defined(USE_ISPC)
+    if (ispc::IsSupported()) {
+        ispc::float_to_half_array(in.data(), out.data(), in.size());
+        return;
+    }
+#endif  // USE_ISPC
+    for (size_t i = 0; i < in.size(); i++) out[i] = FloatToHalf(in[i]);
+}
+
+inline void UnpackHalf(std::span<const half_t> in, std::span<float> out) {
+    assert(out.size() >= in.size());
+#if defined(USE_ISPC)
+    if (ispc::IsSupported()) {
+        ispc::half_to_float_array(in.data(), out.data(), in.size());
+        return;
+    }
+#endif  // USE_ISPC
+    for (size_t i = 0; i < in.size(); i++) out[i] = HalfToFloat(in[i]);
+}
+
+inline void PackUnorm8(std::span<const float> in, std::span<uint8_t> out) {
+    assert(out.size() >= in.size());
+#if defined(USE_ISPC)
+    if (ispc::IsSupported()) {
+        ispc::float_to_unorm8_array(in.data(), out.data(), in.size());
+        return;
+    }
+#endif  // USE_ISPC
+    for (size_t i = 0; i < in.size(); i++) out[i] = PackUnorm8(in[i]);
+}
+
+inline void UnpackUnorm8(std::span<const uint8_t> in, std::span<float> out) {
+    assert(out.size() >= in.size());
+#if defined(USE_ISPC)
+    if (ispc::IsSupported()) {
+        ispc::unorm8_to_float_array(in.data(), out.data(), in.size());
+        return;
+    }
+#endif  // USE_ISPC
+    for (size_t i = 0; i < in.size(); i++) out[i] = UnpackUnorm8(in[i]);
+}
+
+inline void PackUnorm16(std::span<const float> in, std::span<uint16_t> out) {
+    assert(out.size() >= in.size());
+#if defined(USE_ISPC)
+    if (ispc::IsSupported()) {
+        ispc::float_to_unorm16_array(in.data(), out.data(), in.size());
+        return;
+    }
+#endif  // USE_ISPC
+    for (size_t i = 0; i < in.size(); i++) out[i] = PackUnorm16(in[i]);
+}
+
+inline void UnpackUnorm16(std::span<const uint16_t> in, std::span<float> out) {
+    assert(out.size() >= in.size());
+#if defined(USE_ISPC)
+    if (ispc::IsSupported()) {
+        ispc::unorm16_to_float_array(in.data(), out.data(), in.size());
+        return;
+    }
+#endif  // USE_ISPC
+    for (size_t i = 0; i < in.size(); i++) out[i] = UnpackUnorm16(in[i]);
+}
+
+inline void OctEncode(std::span<const vec3f> in, std::span<Vector<int16_t, 2>> out) {
+    assert(out.size() >= in.size());
+#if defined(USE_ISPC)
+    if (ispc::IsSupported()) {
+        ispc::oct_encode_array(reinterpret_cast<const float*>(in.data()), reinterpret_cast<int16_t*>(out.data()), in.size());
+        return;
+    }
+#endif  // USE_ISPC
+    for (size_t i = 0; i < in.size(); i++) out[i] = OctEncode(in[i]);
+}
+
+inline void OctDecode(std::span<const Vector<int16_t, 2>> in, std::span<vec3f> out) {
+    assert(out.size() >= in.size());
+#if defined(USE_ISPC)
+    if (ispc::IsSupported()) {
+        ispc::oct_decode_array(reinterpret_cast<const int16_t*>(in.data()), reinterpret_cast<float*>(out.data()), in.size());
+        return;
+    }
+#endif  // USE_ISPC
+    for (size_t i = 0; i < in.size(); i++) out[i] = OctDecode(in[i]);
+}
+
+inline void EncodeTangentFrame(std::span<const vec3f> normals, std::span<const vec3f> tangents, std::span<const vec3f> bitangents, std::span<Vector<int16_t, 4>> out) {
+    assert(tangents.size() >= normals.size() && bitangents.size() >= normals.size() && out.size() >= normals.size());
+#if defined(USE_ISPC)
+    if (ispc::IsSupported()) {
+        ispc::tangent_frame_encode_array(reinterpret_cast<const float*>(normals.data()),
+                                         reinterpret_cast<const float*>(tangents.data()),
+                                         reinterpret_cast<const float*>(bitangents.data()),
+                                         reinterpret_cast<int16_t*>(out.data()),
+                                         normals.size());
+        return;
+    }
+#endif  // USE_ISPC
+    for (size_t i = 0; i < normals.size(); i++) out[i] = EncodeTangentFrame(normals[i], tangents[i], bitangents[i]);
+}
+
+inline void DecodeTangentFrame(std::span<const vec3f> normals, std::span<const Vector<int16_t, 4>> in, std::span<vec3f> tangents, std::span<vec3f> bitangents) {
+    assert(in.size() >= normals.size() && tangents.size() >= normals.size() && bitangents.size() >= normals.size());
+#if defined(USE_ISPC)
+    if (ispc::IsSupported()) {
+        ispc::tangent_frame_decode_array(reinterpret_cast<const int16_t*>(in.data()),
+                                         reinterpret_cast<const float*>(normals.data()),
+                                         reinterpret_cast<float*>(tangents.data()),
+                                         reinterpret_cast<float*>(bitangents.data()),
+                                         normals.size());
+        return;
+    }
+#endif  // USE_ISPC
+    for (size_t i = 0; i < normals.size(); i++)
+        std::tie(tangents[i], bitangents[i]) = DecodeTangentFrame(normals[i], in[i]);
+}
+
+}  // namespace Hitagi
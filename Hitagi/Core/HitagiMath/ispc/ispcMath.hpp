@@ -1,6 +1,17 @@
 #pragma once
 #include "vector_ispc.h"
+#include "geometry_ispc.h"
+#include "packing_ispc.h"
+#include "pixel_ispc.h"
+#include "raster_ispc.h"
 #include <type_traits>
+#include <atomic>
+#include <cstdint>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#include <immintrin.h>
+#endif
 
 template <typename T>
 concept IspcSpeedable =
@@ -8,79 +19,244 @@ concept IspcSpeedable =
     std::is_same_v<T, double>;
 
 namespace ispc {
+// Instruction sets the kernels may be built for. When the kernels are built for several
+// targets the ispc dispatcher picks the best one itself, this is only used to decide whether
+// the kernels can run at all (ISPC_MIN_ISA) and for reporting.
+enum struct ISA : uint8_t {
+    Scalar = 0,
+    SSE4   = 1,
+    AVX2   = 2,
+    AVX512 = 3
+};
+
+inline ISA DetectISA() noexcept {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    int info[4];
+    __cpuid(info, 0);
+    const int maxLeaf = info[0];
+    __cpuid(info, 1);
+    const bool sse42 = info[2] & (1 << 20), osxsave = info[2] & (1 << 27), avx = info[2] & (1 << 28);
+    const bool fma = info[2] & (1 << 12), f16c = info[2] & (1 << 29);
+    if (!sse42) return ISA::Scalar;
+
+    const uint64_t xcr0 = osxsave ? _xgetbv(0) : 0;
+    if (!avx || (xcr0 & 0x6) != 0x6 || maxLeaf < 7) return ISA::SSE4;
+
+    __cpuidex(info, 7, 0);
+    const bool avx2 = info[1] & (1 << 5);
+    if (!avx2 || !fma || !f16c) return ISA::SSE4;
+
+    // avx512 f, dq, cd, bw, vl and the os saves zmm state
+    const int avx512Mask = (1 << 16) | (1 << 17) | (1 << 28) | (1 << 30) | (1 << 31);
+    if ((info[1] & avx512Mask) != avx512Mask || (xcr0 & 0xe6) != 0xe6) return ISA::AVX2;
+    return ISA::AVX512;
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+    __builtin_cpu_init();
+    if (!__builtin_cpu_supports("sse4.2")) return ISA::Scalar;
+    if (!__builtin_cpu_supports("avx2") || !__builtin_cpu_supports("fma")) return ISA::SSE4;
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512dq") &&
+        __builtin_cpu_supports("avx512cd") && __builtin_cpu_supports("avx512bw") &&
+        __builtin_cpu_supports("avx512vl"))
+        return ISA::AVX512;
+    return ISA::AVX2;
+#else
+    return ISA::Scalar;
+#endif
+}
+
+// Read by the kernels on the worker threads, it orders nothing else so the accesses are relaxed
+inline std::atomic<bool> g_ForceScalar = false;
+
+// Force the scalar path, used to compare both paths in tests and benchmarks.
+inline void ForceScalar(bool enable) noexcept { g_ForceScalar.store(enable, std::memory_order_relaxed); }
+
+inline ISA GetISA() noexcept {
+    static const ISA isa = DetectISA();
+    return isa;
+}
+
+inline bool IsSupported() noexcept {
+    if (g_ForceScalar.load(std::memory_order_relaxed)) return false;
+#if defined(ISPC_MIN_ISA)
+    static const bool supported = static_cast<int>(GetISA()) >= ISPC_MIN_ISA;
+    return supported;
+#else
+    // the kernels were built for the host
+    return true;
+#endif
+}
+
 //float
 inline void vector_add_assgin(float* a, const float* b, const int32_t size) {
+    if (!IsSupported()) {
+        for (int32_t i = 0; i < size; i++) a[i] += b[i];
+        return;
+    }
     vector_add_assgin_float(a, b, size);
 }
 inline void vector_add(const float* a, const float* b, float* out, const int32_t size) {
+    if (!IsSupported()) {
+        for (int32_t i = 0; i < size; i++) out[i] = a[i] + b[i];
+        return;
+    }
     vector_add_float(a, b, out, size);
 }
 inline void vector_div_assign(float* a, const float b, const int32_t size) {
+    if (!IsSupported()) {
+        for (int32_t i = 0; i < size; i++) a[i] /= b;
+        return;
+    }
     vector_div_assign_float(a, b, size);
 }
 inline void vector_div(const float* a, const float b, float* out, const int32_t size) {
+    if (!IsSupported()) {
+        for (int32_t i = 0; i < size; i++) out[i] = a[i] / b;
+        return;
+    }
     vector_div_float(a, b, out, size);
 }
 inline float vector_dot(const float* a, const float* b, const int32_t size) {
+    if (!IsSupported()) {
+        float result = 0;
+        for (int32_t i = 0; i < size; i++) result += a[i] * b[i];
+        return result;
+    }
     return vector_dot_float(a, b, size);
 }
 inline void vector_mult_assgin(float* a, const float b, const int32_t size) {
+    if (!IsSupported()) {
+        for (int32_t i = 0; i < size; i++) a[i] *= b;
+        return;
+    }
     vector_mult_assgin_float(a, b, size);
 }
 inline void vector_mult(const float* a, const float b, float* out, const int32_t size) {
+    if (!IsSupported()) {
+        for (int32_t i = 0; i < size; i++) out[i] = a[i] * b;
+        return;
+    }
     vector_mult_float(a, b, out, size);
 }
 inline void vector_mult_vector(const float* a, const float* b, float* out, const int32_t size) {
+    if (!IsSupported()) {
+        for (int32_t i = 0; i < size; i++) out[i] = a[i] * b[i];
+        return;
+    }
     vector_mult_vector_float(a, b, out, size);
 }
 inline void vector_sub_assgin(float* a, const float* b, const int32_t size) {
+    if (!IsSupported()) {
+        for (int32_t i = 0; i < size; i++) a[i] -= b[i];
+        return;
+    }
     vector_sub_assgin_float(a, b, size);
 }
 inline void vector_sub(const float* a, const float* b, float* out, const int32_t size) {
+    if (!IsSupported()) {
+        for (int32_t i = 0; i < size; i++) out[i] = a[i] - b[i];
+        return;
+    }
     vector_sub_float(a, b, out, size);
 }
 inline void zero(float* data, int32_t size) {
+    if (!IsSupported()) {
+        for (int32_t i = 0; i < size; i++) data[i] = 0;
+        return;
+    }
     zero_float(data, size);
 }
 inline void vector_inverse(const float* data, float* out, const int32_t size) {
+    if (!IsSupported()) {
+        for (int32_t i = 0; i < size; i++) out[i] = -data[i];
+        return;
+    }
     vector_inverse_float(data, out, size);
 }
 
 //double
 inline void vector_add_assgin(double* a, const double* b, const int32_t size) {
+    if (!IsSupported()) {
+        for (int32_t i = 0; i < size; i++) a[i] += b[i];
+        return;
+    }
     vector_add_assgin_double(a, b, size);
 }
 inline void vector_add(const double* a, const double* b, double* out, const int32_t size) {
+    if (!IsSupported()) {
+        for (int32_t i = 0; i < size; i++) out[i] = a[i] + b[i];
+        return;
+    }
     vector_add_double(a, b, out, size);
 }
 inline void vector_div_assign(double* a, const double b, const int32_t size) {
+    if (!IsSupported()) {
+        for (int32_t i = 0; i < size; i++) a[i] /= b;
+        return;
+    }
     vector_div_assign_double(a, b, size);
 }
 inline void vector_div(const double* a, const double b, double* out, const int32_t size) {
+    if (!IsSupported()) {
+        for (int32_t i = 0; i < size; i++) out[i] = a[i] / b;
+        return;
+    }
     vector_div_double(a, b, out, size);
 }
 inline double vector_dot(const double* a, const double* b, const int32_t size) {
+    if (!IsSupported()) {
+        double result = 0;
+        for (int32_t i = 0; i < size; i++) result += a[i] * b[i];
+        return result;
+    }
     return vector_dot_double(a, b, size);
 }
 inline void vector_mult_assgin(double* a, const double b, const int32_t size) {
+    if (!IsSupported()) {
+        for (int32_t i = 0; i < size; i++) a[i] *= b;
+        return;
+    }
     vector_mult_assgin_double(a, b, size);
 }
 inline void vector_mult(const double* a, const double b, double* out, const int32_t size) {
+    if (!IsSupported()) {
+        for (int32_t i = 0; i < size; i++) out[i] = a[i] * b;
+        return;
+    }
     vector_mult_double(a, b, out, size);
 }
 inline void vector_mult_vector(const double* a, const double* b, double* out, const int32_t size) {
+    if (!IsSupported()) {
+        for (int32_t i = 0; i < size; i++) out[i] = a[i] * b[i];
+        return;
+    }
     vector_mult_vector_double(a, b, out, size);
 }
 inline void vector_sub_assgin(double* a, const double* b, const int32_t size) {
+    if (!IsSupported()) {
+        for (int32_t i = 0; i < size; i++) a[i] -= b[i];
+        return;
+    }
     vector_sub_assgin_double(a, b, size);
 }
 inline void vector_sub(const double* a, const double* b, double* out, const int32_t size) {
+    if (!IsSupported()) {
+        for (int32_t i = 0; i < size; i++) out[i] = a[i] - b[i];
+        return;
+    }
     vector_sub_double(a, b, out, size);
 }
 inline void zero(double* data, int32_t size) {
+    if (!IsSupported()) {
+        for (int32_t i = 0; i < size; i++) data[i] = 0;
+        return;
+    }
     zero_double(data, size);
 }
 inline void vector_inverse(const double* data, double* out, const int32_t size) {
+    if (!IsSupported()) {
+        for (int32_t i = 0; i < size; i++) out[i] = -data[i];
+        return;
+    }
     vector_inverse_double(data, out, size);
 }
 };  // namespace ispc
\ No newline at end of file
@@ -19,6 +19,7 @@ int ThreadManager::Initialize() {
 
     for (decltype(numThreads) i = 0; i < numThreads; i++) {
         m_ThreadPools.emplace_back([this] {
+            sm_IsWorker = true;
             while (true) {
                 std::packaged_task<void()> task;
                 {
@@ -30,6 +31,7 @@ int ThreadManager::Initialize() {
                     m_Tasks.pop();
                     m_ConditionForTask.notify_one();
                 }
+                m_ConditionForQueueSize.notify_one();
                 task();
             }
         });
@@ -46,6 +48,7 @@ void ThreadManager::Finalize() {
     for (std::thread& thread : m_ThreadPools) {
         thread.join();
     }
+    m_ThreadPools.clear();
     m_Logger->info("Finalize.");
 }
 
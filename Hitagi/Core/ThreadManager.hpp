@@ -2,10 +2,12 @@
 #include "IRuntimeModule.hpp"
 
 #include <memory>
+#include <exception>
 #include <mutex>
 #include <future>
 #include <queue>
 #include <vector>
+#include <algorithm>
 
 namespace Hitagi::Core {
 
@@ -20,6 +22,13 @@ public:
     template <typename Func, typename... Args>
     decltype(auto) RunTask(Func&& func, Args&&... args);
 
+    // Call func(i) for i in [begin, end) on the pool and wait for them.
+    // It runs on the calling thread if the pool is stopped or the caller is one of the workers.
+    template <typename Func>
+    void ParallelFor(size_t begin, size_t end, Func&& func);
+
+    inline bool IsRunning() const noexcept { return !m_Stop; }
+
     ThreadManager(const ThreadManager&) = delete;
     ThreadManager& operator=(const ThreadManager&) = delete;
 
@@ -33,6 +42,8 @@ private:
     std::condition_variable m_ConditionForTask;
     std::condition_variable m_ConditionForQueueSize;
     bool                    m_Stop = true;
+
+    inline static thread_local bool sm_IsWorker = false;
 };
 
 template <typename Func, typename... Args>
@@ -58,6 +69,42 @@ decltype(auto) ThreadManager::RunTask(Func&& func, Args&&... args) {
     return res;
 }
 
+template <typename Func>
+void ThreadManager::ParallelFor(size_t begin, size_t end, Func&& func) {
+    if (begin >= end) return;
+
+    const size_t count     = end - begin;
+    const size_t numChunks = (m_Stop || sm_IsWorker) ? 1 : std::min(count, m_ThreadPools.size());
+    if (numChunks <= 1) {
+        for (size_t i = begin; i < end; i++) func(i);
+        return;
+    }
+
+    const size_t                   chunkSize = (count + numChunks - 1) / numChunks;
+    std::vector<std::future<void>> futures;
+    futures.reserve(numChunks);
+    std::exception_ptr exception;
+    try {
+        for (size_t chunkBegin = begin; chunkBegin < end; chunkBegin += chunkSize) {
+            const size_t chunkEnd = std::min(chunkBegin + chunkSize, end);
+            futures.emplace_back(RunTask([&func, chunkBegin, chunkEnd] {
+                for (size_t i = chunkBegin; i < chunkEnd; i++) func(i);
+            }));
+        }
+    } catch (...) {
+        exception = std::current_exception();
+    }
+    // The running chunks refer to func, so all of them are waited before the first exception is rethrown
+    for (auto&& future : futures) {
+        try {
+            future.get();
+        } catch (...) {
+            if (!exception) exception = std::current_exception();
+        }
+    }
+    if (exception) std::rethrow_exception(exception);
+}
+
 }  // namespace Hitagi::Core
 
 namespace Hitagi {
@@ -0,0 +1,83 @@
+#pragma once
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+namespace Hitagi::ECS {
+
+struct Entity {
+    static constexpr uint32_t nullIndex = std::numeric_limits<uint32_t>::max();
+
+    uint32_t index      = nullIndex;
+    // Increased when the index is destroyed, so an old entity of the same index is invalid
+    uint32_t generation = 0;
+
+    bool IsNull() const noexcept { return index == nullIndex; }
+    bool operator==(const Entity&) const = default;
+};
+
+class IComponentPool {
+public:
+    virtual ~IComponentPool()                                        = default;
+    virtual bool                       Contains(Entity entity) const = 0;
+    virtual void                       Remove(Entity entity)         = 0;
+    virtual size_t                     Size() const noexcept         = 0;
+    virtual const std::vector<Entity>& GetEntities() const noexcept  = 0;
+};
+
+// A sparse set of the components of type T. The components are packed in an array together with their
+// entities, and the sparse array maps the index of an entity to its place in the packed arrays.
+// Removing swaps the last component into the hole, so the order is not kept.
+template <typename T>
+class ComponentPool : public IComponentPool {
+public:
+    bool Contains(Entity entity) const final {
+        return entity.index < m_Sparse.size() && m_Sparse[entity.index] != nullDense && m_Entities[m_Sparse[entity.index]] == entity;
+    }
+
+    template <typename... Args>
+    T& Emplace(Entity entity, Args&&... args) {
+        if (Contains(entity)) throw std::logic_error("The entity already has the component.");
+        if (entity.index >= m_Sparse.size()) m_Sparse.resize(entity.index + 1, nullDense);
+
+        m_Sparse[entity.index] = m_Components.size();
+        m_Entities.emplace_back(entity);
+        if constexpr (std::is_aggregate_v<T>)
+            return m_Components.emplace_back(T{std::forward<Args>(args)...});
+        else
+            return m_Components.emplace_back(std::forward<Args>(args)...);
+    }
+
+    void Remove(Entity entity) final {
+        if (!Contains(entity)) return;
+        const uint32_t dense = m_Sparse[entity.index];
+        if (dense != m_Components.size() - 1) {
+            m_Components[dense]               = std::move(m_Components.back());
+            m_Entities[dense]                 = m_Entities.back();
+            m_Sparse[m_Entities[dense].index] = dense;
+        }
+        m_Components.pop_back();
+        m_Entities.pop_back();
+        m_Sparse[entity.index] = nullDense;
+    }
+
+    T&       Get(Entity entity) { return m_Components[m_Sparse[entity.index]]; }
+    const T& Get(Entity entity) const { return m_Components[m_Sparse[entity.index]]; }
+    T*       TryGet(Entity entity) { return Contains(entity) ? &Get(entity) : nullptr; }
+
+    size_t                     Size() const noexcept final { return m_Components.size(); }
+    const std::vector<Entity>& GetEntities() const noexcept final { return m_Entities; }
+    std::vector<T>&            GetComponents() noexcept { return m_Components; }
+    const std::vector<T>&      GetComponents() const noexcept { return m_Components; }
+
+private:
+    static constexpr uint32_t nullDense = std::numeric_limits<uint32_t>::max();
+
+    std::vector<uint32_t> m_Sparse;
+    std::vector<Entity>   m_Entities;
+    std::vector<T>        m_Components;
+};
+
+}  // namespace Hitagi::ECS
@@ -0,0 +1,115 @@
+#pragma once
+#include "ComponentPool.hpp"
+#include "ThreadManager.hpp"
+
+#include <atomic>
+#include <memory>
+#include <tuple>
+
+namespace Hitagi::ECS {
+
+// The entities and their components. The components of a type are stored in a ComponentPool, and a query
+// of several types walks the smallest of their pools and looks the entities up in the others.
+// The structure (entities and components) must not be changed while a query is running.
+class World {
+public:
+    Entity CreateEntity() {
+        if (!m_FreeIndices.empty()) {
+            const uint32_t index = m_FreeIndices.back();
+            m_FreeIndices.pop_back();
+            return {index, m_Generations[index]};
+        }
+        m_Generations.emplace_back(0);
+        return {static_cast<uint32_t>(m_Generations.size() - 1), 0};
+    }
+
+    // Remove all the components of the entity, then its index is reused with a new generation
+    void DestroyEntity(Entity entity) {
+        if (!Valid(entity)) return;
+        for (auto&& pool : m_Pools)
+            if (pool) pool->Remove(entity);
+        m_Generations[entity.index]++;
+        m_FreeIndices.emplace_back(entity.index);
+    }
+
+    bool Valid(Entity entity) const noexcept {
+        return entity.index < m_Generations.size() && m_Generations[entity.index] == entity.generation;
+    }
+    size_t GetEntityCount() const noexcept { return m_Generations.size() - m_FreeIndices.size(); }
+
+    template <typename T, typename... Args>
+    T& Emplace(Entity entity, Args&&... args) {
+        if (!Valid(entity)) throw std::invalid_argument("Add a component to an invalid entity.");
+        return GetPool<T>().Emplace(entity, std::forward<Args>(args)...);
+    }
+    template <typename T>
+    void Remove(Entity entity) { GetPool<T>().Remove(entity); }
+    template <typename T>
+    bool Has(Entity entity) const {
+        auto pool = FindPool<T>();
+        return pool && pool->Contains(entity);
+    }
+    template <typename T>
+    T& Get(Entity entity) { return GetPool<T>().Get(entity); }
+    template <typename T>
+    T* TryGet(Entity entity) { return GetPool<T>().TryGet(entity); }
+
+    template <typename T>
+    ComponentPool<T>& GetPool() {
+        const size_t id = GetTypeId<T>();
+        if (id >= m_Pools.size()) m_Pools.resize(id + 1);
+        if (!m_Pools[id]) m_Pools[id] = std::make_unique<ComponentPool<T>>();
+        return static_cast<ComponentPool<T>&>(*m_Pools[id]);
+    }
+
+    // Call func(entity, components&...) for every entity that has all the components
+    template <typename... Components, typename Func>
+    void Each(Func&& func) {
+        auto        pools    = std::tie(GetPool<Components>()...);
+        const auto& entities = GetSmallestPool(pools).GetEntities();
+        for (auto entity : entities) {
+            if ((std::get<ComponentPool<Components>&>(pools).Contains(entity) && ...))
+                func(entity, std::get<ComponentPool<Components>&>(pools).Get(entity)...);
+        }
+    }
+
+    // The same as Each, but the entities are split into chunks run on the thread pool. func must only
+    // write the components it is given, and must not change the structure of the world.
+    template <typename... Components, typename Func>
+    void ParallelEach(Func&& func) {
+        auto        pools    = std::tie(GetPool<Components>()...);
+        const auto& entities = GetSmallestPool(pools).GetEntities();
+        g_ThreadManager->ParallelFor(0, entities.size(), [&](size_t i) {
+            const Entity entity = entities[i];
+            if ((std::get<ComponentPool<Components>&>(pools).Contains(entity) && ...))
+                func(entity, std::get<ComponentPool<Components>&>(pools).Get(entity)...);
+        });
+    }
+
+private:
+    inline static std::atomic<size_t> sm_NextTypeId = 0;
+    template <typename T>
+    static size_t GetTypeId() {
+        static const size_t id = sm_NextTypeId++;
+        return id;
+    }
+
+    template <typename T>
+    const ComponentPool<T>* FindPool() const {
+        const size_t id = GetTypeId<T>();
+        return id < m_Pools.size() ? static_cast<const ComponentPool<T>*>(m_Pools[id].get()) : nullptr;
+    }
+
+    template <typename... Pools>
+    static const IComponentPool& GetSmallestPool(const std::tuple<Pools&...>& pools) {
+        const IComponentPool* result = nullptr;
+        std::apply([&](auto&... pool) { ((result = (!result || pool.Size() < result->Size()) ? &pool : result), ...); }, pools);
+        return *result;
+    }
+
+    std::vector<uint32_t>                        m_Generations;
+    std::vector<uint32_t>                        m_FreeIndices;
+    std::vector<std::unique_ptr<IComponentPool>> m_Pools;
+};
+
+}  // namespace Hitagi::ECS
@@ -149,26 +149,30 @@ void GraphicsCommandContext::Present(Graphics::RenderTarget& rt) {
     TransitionResource(renderTarget, D3D12_RESOURCE_STATE_PRESENT, true);
 }
 
-void GraphicsCommandContext::Draw(const Graphics::MeshBuffer& mesh) {
+void GraphicsCommandContext::Draw(const Graphics::MeshBuffer& mesh, size_t instanceCount) {
     auto  indexBuffer = static_cast<const IndexBuffer*>(mesh.indices.GetResource());
     auto& layout      = m_Pipeline->GetInputLayout();
 
     auto ibv = indexBuffer->IndexBufferView();
     m_CommandList->IASetIndexBuffer(&ibv);
-    for (auto&& [semanticName, vertex] : mesh.vertices) {
-        auto iter = layout.begin();
-        while (iter != layout.end() && iter->semanticName != semanticName) iter++;
-        if (iter == layout.end()) continue;
-
-        auto vbv = static_cast<const VertexBuffer*>(vertex.GetResource())->VertexBufferView();
-        m_CommandList->IASetVertexBuffers(iter->inputSlot, 1, &vbv);
+    // Every input element has its own slot, so an attribute of an interleaved stream is bound
+    // at its offset with the stride of the stream. The custom attributes can not be matched.
+    for (auto&& element : layout) {
+        if (element.attribute == Asset::VertexAttribute::CUSTOM) continue;
+        auto binding = std::find_if(mesh.bindings.begin(), mesh.bindings.end(), [&](const auto& item) {
+            return item.attribute == element.attribute && item.semanticIndex == element.semanticIndex;
+        });
+        if (binding == mesh.bindings.end()) continue;
+
+        auto vbv = static_cast<const VertexBuffer*>(mesh.vertices[binding->stream].GetResource())->VertexBufferView(binding->offset);
+        m_CommandList->IASetVertexBuffers(element.inputSlot, 1, &vbv);
     }
 
     FlushResourceBarriers();
     m_DynamicViewDescriptorHeap.CommitStagedDescriptors(*this, &ID3D12GraphicsCommandList5::SetGraphicsRootDescriptorTable);
     m_DynamicSamplerDescriptorHeap.CommitStagedDescriptors(*this, &ID3D12GraphicsCommandList5::SetGraphicsRootDescriptorTable);
     m_CommandList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
-    m_CommandList->DrawIndexedInstanced(indexBuffer->GetElementCount(), 1, 0, 0, 0);
+    m_CommandList->DrawIndexedInstanced(indexBuffer->GetElementCount(), instanceCount, 0, 0, 0);
 }
 
 void CopyCommandContext::InitializeBuffer(GpuResource& dest, const uint8_t* data, size_t dataSize) {
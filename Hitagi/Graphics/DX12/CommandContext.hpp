@@ -86,7 +86,7 @@ public:
     void SetParameter(std::string_view name, const Graphics::TextureBuffer& texture) final;
     void SetParameter(std::string_view name, const Graphics::TextureSampler& sampler) final;
 
-    void     Draw(const Graphics::MeshBuffer& mesh) final;
+    void     Draw(const Graphics::MeshBuffer& mesh, size_t instanceCount = 1) final;
     void     Present(Graphics::RenderTarget& rt) final;
     uint64_t Finish(bool waitForComplete = false) final { return CommandContext::Finish(waitForComplete); }
 
@@ -156,12 +156,12 @@ Graphics::TextureBuffer DX12DriverAPI::CreateTextureBuffer(std::string_view name
         m_DescriptorAllocator[D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV].Allocate(),
         _desc);
     if (desc.initialData) {
-        CopyCommandContext     context(*this);
-        D3D12_SUBRESOURCE_DATA subData;
-        subData.pData      = desc.initialData;
-        subData.RowPitch   = desc.pitch;
-        subData.SlicePitch = desc.initialDataSize;
-        context.InitializeTexture(*buffer, {subData});
+        CopyCommandContext                  context(*this);
+        std::vector<D3D12_SUBRESOURCE_DATA> subData;
+        subData.push_back({desc.initialData, static_cast<LONG_PTR>(desc.pitch), static_cast<LONG_PTR>(desc.initialDataSize)});
+        for (auto&& mip : desc.mipData)
+            subData.push_back({mip.data, static_cast<LONG_PTR>(mip.pitch), static_cast<LONG_PTR>(mip.size)});
+        context.InitializeTexture(*buffer, subData);
     }
     return {std::move(buffer)};
 }
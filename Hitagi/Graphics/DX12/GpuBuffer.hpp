@@ -20,10 +20,11 @@ protected:
 class VertexBuffer : public GpuBuffer {
 public:
     using GpuBuffer::GpuBuffer;
-    D3D12_VERTEX_BUFFER_VIEW VertexBufferView() const {
+    // The offset selects an attribute of the interleaved vertices
+    D3D12_VERTEX_BUFFER_VIEW VertexBufferView(size_t offset = 0) const {
         D3D12_VERTEX_BUFFER_VIEW vbv;
-        vbv.BufferLocation = m_Resource->GetGPUVirtualAddress();
-        vbv.SizeInBytes    = m_BufferSize;
+        vbv.BufferLocation = m_Resource->GetGPUVirtualAddress() + offset;
+        vbv.SizeInBytes    = m_BufferSize - offset;
         vbv.StrideInBytes  = m_ElementSize;
         return vbv;
     }
@@ -35,7 +36,7 @@ public:
     D3D12_INDEX_BUFFER_VIEW IndexBufferView() const {
         D3D12_INDEX_BUFFER_VIEW ibv;
         ibv.BufferLocation = m_Resource->GetGPUVirtualAddress();
-        ibv.Format         = DXGI_FORMAT_R32_UINT;
+        ibv.Format         = m_ElementSize == sizeof(uint16_t) ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT;
         ibv.SizeInBytes    = m_BufferSize;
         return ibv;
     }
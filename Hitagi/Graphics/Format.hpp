@@ -181,8 +181,37 @@ inline constexpr size_t GetFormatBitSize(Format format) {
             return 8;
         case Format::R1_UNORM:
             return 1;
+        // block compressed formats, bits per pixel
+        case Format::BC2_TYPELESS:
+        case Format::BC2_UNORM:
+        case Format::BC2_UNORM_SRGB:
+        case Format::BC3_TYPELESS:
+        case Format::BC3_UNORM:
+        case Format::BC3_UNORM_SRGB:
+        case Format::BC5_TYPELESS:
+        case Format::BC5_UNORM:
+        case Format::BC5_SNORM:
+        case Format::BC6H_TYPELESS:
+        case Format::BC6H_UF16:
+        case Format::BC6H_SF16:
+        case Format::BC7_TYPELESS:
+        case Format::BC7_UNORM:
+        case Format::BC7_UNORM_SRGB:
+            return 8;
+        case Format::BC1_TYPELESS:
+        case Format::BC1_UNORM:
+        case Format::BC1_UNORM_SRGB:
+        case Format::BC4_TYPELESS:
+        case Format::BC4_UNORM:
+        case Format::BC4_SNORM:
+            return 4;
         default:
             return 0;
     }
 }
+
+inline constexpr bool IsBlockCompressed(Format format) {
+    return (format >= Format::BC1_TYPELESS && format <= Format::BC5_SNORM) ||
+           (format >= Format::BC6H_TYPELESS && format <= Format::BC7_UNORM_SRGB);
+}
 }  // namespace Hitagi::Graphics
\ No newline at end of file
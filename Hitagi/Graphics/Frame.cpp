@@ -2,6 +2,8 @@
 #include "DriverAPI.hpp"
 #include "ICommandContext.hpp"
 
+#include <unordered_map>
+
 namespace Hitagi::Graphics {
 Frame::Frame(backend::DriverAPI& driver, ResourceManager& resourceManager, size_t frameIndex)
     : m_Driver(driver),
@@ -11,84 +13,123 @@ Frame::Frame(backend::DriverAPI& driver, ResourceManager& resourceManager, size_
       m_Output(m_Driver.CreateRenderFromSwapChain(frameIndex)) {
 }
 
-void Frame::SetGeometries(std::vector<std::reference_wrapper<Asset::SceneGeometryNode>> geometries) {
-    m_Geometries.clear();
-    m_Geometries.reserve(geometries.size());
+void Frame::SetGeometries(const Asset::Scene& scene, std::vector<std::reference_wrapper<Asset::SceneGeometryNode>> geometries) {
+    // Select the LOD by the projected bounding sphere
+    const vec3f         cameraPos(m_FrameConstant.cameraPos.xyz);
+    std::vector<size_t> lods(geometries.size(), 0);
+    for (size_t i = 0; i < geometries.size(); i++) {
+        auto geometry = scene.GetGeometry(geometries[i].get().GetSceneObjectHandle());
+        if (!geometry || geometry->GetLODCount() <= 1 || geometry->GetBoundingBox().Empty()) continue;
+
+        const auto& box      = geometry->GetBoundingBox();
+        const auto  bound    = Transform(Sphere(box.Center(), box.Extent().norm()), geometries[i].get().GetWorldTransform());
+        const float distance = (bound.position - cameraPos).norm();
+        if (distance > bound.radius)
+            lods[i] = geometry->SelectLOD(bound.radius * m_ProjectionScale / distance, lodScreenError);
+    }
 
-    // Calculate need constant buffer size
-    size_t constantCount = geometries.size(), materialCount = 0;
-    for (Asset::SceneGeometryNode& node : geometries) {
-        if (auto geometry = node.GetSceneObjectRef().lock()) {
-            materialCount += geometry->GetMeshes().size();
+    // Group the instances by mesh in the order they first appear, a mesh has only one material
+    struct Batch {
+        Asset::SceneObjectMesh&                      mesh;
+        const Asset::SceneObjectMaterial&            material;
+        std::vector<const Asset::SceneGeometryNode*> nodes;
+    };
+    std::vector<Batch>                                        batches;
+    std::unordered_map<const Asset::SceneObjectMesh*, size_t> batchIndex;
+    for (size_t i = 0; i < geometries.size(); i++) {
+        Asset::SceneGeometryNode& node = geometries[i];
+        if (auto geometry = scene.GetGeometry(node.GetSceneObjectHandle())) {
+            for (auto&& mesh : geometry->GetMeshes(lods[i])) {
+                auto material = scene.GetMaterial(mesh->GetMaterialHandle());
+                if (!material) continue;
+                auto [iter, inserted] = batchIndex.try_emplace(mesh.get(), batches.size());
+                if (inserted) batches.emplace_back(Batch{*mesh, *material, {}});
+                batches[iter->second].nodes.emplace_back(&node);
+            }
         }
     }
+
+    // Calculate need constant buffer size
+    size_t constantCount = 0, materialCount = batches.size();
+    for (auto&& batch : batches) {
+        constantCount += (batch.nodes.size() + maxInstances - 1) / maxInstances;
+    }
     // if new size is smaller, the expand function return directly.
-    if (m_ConstantBuffer.GetNumElements() < constantCount)
-        m_ConstantBuffer = m_Driver.CreateConstantBuffer("Object Constant", constantCount, sizeof(ConstantData));
+    if (m_ConstantBuffer.GetNumElements() < constantCount) {
+        m_ConstantBuffer = m_Driver.CreateConstantBuffer("Object Constant", constantCount, sizeof(InstanceConstants));
+        m_InstanceSlots.assign(constantCount * maxInstances, {});
+    }
     if (m_MaterialBuffer.GetNumElements() < materialCount)
         m_MaterialBuffer = m_Driver.CreateConstantBuffer("Material Constant", materialCount, sizeof(MaterialData));
 
+    m_DrawItems.clear();
+    m_DrawItems.reserve(constantCount);
     size_t constantOffset = 0, materialOffset = 0;
-    for (Asset::SceneGeometryNode& node : geometries) {
-        if (auto geometry = node.GetSceneObjectRef().lock()) {
-            DrawItem item;
-
-            // need update
-            ConstantData data{node.GetCalculatedTransform()};
-            if (m_Driver.GetType() == backend::APIType::DirectX12)
-                data.transform = transpose(data.transform);
-            m_Driver.UpdateConstantBuffer(m_ConstantBuffer, constantOffset, reinterpret_cast<const uint8_t*>(&data), sizeof(data));
-            item.constantOffset = constantOffset;
-            constantOffset++;
-
-            auto& meshes = geometry->GetMeshes();
-            // Generate mesh info
-            for (auto&& mesh : meshes) {
-                // Updata Material data
-                if (auto material = mesh->GetMaterial().lock()) {
-                    auto& ambient       = material->GetAmbientColor();
-                    auto& diffuse       = material->GetDiffuseColor();
-                    auto& emission      = material->GetEmission();
-                    auto& specular      = material->GetSpecularColor();
-                    auto& specularPower = material->GetSpecularPower();
-
-                    MaterialData data{
-                        ambient.ValueMap ? vec4f(-1.0f) : ambient.Value,
-                        diffuse.ValueMap ? vec4f(-1.0f) : diffuse.Value,
-                        emission.ValueMap ? vec4f(-1.0f) : emission.Value,
-                        specular.ValueMap ? vec4f(-1.0f) : specular.Value,
-                        specularPower.ValueMap ? -1.0f : specularPower.Value,
-                    };
-
-                    m_Driver.UpdateConstantBuffer(
-                        m_MaterialBuffer,
-                        materialOffset,
-                        reinterpret_cast<const uint8_t*>(&data),
-                        sizeof(data));
-
-                    item.meshes.emplace_back(MeshInfo{
-                        m_ResMgr.GetMeshBuffer(*mesh),
-                        materialOffset,
-                        ambient.ValueMap ? m_ResMgr.GetTextureBuffer(*ambient.ValueMap) : m_ResMgr.GetDefaultTextureBuffer(Format::R8G8B8A8_UNORM),
-                        diffuse.ValueMap ? m_ResMgr.GetTextureBuffer(*diffuse.ValueMap) : m_ResMgr.GetDefaultTextureBuffer(Format::R8G8B8A8_UNORM),
-                        emission.ValueMap ? m_ResMgr.GetTextureBuffer(*emission.ValueMap) : m_ResMgr.GetDefaultTextureBuffer(Format::R8G8B8A8_UNORM),
-                        specular.ValueMap ? m_ResMgr.GetTextureBuffer(*specular.ValueMap) : m_ResMgr.GetDefaultTextureBuffer(Format::R8G8B8A8_UNORM),
-                        specularPower.ValueMap ? m_ResMgr.GetTextureBuffer(*specularPower.ValueMap) : m_ResMgr.GetDefaultTextureBuffer(Format::R32_FLOAT),
-                    });
-                    materialOffset++;
+    for (auto&& batch : batches) {
+        // Updata Material data
+        auto& ambient       = batch.material.GetAmbientColor();
+        auto& diffuse       = batch.material.GetDiffuseColor();
+        auto& emission      = batch.material.GetEmission();
+        auto& specular      = batch.material.GetSpecularColor();
+        auto& specularPower = batch.material.GetSpecularPower();
+
+        MaterialData data{
+            ambient.ValueMap ? vec4f(-1.0f) : ambient.Value,
+            diffuse.ValueMap ? vec4f(-1.0f) : diffuse.Value,
+            emission.ValueMap ? vec4f(-1.0f) : emission.Value,
+            specular.ValueMap ? vec4f(-1.0f) : specular.Value,
+            specularPower.ValueMap ? -1.0f : specularPower.Value,
+        };
+
+        m_Driver.UpdateConstantBuffer(
+            m_MaterialBuffer,
+            materialOffset,
+            reinterpret_cast<const uint8_t*>(&data),
+            sizeof(data));
+
+        MeshInfo info{
+            m_ResMgr.GetMeshBuffer(batch.mesh),
+            materialOffset,
+            ambient.ValueMap ? m_ResMgr.GetTextureBuffer(*ambient.ValueMap) : m_ResMgr.GetDefaultTextureBuffer(Format::R8G8B8A8_UNORM),
+            diffuse.ValueMap ? m_ResMgr.GetTextureBuffer(*diffuse.ValueMap) : m_ResMgr.GetDefaultTextureBuffer(Format::R8G8B8A8_UNORM),
+            emission.ValueMap ? m_ResMgr.GetTextureBuffer(*emission.ValueMap) : m_ResMgr.GetDefaultTextureBuffer(Format::R8G8B8A8_UNORM),
+            specular.ValueMap ? m_ResMgr.GetTextureBuffer(*specular.ValueMap) : m_ResMgr.GetDefaultTextureBuffer(Format::R8G8B8A8_UNORM),
+            specularPower.ValueMap ? m_ResMgr.GetTextureBuffer(*specularPower.ValueMap) : m_ResMgr.GetDefaultTextureBuffer(Format::R32_FLOAT),
+        };
+        materialOffset++;
+
+        // Split the instances into the draws that fit in a constant element, an element is uploaded
+        // again only if one of its instances moved or is a different node from the last time
+        for (size_t first = 0; first < batch.nodes.size(); first += maxInstances) {
+            const size_t count   = std::min(maxInstances, batch.nodes.size() - first);
+            bool         changed = false;
+            for (size_t j = 0; j < count; j++) {
+                auto& slot = m_InstanceSlots[constantOffset * maxInstances + j];
+                auto  node = batch.nodes[first + j];
+                if (slot.node == node && slot.version == node->GetTransformVersion()) continue;
+                slot    = {node, node->GetTransformVersion()};
+                changed = true;
+            }
+            if (changed) {
+                InstanceConstants instances;
+                for (size_t j = 0; j < count; j++) {
+                    auto& transform         = batch.nodes[first + j]->GetWorldTransform();
+                    instances.transforms[j] = m_Driver.GetType() == backend::APIType::DirectX12 ? transpose(transform) : transform;
                 }
+                m_Driver.UpdateConstantBuffer(m_ConstantBuffer, constantOffset, reinterpret_cast<const uint8_t*>(&instances), count * sizeof(mat4f));
             }
-            m_Geometries.emplace_back(std::move(item));
+            m_DrawItems.emplace_back(DrawItem{info, constantOffset, count});
+            constantOffset++;
         }
     }
 }
 
-void Frame::SetCamera(Asset::SceneCameraNode& camera) {
+void Frame::SetCamera(const Asset::Scene& scene, Asset::SceneCameraNode& camera) {
     auto& data        = m_FrameConstant;
     data.cameraPos    = vec4f(camera.GetCameraPosition(), 1.0f);
     data.view         = camera.GetViewMatrix();
     data.invView      = inverse(data.view);
-    auto cameraObject = camera.GetSceneObjectRef().lock();
+    auto cameraObject = scene.GetCamera(camera.GetSceneObjectHandle());
     assert(cameraObject != nullptr);
     // TODO orth camera
     data.projection = perspective(
@@ -96,9 +137,13 @@ void Frame::SetCamera(Asset::SceneCameraNode& camera) {
         cameraObject->GetAspect(),
         cameraObject->GetNearClipDistance(),
         cameraObject->GetFarClipDistance());
+    m_ProjectionScale  = data.projection[1][1];
     data.invProjection = inverse(data.projection);
     data.projView      = data.projection * data.view;
     data.invProjView   = inverse(data.projView);
+    // before the matrices are transposed for DirectX 12
+    m_ProjView = data.projView;
+    m_Frustum  = Frustum(data.projView);
 
     if (m_Driver.GetType() == backend::APIType::DirectX12) {
         data.view          = transpose(data.view);
@@ -112,11 +157,11 @@ void Frame::SetCamera(Asset::SceneCameraNode& camera) {
     m_Driver.UpdateConstantBuffer(m_FrameConstantBuffer, 0, reinterpret_cast<uint8_t*>(&data), sizeof(data));
 }
 
-void Frame::SetLight(Asset::SceneLightNode& light) {
+void Frame::SetLight(const Asset::Scene& scene, Asset::SceneLightNode& light) {
     auto& data          = m_FrameConstant;
-    data.lightPosition  = vec4f(GetOrigin(light.GetCalculatedTransform()), 1);
+    data.lightPosition  = vec4f(GetOrigin(light.GetWorldTransform()), 1);
     data.lightPosInView = data.view * data.lightPosition;
-    if (auto lightObj = light.GetSceneObjectRef().lock()) {
+    if (auto lightObj = scene.GetLight(light.GetSceneObjectHandle())) {
         data.lightIntensity = lightObj->GetIntensity() * lightObj->GetColor().Value;
     }
     m_Driver.UpdateConstantBuffer(m_FrameConstantBuffer, 0, reinterpret_cast<uint8_t*>(&data), sizeof(data));
@@ -124,17 +169,15 @@ void Frame::SetLight(Asset::SceneLightNode& light) {
 
 void Frame::Draw(IGraphicsCommandContext* context) {
     context->SetParameter("FrameConstant", m_FrameConstantBuffer, 0);
-    for (auto&& item : m_Geometries) {
+    for (auto&& item : m_DrawItems) {
         context->SetParameter("ObjectConstants", m_ConstantBuffer, item.constantOffset);
-        for (auto&& mesh : item.meshes) {
-            context->SetParameter("MaterialConstants", m_MaterialBuffer, mesh.materialOffset);
-            context->SetParameter("AmbientTexture", mesh.ambient);
-            context->SetParameter("DiffuseTexture", mesh.diffuse);
-            context->SetParameter("EmissionTexture", mesh.emission);
-            context->SetParameter("SpecularTexture", mesh.specular);
-            context->SetParameter("PowerTexture", mesh.specularPower);
-            context->Draw(mesh.buffer);
-        }
+        context->SetParameter("MaterialConstants", m_MaterialBuffer, item.mesh.materialOffset);
+        context->SetParameter("AmbientTexture", item.mesh.ambient);
+        context->SetParameter("DiffuseTexture", item.mesh.diffuse);
+        context->SetParameter("EmissionTexture", item.mesh.emission);
+        context->SetParameter("SpecularTexture", item.mesh.specular);
+        context->SetParameter("PowerTexture", item.mesh.specularPower);
+        context->Draw(item.mesh.buffer, item.instanceCount);
     }
 }
 
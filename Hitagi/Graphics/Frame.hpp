@@ -1,8 +1,9 @@
 #pragma once
-#include "SceneNode.hpp"
+#include "Scene.hpp"
 #include "ResourceManager.hpp"
 #include "PipelineState.hpp"
 
+#include <array>
 #include <vector>
 
 namespace Hitagi::Graphics {
@@ -16,14 +17,19 @@ public:
     Frame(backend::DriverAPI& driver, ResourceManager& resourceManager, size_t frameIndex);
 
     void SetFenceValue(uint64_t fenceValue) { m_FenceValue = fenceValue; }
-    void SetGeometries(std::vector<std::reference_wrapper<Asset::SceneGeometryNode>> geometries);
-    void SetCamera(Asset::SceneCameraNode& camera);
-    void SetLight(Asset::SceneLightNode& light);
+    // The objects are resolved by the handles of the nodes in the scene.
+    // The LOD of a geometry is selected by its size on the screen, so the camera must be set before
+    void SetGeometries(const Asset::Scene& scene, std::vector<std::reference_wrapper<Asset::SceneGeometryNode>> geometries);
+    void SetCamera(const Asset::Scene& scene, Asset::SceneCameraNode& camera);
+    void SetLight(const Asset::Scene& scene, Asset::SceneLightNode& light);
     void Draw(IGraphicsCommandContext* context);
 
     void WaitLastDraw();
 
     RenderTarget& GetRenerTarget() { return m_Output; }
+    // The projection * view and the frustum of the camera set last, in the world space
+    const mat4f&   GetProjView() const { return m_ProjView; }
+    const Frustum& GetFrustum() const { return m_Frustum; }
 
     struct FrameConstant {
         // Camera
@@ -39,8 +45,12 @@ public:
         vec4f lightIntensity;
     };
 
-    struct ConstantData {
-        mat4f transform;
+    // The nodes drawing the same mesh are batched into instanced draws of at most maxInstances,
+    // which must match the array size of ObjectConstants in the shader
+    static constexpr size_t maxInstances = 64;
+
+    struct InstanceConstants {
+        std::array<mat4f, maxInstances> transforms;
     };
 
     struct MaterialData {
@@ -63,8 +73,15 @@ public:
     };
 
     struct DrawItem {
-        std::vector<MeshInfo> meshes;
-        size_t                constantOffset;
+        MeshInfo mesh;
+        size_t   constantOffset;
+        size_t   instanceCount;
+    };
+
+    // The node of an instance in m_ConstantBuffer and the version of the transform uploaded
+    struct InstanceSlot {
+        const Asset::BaseSceneNode* node    = nullptr;
+        uint64_t                    version = 0;
     };
 
 private:
@@ -73,13 +90,21 @@ private:
     size_t              m_FrameIndex;
     uint64_t            m_FenceValue = 0;
 
+    // The max geometric error of a LOD on the screen, relative to the half height of the view
+    static constexpr float lodScreenError = 1.0f / 540.0f;
+
     FrameConstant         m_FrameConstant;
-    std::vector<DrawItem> m_Geometries;
+    mat4f                 m_ProjView{1.0f};
+    Frustum               m_Frustum{mat4f(1.0f)};
+    // The scale of the projection from the view space to the screen, i.e. 1 / tan(fov / 2)
+    float                 m_ProjectionScale = 1.0f;
+    std::vector<DrawItem> m_DrawItems;
     RenderTarget          m_Output;
 
     // the constant data used among the frame, including camera, light, etc.
-    ConstantBuffer m_FrameConstantBuffer;
-    ConstantBuffer m_ConstantBuffer;
-    ConstantBuffer m_MaterialBuffer;
+    ConstantBuffer            m_FrameConstantBuffer;
+    ConstantBuffer            m_ConstantBuffer;
+    std::vector<InstanceSlot> m_InstanceSlots;
+    ConstantBuffer            m_MaterialBuffer;
 };
 }  // namespace Hitagi::Graphics
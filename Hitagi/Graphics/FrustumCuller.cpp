@@ -0,0 +1,23 @@
+#include "FrustumCuller.hpp"
+#include "ThreadManager.hpp"
+
+namespace Hitagi::Graphics {
+
+std::vector<std::reference_wrapper<Asset::SceneGeometryNode>> FrustumCuller::Cull(const Asset::BoundingVolumeHierarchy& bvh, const Frustum& frustum) {
+    const auto bounds = bvh.GetWorldBounds();
+    m_Visibility.resize(bounds.size());
+
+    const size_t chunkCount = (bounds.size() + chunkSize - 1) / chunkSize;
+    g_ThreadManager->ParallelFor(0, chunkCount, [&](size_t chunk) {
+        const size_t begin = chunk * chunkSize;
+        const size_t count = std::min(chunkSize, bounds.size() - begin);
+        Intersect(frustum, bounds.subspan(begin, count), std::span(m_Visibility).subspan(begin, count));
+    });
+
+    std::vector<std::reference_wrapper<Asset::SceneGeometryNode>> result;
+    for (size_t i = 0; i < m_Visibility.size(); i++)
+        if (m_Visibility[i]) result.emplace_back(*bvh.GetItem(i).node);
+    return result;
+}
+
+}  // namespace Hitagi::Graphics
@@ -0,0 +1,22 @@
+#pragma once
+#include "BoundingVolumeHierarchy.hpp"
+
+namespace Hitagi::Graphics {
+
+// Test the world bounds cached by the bounding volume hierarchy of a scene against the view frustum. The bounds
+// are tested linearly by the batch kernel of HitagiMath, several boxes per instruction when ispc is enabled,
+// and the chunks of them are tested on the thread pool.
+class FrustumCuller {
+public:
+    // The number of the boxes tested by a task
+    static constexpr size_t chunkSize = 4096;
+
+    // Return the nodes whose world bound intersects the frustum, in the order of the items of the hierarchy
+    std::vector<std::reference_wrapper<Asset::SceneGeometryNode>> Cull(const Asset::BoundingVolumeHierarchy& bvh, const Frustum& frustum);
+
+private:
+    // Reused among the frames, 1 if the item is visible
+    std::vector<uint8_t> m_Visibility;
+};
+
+}  // namespace Hitagi::Graphics
@@ -105,13 +105,19 @@ void GraphicsManager::Render(const Asset::Scene& scene) {
     frame->WaitLastDraw();
 
     auto     camera = scene.GetFirstCameraNode();
-    uint32_t h      = config.screenWidth / camera->GetSceneObjectRef().lock()->GetAspect();
+    uint32_t h      = config.screenWidth / scene.GetCamera(camera->GetSceneObjectHandle())->GetAspect();
     uint32_t y      = (config.screenHeight - h) >> 1;
     context->SetViewPort(0, y, config.screenWidth, h);
 
-    frame->SetGeometries(scene.GetGeometries());
-    frame->SetCamera(*camera);
-    frame->SetLight(*scene.GetFirstLightNode());
+    // the camera is used to cull the geometries and select their LOD
+    frame->SetCamera(scene, *camera);
+    auto visible = m_FrustumCuller.Cull(scene.GetBoundingVolumeHierarchy(), frame->GetFrustum());
+    // the largest visible nodes occlude the others
+    m_OcclusionCuller.Begin(frame->GetProjView());
+    m_OcclusionCuller.AddOccluders(scene, visible);
+    m_OcclusionCuller.End();
+    frame->SetGeometries(scene, m_OcclusionCuller.Cull(scene, visible));
+    frame->SetLight(scene, *scene.GetFirstLightNode());
     FrameGraph fg(*driver);
 
     struct PassData {
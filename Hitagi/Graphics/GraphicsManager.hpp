@@ -3,6 +3,8 @@
 #include "ResourceManager.hpp"
 #include "Format.hpp"
 #include "Frame.hpp"
+#include "FrustumCuller.hpp"
+#include "OcclusionCuller.hpp"
 #include "PipelineState.hpp"
 
 #include "IRuntimeModule.hpp"
@@ -29,6 +31,8 @@ protected:
     std::array<std::unique_ptr<Frame>, sm_FrameCount> m_Frame;
     std::unique_ptr<PipelineState>                    m_PSO;
     ShaderManager                                     m_ShaderManager;
+    FrustumCuller                                     m_FrustumCuller;
+    OcclusionCuller                                   m_OcclusionCuller;
 };
 
 }  // namespace Hitagi::Graphics
@@ -13,7 +13,7 @@ public:
     virtual void     SetParameter(std::string_view name, const ConstantBuffer& cb, size_t offset) = 0;
     virtual void     SetParameter(std::string_view name, const TextureBuffer& texture)            = 0;
     virtual void     SetParameter(std::string_view name, const TextureSampler& sampler)           = 0;
-    virtual void     Draw(const MeshBuffer& mesh)                                                 = 0;
+    virtual void     Draw(const MeshBuffer& mesh, size_t instanceCount = 1)                       = 0;
     virtual void     Present(RenderTarget& rt)                                                    = 0;
     virtual uint64_t Finish(bool waitForComplete = false)                                         = 0;
 };
@@ -0,0 +1,267 @@
+#include "OcclusionCuller.hpp"
+#include "ThreadManager.hpp"
+
+#include <algorithm>
+
+namespace Hitagi::Graphics {
+namespace {
+// Write the nearer depth at the centers of the pixels covered by the indexed triangles in [x0, x1) x [y0, y1)
+void RasterizeDepth(std::span<const std::array<vec3f, 3>> triangles, std::span<const uint32_t> indices,
+                    float* depth, size_t stride, int x0, int y0, int x1, int y1) {
+#if defined(USE_ISPC)
+    if (ispc::IsSupported()) {
+        ispc::rasterize_depth(reinterpret_cast<const float*>(triangles.data()), indices.data(), indices.size(), depth, stride, x0, y0, x1, y1);
+        return;
+    }
+#endif  // USE_ISPC
+    for (auto index : indices) {
+        const auto& [a, b, c] = triangles[index];
+
+        const float area = (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+        if (std::abs(area) < 1e-8f) continue;
+        // both windings are rasterized
+        const float sign = area > 0 ? 1.0f : -1.0f, invArea = 1.0f / std::abs(area);
+
+        // clamped before the conversion, the vertices near the camera plane may be far out of the range of int
+        const int minX = std::max<float>(x0, std::floor(std::min({a.x, b.x, c.x})));
+        const int maxX = std::min<float>(x1 - 1, std::ceil(std::max({a.x, b.x, c.x})));
+        const int minY = std::max<float>(y0, std::floor(std::min({a.y, b.y, c.y})));
+        const int maxY = std::min<float>(y1 - 1, std::ceil(std::max({a.y, b.y, c.y})));
+
+        for (int y = minY; y <= maxY; y++) {
+            const float py  = y + 0.5f;
+            float*      row = depth + y * stride;
+            for (int x = minX; x <= maxX; x++) {
+                const float px = x + 0.5f;
+                const float wa = sign * ((c.x - b.x) * (py - b.y) - (c.y - b.y) * (px - b.x));
+                const float wb = sign * ((a.x - c.x) * (py - c.y) - (a.y - c.y) * (px - c.x));
+                const float wc = sign * ((b.x - a.x) * (py - a.y) - (b.y - a.y) * (px - a.x));
+                if (wa >= 0 && wb >= 0 && wc >= 0) row[x] = std::min(row[x], (wa * a.z + wb * b.z + wc * c.z) * invArea);
+            }
+        }
+    }
+}
+}  // namespace
+
+OcclusionCuller::OcclusionCuller(size_t width, size_t height)
+    : m_Width(width),
+      m_Height(height),
+      m_TileCountX((width + tileSize - 1) / tileSize),
+      m_TileCountY((height + tileSize - 1) / tileSize),
+      m_ProjView(1.0f),
+      m_Bins(m_TileCountX * m_TileCountY) {
+    // The size is halved until 1 x 1
+    size_t levelWidth = width, levelHeight = height;
+    while (true) {
+        m_Levels.emplace_back(Level{levelWidth, levelHeight, std::vector<float>(levelWidth * levelHeight, std::numeric_limits<float>::max())});
+        if (levelWidth == 1 && levelHeight == 1) break;
+        levelWidth  = (levelWidth + 1) / 2;
+        levelHeight = (levelHeight + 1) / 2;
+    }
+}
+
+void OcclusionCuller::Begin(const mat4f& projView) {
+    m_ProjView = projView;
+    m_Occluders.clear();
+    m_WidenedIndices.clear();
+    m_Triangles.clear();
+    for (auto&& bin : m_Bins) bin.clear();
+    // Nothing is occluded by the empty texels
+    for (auto&& level : m_Levels) std::fill(level.depth.begin(), level.depth.end(), std::numeric_limits<float>::max());
+}
+
+void OcclusionCuller::AddOccluder(std::span<const vec3f> positions, std::span<const uint32_t> indices, const mat4f& transform) {
+    m_Occluders.emplace_back(Occluder{positions, indices, transform});
+}
+
+void OcclusionCuller::AddOccluders(const Asset::Scene& scene, const std::vector<std::reference_wrapper<Asset::SceneGeometryNode>>& nodes) {
+    struct Candidate {
+        const Asset::SceneObjectGeometry* geometry;
+        const Asset::SceneGeometryNode*   node;
+        float                             size;
+    };
+    std::vector<Candidate> candidates;
+    for (auto&& node : nodes) {
+        auto geometry = scene.GetGeometry(node.get().GetSceneObjectHandle());
+        if (!geometry || geometry->GetBoundingBox().Empty()) continue;
+
+        const auto& box   = geometry->GetBoundingBox();
+        const auto  bound = Transform(Sphere(box.Center(), box.Extent().norm()), node.get().GetWorldTransform());
+        // The w of a perspective projection is the distance along the view direction
+        const float distance = (m_ProjView * vec4f(bound.position, 1.0f)).w;
+        // The camera is in the bound, most of the triangles would be dropped
+        if (distance <= bound.radius) continue;
+        if (const float size = bound.radius / distance; size >= minOccluderSize)
+            candidates.emplace_back(Candidate{geometry, &node.get(), size});
+    }
+
+    const size_t count = std::min(candidates.size(), maxOccluders);
+    std::partial_sort(candidates.begin(), candidates.begin() + count, candidates.end(), [](const Candidate& lhs, const Candidate& rhs) {
+        return lhs.size > rhs.size;
+    });
+    for (size_t i = 0; i < count; i++) {
+        for (auto&& mesh : candidates[i].geometry->GetMeshes(0)) {
+            auto        positions = mesh->GetVertexArray(Asset::VertexAttribute::POSITION);
+            const auto& indices   = mesh->GetIndexArray();
+            if (!positions || positions->GetDataType() != Asset::VertexDataType::FLOAT3 ||
+                mesh->GetPrimitiveType() != Asset::PrimitiveType::TRI_LIST)
+                continue;
+
+            std::span<const uint32_t> occluderIndices;
+            switch (indices.GetIndexType()) {
+                case Asset::IndexDataType::INT32:
+                    occluderIndices = {reinterpret_cast<const uint32_t*>(indices.GetData()), indices.GetIndexCount()};
+                    break;
+                case Asset::IndexDataType::INT16: {
+                    // The optimized meshes of at most 65536 vertices use 16-bit indices
+                    auto data = reinterpret_cast<const uint16_t*>(indices.GetData());
+                    // The data of a moved vector is not reallocated, so the spans of the earlier ones stay valid
+                    occluderIndices = m_WidenedIndices.emplace_back(data, data + indices.GetIndexCount());
+                    break;
+                }
+                default:
+                    continue;
+            }
+            AddOccluder({reinterpret_cast<const vec3f*>(positions->GetData()), positions->GetVertexCount()},
+                        occluderIndices, candidates[i].node->GetWorldTransform());
+        }
+    }
+}
+
+void OcclusionCuller::End() {
+    // Transform the occluders on the thread pool, then bin the triangles to the tiles they overlap
+    std::vector<std::vector<std::array<vec3f, 3>>> transformed(m_Occluders.size());
+    g_ThreadManager->ParallelFor(0, m_Occluders.size(), [&](size_t i) { TransformOccluder(m_Occluders[i], transformed[i]); });
+    for (auto&& triangles : transformed) m_Triangles.insert(m_Triangles.end(), triangles.begin(), triangles.end());
+
+    const float maxX = m_Width - 1, maxY = m_Height - 1;
+    for (uint32_t i = 0; i < m_Triangles.size(); i++) {
+        const auto& [a, b, c] = m_Triangles[i];
+
+        const float left = std::min({a.x, b.x, c.x}), right = std::max({a.x, b.x, c.x});
+        const float bottom = std::min({a.y, b.y, c.y}), top = std::max({a.y, b.y, c.y});
+        if (right < 0 || top < 0 || left > maxX || bottom > maxY) continue;
+
+        const size_t tileX0 = static_cast<size_t>(std::max(left, 0.0f)) / tileSize;
+        const size_t tileX1 = static_cast<size_t>(std::min(right, maxX)) / tileSize;
+        const size_t tileY0 = static_cast<size_t>(std::max(bottom, 0.0f)) / tileSize;
+        const size_t tileY1 = static_cast<size_t>(std::min(top, maxY)) / tileSize;
+        for (size_t tileY = tileY0; tileY <= tileY1; tileY++)
+            for (size_t tileX = tileX0; tileX <= tileX1; tileX++)
+                m_Bins[tileY * m_TileCountX + tileX].emplace_back(i);
+    }
+
+    // The tiles do not overlap, so they are rasterized at the same time
+    g_ThreadManager->ParallelFor(0, m_Bins.size(), [&](size_t tile) { RasterizeTile(tile % m_TileCountX, tile / m_TileCountX); });
+    BuildLevels();
+}
+
+void OcclusionCuller::TransformOccluder(const Occluder& occluder, std::vector<std::array<vec3f, 3>>& triangles) const {
+    const mat4f        transform = m_ProjView * occluder.transform;
+    std::vector<vec4f> clips;
+    clips.reserve(occluder.positions.size());
+    for (auto&& position : occluder.positions) clips.emplace_back(transform * vec4f(position, 1.0f));
+
+    triangles.reserve(occluder.indices.size() / 3);
+    for (size_t i = 0; i + 2 < occluder.indices.size(); i += 3) {
+        std::array<vec3f, 3> triangle;
+        bool                 dropped = false;
+        for (unsigned k = 0; k < 3; k++) {
+            const uint32_t index = occluder.indices[i + k];
+            if (index >= clips.size()) {
+                dropped = true;
+                break;
+            }
+            // Dropping a triangle of an occluder only occludes less, so it is not clipped
+            const vec4f& clip = clips[index];
+            if (clip.w <= 0 || clip.z < -clip.w) {
+                dropped = true;
+                break;
+            }
+            triangle[k] = vec3f((clip.x / clip.w * 0.5f + 0.5f) * m_Width, (clip.y / clip.w * 0.5f + 0.5f) * m_Height, clip.z / clip.w);
+        }
+        if (!dropped) triangles.emplace_back(triangle);
+    }
+}
+
+void OcclusionCuller::RasterizeTile(size_t tileX, size_t tileY) {
+    const auto& bin = m_Bins[tileY * m_TileCountX + tileX];
+    if (bin.empty()) return;
+
+    const size_t x0 = tileX * tileSize, y0 = tileY * tileSize;
+    const size_t x1 = std::min(m_Width, x0 + tileSize), y1 = std::min(m_Height, y0 + tileSize);
+    RasterizeDepth(m_Triangles, bin, m_Levels.front().depth.data(), m_Width, x0, y0, x1, y1);
+}
+
+void OcclusionCuller::BuildLevels() {
+    for (size_t level = 1; level < m_Levels.size(); level++) {
+        const auto& src = m_Levels[level - 1];
+        auto&       dst = m_Levels[level];
+        g_ThreadManager->ParallelFor(0, dst.height, [&](size_t y) {
+            const size_t y0 = 2 * y, y1 = std::min(2 * y + 1, src.height - 1);
+            for (size_t x = 0; x < dst.width; x++) {
+                const size_t x0 = 2 * x, x1 = std::min(2 * x + 1, src.width - 1);
+                dst.depth[y * dst.width + x] = std::max({src.depth[y0 * src.width + x0], src.depth[y0 * src.width + x1],
+                                                         src.depth[y1 * src.width + x0], src.depth[y1 * src.width + x1]});
+            }
+        });
+    }
+}
+
+bool OcclusionCuller::IsVisible(const Box& bound) const {
+    if (bound.Empty()) return true;
+
+    float left = std::numeric_limits<float>::max(), right = std::numeric_limits<float>::lowest();
+    float bottom = std::numeric_limits<float>::max(), top = std::numeric_limits<float>::lowest();
+    float nearest = std::numeric_limits<float>::max();
+    for (unsigned i = 0; i < 8; i++) {
+        const vec3f corner(i & 1 ? bound.bbMax.x : bound.bbMin.x, i & 2 ? bound.bbMax.y : bound.bbMin.y, i & 4 ? bound.bbMax.z : bound.bbMin.z);
+        const vec4f clip = m_ProjView * vec4f(corner, 1.0f);
+        // The box crosses the near plane
+        if (clip.w <= 0 || clip.z < -clip.w) return true;
+
+        const float x = (clip.x / clip.w * 0.5f + 0.5f) * m_Width;
+        const float y = (clip.y / clip.w * 0.5f + 0.5f) * m_Height;
+        left          = std::min(left, x);
+        right         = std::max(right, x);
+        bottom        = std::min(bottom, y);
+        top           = std::max(top, y);
+        nearest       = std::min(nearest, clip.z / clip.w);
+    }
+    const float maxX = m_Width - 1, maxY = m_Height - 1;
+    if (right < 0 || top < 0 || left > maxX || bottom > maxY) return false;
+
+    const size_t x0 = std::max(left, 0.0f), x1 = std::min(right, maxX);
+    const size_t y0 = std::max(bottom, 0.0f), y1 = std::min(top, maxY);
+    // The level where the rectangle covers a few texels
+    size_t level = 0;
+    while (level + 1 < m_Levels.size() && (std::max(x1 - x0, y1 - y0) >> level) > 2) level++;
+
+    // Visible if the box is nearer than the farthest depth of any texel it covers. The interpolated depth of
+    // a planar occluder may be a little nearer than the corners of its own box, so it is compared with a bias
+    const float threshold = nearest - 1e-6f * std::abs(nearest);
+    const auto& depth     = m_Levels[level];
+    for (size_t y = y0 >> level; y <= y1 >> level; y++)
+        for (size_t x = x0 >> level; x <= x1 >> level; x++)
+            if (depth.depth[y * depth.width + x] >= threshold) return true;
+    return false;
+}
+
+std::vector<std::reference_wrapper<Asset::SceneGeometryNode>> OcclusionCuller::Cull(const Asset::Scene& scene, const std::vector<std::reference_wrapper<Asset::SceneGeometryNode>>& nodes) const {
+    constexpr size_t     chunkSize = 256;
+    std::vector<uint8_t> visibility(nodes.size(), 1);
+    g_ThreadManager->ParallelFor(0, (nodes.size() + chunkSize - 1) / chunkSize, [&](size_t chunk) {
+        for (size_t i = chunk * chunkSize; i < std::min(nodes.size(), (chunk + 1) * chunkSize); i++) {
+            const auto& node = nodes[i].get();
+            if (auto geometry = scene.GetGeometry(node.GetSceneObjectHandle()))
+                visibility[i] = IsVisible(Transform(geometry->GetBoundingBox(), node.GetWorldTransform()));
+        }
+    });
+
+    std::vector<std::reference_wrapper<Asset::SceneGeometryNode>> result;
+    for (size_t i = 0; i < nodes.size(); i++)
+        if (visibility[i]) result.emplace_back(nodes[i]);
+    return result;
+}
+
+}  // namespace Hitagi::Graphics
@@ -0,0 +1,71 @@
+#pragma once
+#include "Scene.hpp"
+
+#include <span>
+
+namespace Hitagi::Graphics {
+
+// A software occlusion culler, so no result is read back from the GPU. The selected occluders are rasterized
+// into a small depth buffer on the thread pool, one task per tile, and the bounds of the geometry nodes are
+// tested against the hierarchical depth built from it. The depth is the NDC z of projView, the smaller the
+// nearer, and a texel of an upper level keeps the farthest depth of the four texels below it.
+class OcclusionCuller {
+public:
+    static constexpr size_t tileSize = 32;
+    // The nodes whose bounding sphere radius over distance is at least this are the candidates of occluders
+    static constexpr float  minOccluderSize = 0.05f;
+    static constexpr size_t maxOccluders    = 32;
+
+    OcclusionCuller(size_t width = 256, size_t height = 128);
+
+    // Clear the depth and the occluders for a new view
+    void Begin(const mat4f& projView);
+    // Add a triangle list in the local space of transform, the data must be alive until End
+    void AddOccluder(std::span<const vec3f> positions, std::span<const uint32_t> indices, const mat4f& transform);
+    // Add the meshes of LOD 0 of the largest nodes on the screen, only the triangle lists of float3 positions
+    // are used. The 16-bit indices are widened to a copy owned by the culler until the next Begin
+    void AddOccluders(const Asset::Scene& scene, const std::vector<std::reference_wrapper<Asset::SceneGeometryNode>>& nodes);
+    // Rasterize the occluders and build the hierarchical depth
+    void End();
+
+    // Whether a box in the world space may be visible
+    bool IsVisible(const Box& bound) const;
+    // Return the nodes that may be visible in the same order, the nodes without a geometry are kept
+    std::vector<std::reference_wrapper<Asset::SceneGeometryNode>> Cull(const Asset::Scene& scene, const std::vector<std::reference_wrapper<Asset::SceneGeometryNode>>& nodes) const;
+
+    size_t GetWidth() const noexcept { return m_Width; }
+    size_t GetHeight() const noexcept { return m_Height; }
+    size_t GetLevelCount() const noexcept { return m_Levels.size(); }
+    size_t GetOccluderCount() const noexcept { return m_Occluders.size(); }
+    float  GetDepth(size_t x, size_t y, size_t level = 0) const { return m_Levels[level].depth[y * m_Levels[level].width + x]; }
+
+private:
+    struct Occluder {
+        std::span<const vec3f>    positions;
+        std::span<const uint32_t> indices;
+        mat4f                     transform;
+    };
+    struct Level {
+        size_t             width, height;
+        std::vector<float> depth;
+    };
+
+    // Transform the triangles of an occluder to the screen, the ones crossing the near plane are dropped
+    void TransformOccluder(const Occluder& occluder, std::vector<std::array<vec3f, 3>>& triangles) const;
+    void RasterizeTile(size_t tileX, size_t tileY);
+    void BuildLevels();
+
+    size_t m_Width, m_Height;
+    size_t m_TileCountX, m_TileCountY;
+    mat4f  m_ProjView;
+
+    std::vector<Occluder>              m_Occluders;
+    std::vector<std::vector<uint32_t>> m_WidenedIndices;
+    std::vector<std::array<vec3f, 3>>  m_Triangles;
+    // The indices of the triangles overlapping each tile
+    std::vector<std::vector<uint32_t>> m_Bins;
+    // Level 0 is the depth buffer
+    std::vector<Level>                 m_Levels;
+};
+
+}  // namespace Hitagi::Graphics
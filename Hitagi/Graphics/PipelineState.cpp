@@ -57,6 +57,8 @@ PipelineState& PipelineState::SetPixelShader(std::shared_ptr<PixelShader> ps) {
 PipelineState& PipelineState::SetInputLayout(const std::vector<InputLayout>& inputLayout) {
     if (m_Created) throw std::logic_error("PSO has been created.");
     m_InputLayout = inputLayout;
+    for (auto&& layout : m_InputLayout)
+        layout.attribute = Asset::SceneObjectVertexArray::ParseAttributeName(layout.semanticName).first;
     return *this;
 }
 PipelineState& PipelineState::SetRootSignautre(std::shared_ptr<RootSignature> sig) {
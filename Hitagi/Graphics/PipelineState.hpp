@@ -1,6 +1,7 @@
 #pragma once
 #include "Format.hpp"
 #include "ShaderManager.hpp"
+#include "SceneObject.hpp"
 
 #include <string>
 #include <optional>
@@ -21,6 +22,8 @@ struct InputLayout {
     unsigned              inputSlot;
     size_t                alignedByOffset;
     std::optional<size_t> instanceCount;
+    // Resolved from the semantic name by PipelineState::SetInputLayout to match the mesh vertex arrays
+    Asset::VertexAttribute attribute = Asset::VertexAttribute::CUSTOM;
 };
 
 enum struct ShaderVariableType {
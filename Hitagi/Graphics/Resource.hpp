@@ -3,6 +3,7 @@
 #include "SceneObject.hpp"
 
 #include <string>
+#include <vector>
 #include <memory>
 
 namespace Hitagi::Graphics {
@@ -39,9 +40,17 @@ public:
     using ResourceContainer::ResourceContainer;
 };
 struct MeshBuffer {
-    std::unordered_map<std::string, VertexBuffer> vertices;
-    IndexBuffer                                   indices;
-    Asset::PrimitiveType                          primitive;
+    // Where a vertex attribute is in the vertex streams
+    struct VertexBinding {
+        Asset::VertexAttribute attribute;
+        uint32_t               semanticIndex;
+        size_t                 stream;
+        size_t                 offset;
+    };
+    std::vector<VertexBuffer>  vertices;
+    std::vector<VertexBinding> bindings;
+    IndexBuffer                indices;
+    Asset::PrimitiveType       primitive;
 };
 class ConstantBuffer : public ResourceContainer {
 public:
@@ -60,6 +69,11 @@ private:
 class TextureBuffer : public ResourceContainer {
 public:
     using ResourceContainer::ResourceContainer;
+    struct SubresourceData {
+        const uint8_t* data;
+        uint32_t       pitch;
+        size_t         size;
+    };
     struct Description {
         Format         format;
         uint32_t       width;
@@ -70,6 +84,8 @@ public:
         unsigned       sampleQuality   = 0;
         const uint8_t* initialData     = nullptr;
         size_t         initialDataSize = 0;
+        // The initial data of the mip levels following the first one
+        std::vector<SubresourceData> mipData;
     };
 };
 
@@ -8,14 +8,20 @@ const MeshBuffer& ResourceManager::GetMeshBuffer(Asset::SceneObjectMesh& mesh) {
     if (m_MeshBuffer.count(id) != 0)
         return m_MeshBuffer.at(id);
 
-    // Create new vertex array
-    for (auto&& vertex : mesh.GetVertexArrays()) {
-        m_MeshBuffer[id].vertices.emplace(
-            vertex.GetAttributeName(),    // attribut name
-            m_Driver.CreateVertexBuffer(  // backend vertex buffer
-                vertex.GetVertexCount(),
-                vertex.GetVertexSize(),
-                vertex.GetData()));
+    // Create new vertex buffer for each stream of the vertex layout
+    for (auto&& stream : mesh.CreateVertexStreams()) {
+        for (auto&& element : stream.elements) {
+            m_MeshBuffer[id].bindings.emplace_back(MeshBuffer::VertexBinding{
+                element.attribute,
+                element.semanticIndex,
+                m_MeshBuffer[id].vertices.size(),
+                element.offset,
+            });
+        }
+        m_MeshBuffer[id].vertices.emplace_back(m_Driver.CreateVertexBuffer(
+            stream.vertexCount,
+            stream.stride,
+            stream.data.GetData()));
     }
     // Create Index array
     auto& indexArray         = mesh.GetIndexArray();
@@ -39,16 +45,37 @@ const TextureBuffer& ResourceManager::GetTextureBuffer(Asset::SceneObjectTexture
         return GetDefaultTextureBuffer(Format::R8G8B8A8_UNORM);
     }
     Format format;
-    if (auto bitCount = image.GetBitcount(); bitCount == 8)
-        format = Format::R8_UNORM;
-    else if (bitCount == 16)
-        format = Format::R8G8_UNORM;
-    else if (bitCount == 24)
-        format = Format::R8G8B8A8_UNORM;
-    else if (bitCount == 32)
-        format = Format::R8G8B8A8_UNORM;
-    else
-        format = Format::UNKNOWN;
+    switch (image.GetFormat()) {
+        case Asset::PixelFormat::R8_UNORM:
+            format = Format::R8_UNORM;
+            break;
+        case Asset::PixelFormat::R8G8_UNORM:
+            format = Format::R8G8_UNORM;
+            break;
+        case Asset::PixelFormat::R8G8B8A8_UNORM:
+            format = Format::R8G8B8A8_UNORM;
+            break;
+        case Asset::PixelFormat::R16G16B16A16_UNORM:
+            format = Format::R16G16B16A16_UNORM;
+            break;
+        case Asset::PixelFormat::BC1_UNORM:
+            format = Format::BC1_UNORM;
+            break;
+        case Asset::PixelFormat::BC3_UNORM:
+            format = Format::BC3_UNORM;
+            break;
+        case Asset::PixelFormat::BC4_UNORM:
+            format = Format::BC4_UNORM;
+            break;
+        case Asset::PixelFormat::BC5_UNORM:
+            format = Format::BC5_UNORM;
+            break;
+        case Asset::PixelFormat::BC7_UNORM:
+            format = Format::BC7_UNORM;
+            break;
+        default:
+            format = Format::UNKNOWN;
+    }
 
     // Create new texture buffer
     TextureBuffer::Description desc = {};
@@ -58,6 +85,11 @@ const TextureBuffer& ResourceManager::GetTextureBuffer(Asset::SceneObjectTexture
     desc.pitch                      = image.GetPitch();
     desc.initialData                = image.GetData();
     desc.initialDataSize            = image.GetDataSize();
+    desc.mipLevel                   = image.GetMipLevels();
+    for (size_t level = 1; level < image.GetMipLevels(); level++) {
+        auto& mip = image.GetMip(level);
+        desc.mipData.push_back({mip.GetData(), mip.GetPitch(), mip.GetDataSize()});
+    }
 
     m_TextureBuffer.emplace(id, m_Driver.CreateTextureBuffer(texture.GetName(), desc));
     return m_TextureBuffer.at(id);
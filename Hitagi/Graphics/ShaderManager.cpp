@@ -26,20 +26,20 @@ std::string TypeToString(const ShaderType& type) {
 
 void ShaderManager::LoadShader(std::filesystem::path shaderPath, ShaderType type, std::string name) {
     auto data = g_FileIOManager->SyncOpenAndReadBinary(shaderPath);
-    if (data.Empty()) {
+    if (data->Empty()) {
         spdlog::get("GraphicsManager")->error("[ShaderManager] Give up loading shader.");
         return;
     }
     if (name.empty()) name = shaderPath.filename().string();
     switch (type) {
         case ShaderType::VERTEX:
-            m_VertexShaders.emplace(name, std::make_shared<VertexShader>(data));
+            m_VertexShaders.emplace(name, std::make_shared<VertexShader>(*data));
             break;
         case ShaderType::PIXEL:
-            m_PixelShaders.emplace(name, std::make_shared<PixelShader>(data));
+            m_PixelShaders.emplace(name, std::make_shared<PixelShader>(*data));
             break;
         case ShaderType::COMPUTE:
-            m_ComputeShaders.emplace(name, std::make_shared<ComputeShader>(data));
+            m_ComputeShaders.emplace(name, std::make_shared<ComputeShader>(*data));
         default:
             spdlog::get("GraphicsManager")->error("[ShaderManager] Unsupport shader type: {}", TypeToString(type));
     }
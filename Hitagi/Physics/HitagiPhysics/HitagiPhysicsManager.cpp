@@ -13,6 +13,7 @@ int HitagiPhysicsManager::Initialize() {
 
 void HitagiPhysicsManager::Finalize() {
     // Clean up
+    m_AABBs.clear();
 
     m_Logger->info("Finalized.");
     m_Logger = nullptr;
@@ -21,64 +22,26 @@ void HitagiPhysicsManager::Finalize() {
 void HitagiPhysicsManager::Tick() {}
 
 std::array<vec3f, 2> HitagiPhysicsManager::GetAABB(Asset::SceneGeometryNode& node) {
-    auto geometry = node.GetSceneObjectRef().lock();
-    if (!geometry) return {vec3f(0), vec3f(0)};
-
-    vec3f aabbMin = vec3f(std::numeric_limits<float>::max());
-    vec3f aabbMax = vec3f(std::numeric_limits<float>::min());
-
-    // TODO mesh lod
-    for (auto&& mesh : geometry->GetMeshes()) {
-        auto& positions    = mesh->GetVertexByName("POSITION");
-        auto  dataType     = positions.GetDataType();
-        auto  vertex_count = positions.GetVertexCount();
-        auto  data         = positions.GetData();
-
-        switch (dataType) {
-            case Asset::VertexDataType::FLOAT3: {
-                auto vertex = reinterpret_cast<const vec3f*>(data);
-                for (auto i = 0; i < vertex_count; i++, vertex++) {
-                    aabbMin = Min(aabbMin, vertex[i]);
-                    aabbMax = Max(aabbMax, vertex[i]);
-                }
-            } break;
-            case Asset::VertexDataType::DOUBLE3: {
-                auto vertex = reinterpret_cast<const vec3d*>(data);
-                for (auto i = 0; i < vertex_count; i++, vertex++) {
-                    aabbMin.x = std::min(static_cast<double>(aabbMin.x), vertex->x);
-                    aabbMin.y = std::min(static_cast<double>(aabbMin.y), vertex->y);
-                    aabbMin.z = std::min(static_cast<double>(aabbMin.z), vertex->z);
-                    aabbMax.x = std::max(static_cast<double>(aabbMax.x), vertex->x);
-                    aabbMax.y = std::max(static_cast<double>(aabbMax.y), vertex->y);
-                    aabbMax.z = std::max(static_cast<double>(aabbMax.z), vertex->z);
-                }
-            } break;
-            default:
-                assert(0);
+    if (auto iter = m_AABBs.find(&node); iter != m_AABBs.end()) {
+        auto& cache = iter->second;
+        if (cache.version != node.GetTransformVersion()) {
+            auto aabb     = Transform(cache.local, node.GetWorldTransform());
+            cache.version = node.GetTransformVersion();
+            cache.world   = {aabb.bbMin, aabb.bbMax};
         }
+        return cache.world;
     }
 
-    mat4f trans = node.GetCalculatedTransform();
-    // recalculate aabbx after transform
-    std::array<vec4f, 8> points = {
-        vec4f(aabbMin, 1),
-        vec4f(aabbMin.x, aabbMin.y, aabbMax.z, 1),
-        vec4f(aabbMin.x, aabbMax.y, aabbMax.z, 1),
-        vec4f(aabbMin.x, aabbMax.y, aabbMin.z, 1),
-        vec4f(aabbMax, 1),
-        vec4f(aabbMax.x, aabbMin.y, aabbMax.z, 1),
-        vec4f(aabbMax.x, aabbMax.y, aabbMax.z, 1),
-        vec4f(aabbMax.x, aabbMax.y, aabbMin.z, 1),
-    };
-    for (auto&& p : points) p = trans * p;
-
-    vec3f newAabbMin = vec3f(std::numeric_limits<float>::max()), newAabbMax = vec3f(std::numeric_limits<float>::min());
-    for (auto&& p : points) {
-        newAabbMin = Min(newAabbMin, vec3f(p.xyz));
-        newAabbMax = Max(newAabbMax, vec3f(p.xyz));
-    }
+    auto geometry = node.GetSceneObjectRef().lock();
+    if (!geometry) return {vec3f(0), vec3f(0)};
+
+    // The bounding box of LOD 0 is cached by the geometry
+    const Box& aabb = geometry->GetBoundingBox();
+    if (aabb.Empty()) return {vec3f(0), vec3f(0)};
 
-    return {std::move(newAabbMin), std::move(newAabbMax)};
+    // recalculate aabb after transform
+    auto world = Transform(aabb, node.GetWorldTransform());
+    return m_AABBs.emplace(&node, CachedAABB{node.GetTransformVersion(), aabb, {world.bbMin, world.bbMax}}).first->second.world;
 }
 
 void HitagiPhysicsManager::CreateRigidBody(Asset::SceneGeometryNode& node) {
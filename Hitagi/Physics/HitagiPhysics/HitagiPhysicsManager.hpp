@@ -25,6 +25,14 @@ private:
     void DrawAabb(const Geometry& geometry, const mat4f& trans, const vec3f& centerOfMass);
 #endif
 
-    std::unordered_map<std::string, RigidBody> m_RigidBodies;
+    // The box of a node is transformed again only if its transform version changed
+    struct CachedAABB {
+        uint64_t             version;
+        Box                  local;
+        std::array<vec3f, 2> world;
+    };
+
+    std::unordered_map<std::string, RigidBody>                      m_RigidBodies;
+    std::unordered_map<const Asset::SceneGeometryNode*, CachedAABB> m_AABBs;
 };
 }  // namespace Hitagi::Physics
\ No newline at end of file
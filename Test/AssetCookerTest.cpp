@@ -0,0 +1,130 @@
+#include <gtest/gtest.h>
+
+#include "MemoryManager.hpp"
+#include "ThreadManager.hpp"
+#include "AssetManager.hpp"
+#include "AssetCooker.hpp"
+#include "BinaryScene.hpp"
+
+#include <fstream>
+
+using namespace Hitagi;
+using namespace Hitagi::Asset;
+
+class AssetCookerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        m_SourceDir = std::filesystem::temp_directory_path() / "hitagi_asset_cooker_test";
+        m_OutputDir = m_SourceDir / "Cooked";
+        std::filesystem::remove_all(m_SourceDir);
+        std::filesystem::create_directories(m_SourceDir / "Textures");
+        std::filesystem::create_directories(m_SourceDir / "Shaders");
+        std::filesystem::create_directories(m_SourceDir / "Models");
+
+        std::filesystem::copy_file("Asset/Textures/avatar.png", m_SourceDir / "Textures/avatar.png");
+        WriteFile("Textures/broken.png", "not a png");
+        WriteFile("Shaders/color.hlsl", "float4 main() : SV_TARGET { return 1; }");
+        WriteFile("Models/triangle.obj", "v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 2 3\n");
+    }
+    void TearDown() override { std::filesystem::remove_all(m_SourceDir); }
+
+    void WriteFile(const std::filesystem::path& path, std::string_view content) {
+        std::ofstream ofs(m_SourceDir / path, std::ios::binary);
+        ofs << content;
+    }
+
+    std::filesystem::path m_SourceDir;
+    std::filesystem::path m_OutputDir;
+};
+
+TEST_F(AssetCookerTest, Cook) {
+    AssetCooker cooker(m_SourceDir, m_OutputDir);
+    auto        statistics = cooker.Cook();
+    EXPECT_EQ(statistics.cooked, 3);
+    EXPECT_EQ(statistics.skipped, 0);
+    EXPECT_EQ(statistics.failed, 1);
+
+    auto texturePath = cooker.GetCookedPath(m_SourceDir / "Textures/avatar.png");
+    EXPECT_EQ(texturePath, m_OutputDir / "Textures/avatar.png.htex");
+    auto image  = g_AssetManager->ParseImage(texturePath);
+    auto origin = g_AssetManager->ParseImage("Asset/Textures/avatar.png");
+    ASSERT_FALSE(image.Empty());
+    // the image is kept uncompressed if its size is not a multiple of 4
+    if (origin.GetWidth() % 4 == 0 && origin.GetHeight() % 4 == 0)
+        EXPECT_EQ(image.GetFormat(), PixelFormat::BC7_UNORM);
+    EXPECT_EQ(image.GetWidth(), origin.GetWidth());
+    EXPECT_GT(image.GetMipLevels(), 1);
+
+    auto scenePath = cooker.GetCookedPath(m_SourceDir / "Models/triangle.obj");
+    EXPECT_EQ(scenePath, m_OutputDir / "Models/triangle.obj.hscene");
+    EXPECT_TRUE(IsBinaryScene(*g_FileIOManager->SyncOpenAndReadBinary(scenePath)));
+
+    // the other files are copied
+    auto shader = g_FileIOManager->SyncOpenAndReadBinary(m_OutputDir / "Shaders/color.hlsl");
+    EXPECT_EQ(std::string_view(reinterpret_cast<const char*>(shader->GetData()), shader->GetDataSize()),
+              "float4 main() : SV_TARGET { return 1; }");
+    EXPECT_TRUE(std::filesystem::exists(m_OutputDir / AssetCooker::databaseName));
+}
+
+TEST_F(AssetCookerTest, Incremental) {
+    AssetCooker(m_SourceDir, m_OutputDir).Cook();
+
+    // nothing changes, and the failed file is tried again
+    auto statistics = AssetCooker(m_SourceDir, m_OutputDir).Cook();
+    EXPECT_EQ(statistics.cooked, 0);
+    EXPECT_EQ(statistics.skipped, 3);
+    EXPECT_EQ(statistics.failed, 1);
+
+    // the content changes
+    WriteFile("Shaders/color.hlsl", "float4 main() : SV_TARGET { return 0; }");
+    std::filesystem::remove(m_SourceDir / "Textures/broken.png");
+    statistics = AssetCooker(m_SourceDir, m_OutputDir).Cook();
+    EXPECT_EQ(statistics.cooked, 1);
+    EXPECT_EQ(statistics.skipped, 2);
+    EXPECT_EQ(statistics.failed, 0);
+
+    // the cooked file is deleted
+    AssetCooker cooker(m_SourceDir, m_OutputDir);
+    std::filesystem::remove(cooker.GetCookedPath(m_SourceDir / "Models/triangle.obj"));
+    statistics = cooker.Cook();
+    EXPECT_EQ(statistics.cooked, 1);
+    EXPECT_EQ(statistics.skipped, 2);
+
+    // the options of the textures change
+    statistics = AssetCooker(m_SourceDir, m_OutputDir, CookOptions{.generateMips = false}).Cook();
+    EXPECT_EQ(statistics.cooked, 1);
+    EXPECT_EQ(statistics.skipped, 2);
+    EXPECT_EQ(g_AssetManager->ParseImage(m_OutputDir / "Textures/avatar.png.htex").GetMipLevels(), 1);
+}
+
+TEST_F(AssetCookerTest, BrokenScene) {
+    WriteFile("Models/broken.obj", "not a scene");
+    AssetCooker cooker(m_SourceDir, m_OutputDir);
+    auto        statistics = cooker.Cook();
+    EXPECT_EQ(statistics.cooked, 3);
+    EXPECT_EQ(statistics.failed, 2);
+    EXPECT_FALSE(std::filesystem::exists(cooker.GetCookedPath(m_SourceDir / "Models/broken.obj")));
+
+    // the broken scene is not recorded, so it is tried again instead of skipped
+    statistics = AssetCooker(m_SourceDir, m_OutputDir).Cook();
+    EXPECT_EQ(statistics.cooked, 0);
+    EXPECT_EQ(statistics.skipped, 3);
+    EXPECT_EQ(statistics.failed, 2);
+}
+
+int main(int argc, char* argv[]) {
+    g_MemoryManager->Initialize();
+    g_FileIOManager->Initialize();
+    g_ThreadManager->Initialize();
+    g_AssetManager->Initialize();
+
+    ::testing::InitGoogleTest(&argc, argv);
+    int testResult = RUN_ALL_TESTS();
+
+    g_AssetManager->Finalize();
+    g_ThreadManager->Finalize();
+    g_FileIOManager->Finalize();
+    g_MemoryManager->Finalize();
+
+    return testResult;
+}
@@ -0,0 +1,247 @@
+#include <gtest/gtest.h>
+
+#include "MemoryManager.hpp"
+#include "AssetManager.hpp"
+#include "BinaryScene.hpp"
+#include "MathTestHelper.hpp"
+
+#include <cstring>
+#include <numeric>
+
+using namespace Hitagi;
+using namespace Hitagi::Asset;
+
+Core::Buffer CreateBuffer(size_t size, uint8_t seed) {
+    Core::Buffer buffer(size);
+    std::iota(buffer.GetData(), buffer.GetData() + size, seed);
+    return buffer;
+}
+
+std::unique_ptr<SceneObjectMesh> CreateMesh(const std::shared_ptr<SceneObjectMaterial>& material, uint8_t seed) {
+    auto mesh = std::make_unique<SceneObjectMesh>();
+    mesh->SetPrimitiveType(PrimitiveType::TRI_LIST);
+    mesh->AddVertexArray(SceneObjectVertexArray("POSITION", VertexDataType::FLOAT3, CreateBuffer(3 * sizeof(vec3f), seed)));
+    mesh->AddVertexArray(SceneObjectVertexArray("TEXCOORD", VertexDataType::UNORM16_2, CreateBuffer(3 * 4, seed + 1)));
+    mesh->AddIndexArray(SceneObjectIndexArray(IndexDataType::INT32, CreateBuffer(3 * sizeof(int), 0)));
+    mesh->SetMaterial(material);
+    mesh->SetVertexLayout(VertexLayout::INTERLEAVED);
+    return mesh;
+}
+
+Scene CreateScene() {
+    Scene scene("root");
+
+    auto texture  = std::make_shared<SceneObjectTexture>("Asset/Textures/avatar.png");
+    auto material = std::make_shared<SceneObjectMaterial>("material");
+    material->SetColor("diffuse", vec4f(0.1f, 0.2f, 0.3f, 1.0f));
+    material->SetParam("specular_power", 32.0f);
+    material->SetTexture("diffuse", texture);
+    material->SetTexture("normal", texture);
+    scene.Materials["material"] = material;
+
+    auto geometry = std::make_shared<SceneObjectGeometry>();
+    geometry->AddMesh(CreateMesh(material, 10));
+    geometry->AddMesh(CreateMesh(material, 20));
+    geometry->AddMesh(CreateMesh(material, 30), 1);
+    geometry->SetLODError(1, 0.05f);
+    geometry->SetIfMotionBlur(true);
+    scene.Geometries["cube"] = geometry;
+
+    scene.Cameras["camera"] = std::make_shared<SceneObjectCamera>(1.5f, 0.1f, 1000.0f, 1.0f);
+    scene.Lights["spot"]    = std::make_shared<SceneObjectSpotLight>(vec4f(1.0f), 50.0f, vec3f(0, 0, -1), 0.5f, 0.7f);
+    scene.Lights["area"]    = nullptr;
+
+    auto geometryNode = std::make_shared<SceneGeometryNode>("cube");
+    geometryNode->AddSceneObjectRef(geometry);
+    geometryNode->AppendTransform(std::make_shared<SceneObjectTranslation>(1.0f, 2.0f, 3.0f));
+    scene.GeometryNodes["cube"] = geometryNode;
+
+    auto cameraNode = std::make_shared<SceneCameraNode>("camera", vec3f(0, -5, 1));
+    cameraNode->AddSceneObjectRef(scene.Cameras["camera"]);
+    scene.CameraNodes["camera"] = cameraNode;
+
+    auto lightNode = std::make_shared<SceneLightNode>("spot");
+    lightNode->AddSceneObjectRef(scene.Lights["spot"]);
+    scene.LightNodes["spot"] = lightNode;
+
+    auto group = std::make_shared<SceneEmptyNode>("group");
+    group->AppendChild(geometryNode);
+    group->AppendChild(lightNode);
+    scene.SceneGraph->AppendChild(std::move(group));
+    scene.SceneGraph->AppendChild(cameraNode);
+    return scene;
+}
+
+void ExpectEqual(const SceneObjectMesh& lhs, const SceneObjectMesh& rhs) {
+    EXPECT_EQ(lhs.GetPrimitiveType(), rhs.GetPrimitiveType());
+    EXPECT_EQ(lhs.GetVertexLayout(), rhs.GetVertexLayout());
+    ASSERT_EQ(lhs.GetVertexArraysCount(), rhs.GetVertexArraysCount());
+    for (size_t i = 0; i < lhs.GetVertexArraysCount(); i++) {
+        auto& a = lhs.GetVertexArrays()[i];
+        auto& b = rhs.GetVertexArrays()[i];
+        EXPECT_EQ(a.GetAttributeName(), b.GetAttributeName());
+        EXPECT_EQ(a.GetDataType(), b.GetDataType());
+        ASSERT_EQ(a.GetDataSize(), b.GetDataSize());
+        EXPECT_TRUE(std::equal(a.GetData(), a.GetData() + a.GetDataSize(), b.GetData()));
+    }
+    auto& a = lhs.GetIndexArray();
+    auto& b = rhs.GetIndexArray();
+    EXPECT_EQ(a.GetIndexType(), b.GetIndexType());
+    ASSERT_EQ(a.GetDataSize(), b.GetDataSize());
+    EXPECT_TRUE(std::equal(a.GetData(), a.GetData() + a.GetDataSize(), b.GetData()));
+}
+
+TEST(BinarySceneTest, RoundTrip) {
+    auto scene  = CreateScene();
+    auto buffer = WriteBinaryScene(scene);
+    ASSERT_TRUE(IsBinaryScene(buffer));
+    auto result = BinarySceneParser().Parse(buffer, "scene.hscene");
+
+    // materials and textures
+    ASSERT_EQ(result.Materials.size(), 1);
+    auto material = result.GetMaterial("material");
+    ASSERT_NE(material, nullptr);
+    EXPECT_EQ(material->GetName(), "material");
+    vector_eq(material->GetDiffuseColor().Value, vec4f(0.1f, 0.2f, 0.3f, 1.0f));
+    EXPECT_EQ(material->GetSpecularPower().Value, 32.0f);
+    ASSERT_NE(material->GetDiffuseColor().ValueMap, nullptr);
+    EXPECT_EQ(material->GetDiffuseColor().ValueMap->GetTexturePath(), std::filesystem::path("Asset/Textures/avatar.png"));
+    // the shared texture is still shared
+    EXPECT_EQ(material->GetDiffuseColor().ValueMap, material->GetNormal().ValueMap);
+    EXPECT_EQ(material->GetSpecularColor().ValueMap, nullptr);
+
+    // geometries
+    auto geometry = result.GetGeometry("cube");
+    ASSERT_NE(geometry, nullptr);
+    auto& origin = *scene.GetGeometry("cube");
+    ASSERT_EQ(geometry->GetLODCount(), 2);
+    EXPECT_EQ(geometry->GetLODError(1), 0.05f);
+    EXPECT_TRUE(geometry->MotionBlur());
+    for (size_t lod = 0; lod < 2; lod++) {
+        ASSERT_EQ(geometry->GetMeshes(lod).size(), origin.GetMeshes(lod).size());
+        for (size_t i = 0; i < origin.GetMeshes(lod).size(); i++) {
+            ExpectEqual(*geometry->GetMeshes(lod)[i], *origin.GetMeshes(lod)[i]);
+            EXPECT_EQ(geometry->GetMeshes(lod)[i]->GetMaterial().lock(), material);
+        }
+    }
+
+    // cameras and lights
+    auto camera = result.GetCamera("camera");
+    ASSERT_NE(camera, nullptr);
+    EXPECT_EQ(camera->GetAspect(), 1.5f);
+    EXPECT_EQ(camera->GetFarClipDistance(), 1000.0f);
+    auto spot = std::dynamic_pointer_cast<SceneObjectSpotLight>(result.GetLight("spot"));
+    ASSERT_NE(spot, nullptr);
+    EXPECT_EQ(spot->GetIntensity(), 50.0f);
+    vector_eq(spot->GetDirection(), vec3f(0, 0, -1));
+    EXPECT_EQ(spot->GetOuterConeAngle(), 0.7f);
+    EXPECT_EQ(result.Lights.count("area"), 1);
+    EXPECT_EQ(result.GetLight("area"), nullptr);
+
+    // nodes
+    ASSERT_NE(result.SceneGraph, nullptr);
+    EXPECT_EQ(result.SceneGraph->GetName(), "root");
+    ASSERT_EQ(result.SceneGraph->GetChildren().size(), 2);
+    auto& group = *result.SceneGraph->GetChildren().front();
+    EXPECT_EQ(group.GetName(), "group");
+    ASSERT_EQ(group.GetChildren().size(), 2);
+    EXPECT_EQ(group.GetChildren().front(), result.GeometryNodes.at("cube"));
+
+    auto geometryNode = result.GeometryNodes.at("cube");
+    EXPECT_EQ(geometryNode->GetSceneObjectRef().lock(), geometry);
+    matrix_eq(geometryNode->GetCalculatedTransform(), scene.GeometryNodes.at("cube")->GetCalculatedTransform());
+    EXPECT_EQ(result.LightNodes.at("spot")->GetSceneObjectRef().lock(), result.GetLight("spot"));
+
+    auto cameraNode = result.GetFirstCameraNode();
+    ASSERT_NE(cameraNode, nullptr);
+    EXPECT_EQ(cameraNode->GetSceneObjectRef().lock(), camera);
+    vector_eq(cameraNode->GetCameraPosition(), scene.GetFirstCameraNode()->GetCameraPosition());
+    vector_eq(cameraNode->GetCameraLookAt(), scene.GetFirstCameraNode()->GetCameraLookAt());
+}
+
+TEST(BinarySceneTest, SharedGeometry) {
+    auto       scene = CreateScene();
+    const auto size  = WriteBinaryScene(scene).GetDataSize();
+
+    // an instance of the cube only differs in the transform
+    scene.Geometries["cube_instance"] = scene.GetGeometry("cube");
+    auto instance                     = std::make_shared<SceneGeometryNode>("cube_instance");
+    instance->AddSceneObjectRef(scene.GetGeometry("cube"));
+    instance->AppendTransform(std::make_shared<SceneObjectTranslation>(-1.0f, 0.0f, 0.0f));
+    scene.GeometryNodes["cube_instance"] = instance;
+    scene.SceneGraph->AppendChild(instance);
+
+    auto buffer = WriteBinaryScene(scene);
+    // only a geometry record and a node record are added, the meshes are not written again
+    EXPECT_LT(buffer.GetDataSize(), size + 256);
+
+    auto result   = BinarySceneParser().Parse(buffer, "scene.hscene");
+    auto geometry = result.GetGeometry("cube");
+    ASSERT_NE(geometry, nullptr);
+    EXPECT_EQ(result.GetGeometry("cube_instance"), geometry);
+    EXPECT_EQ(result.GeometryNodes.at("cube_instance")->GetSceneObjectRef().lock(), geometry);
+    EXPECT_EQ(result.GeometryNodes.at("cube")->GetSceneObjectRef().lock(), geometry);
+}
+
+TEST(BinarySceneTest, AssetManager) {
+    auto path = std::filesystem::temp_directory_path() / "hitagi_binary_scene_test.hscene";
+    ASSERT_TRUE(g_AssetManager->SaveScene(CreateScene(), path));
+
+    auto scene = g_AssetManager->ParseScene(path);
+    EXPECT_NE(scene.GetGeometry("cube"), nullptr);
+    EXPECT_NE(scene.GetFirstCameraNode(), nullptr);
+    std::filesystem::remove(path);
+}
+
+TEST(BinarySceneTest, ErrorPath) {
+    auto buffer = WriteBinaryScene(CreateScene());
+
+    // truncated
+    Core::Buffer truncated(buffer.GetData(), buffer.GetDataSize() / 2);
+    EXPECT_TRUE(BinarySceneParser().Parse(truncated, "").Geometries.empty());
+
+    // another version
+    Core::Buffer other(buffer);
+    other.GetData()[4] ^= 0xff;
+    EXPECT_TRUE(BinarySceneParser().Parse(other, "").Geometries.empty());
+
+    // The header is magic, version, file size and the {offset, count} of the strings, textures, materials,
+    // cameras, lights, geometries, meshes, vertex arrays, nodes and blob, all 4 bytes
+    auto corrupt = [&](size_t section, size_t fieldOffset, int32_t value) {
+        Core::Buffer corrupted(buffer);
+        uint32_t     recordOffset;
+        std::memcpy(&recordOffset, corrupted.GetData() + (3 + 2 * section) * sizeof(uint32_t), sizeof(uint32_t));
+        std::memcpy(corrupted.GetData() + recordOffset + fieldOffset, &value, sizeof(value));
+        return corrupted;
+    };
+    constexpr size_t meshes = 6, vertexArrays = 7, nodes = 8;
+    EXPECT_FALSE(BinarySceneParser().Parse(corrupt(nodes, 12, -1), "").Geometries.empty());
+    // the root node has a parent
+    EXPECT_TRUE(BinarySceneParser().Parse(corrupt(nodes, 12, -2), "").Geometries.empty());
+    // unknown node type
+    EXPECT_TRUE(BinarySceneParser().Parse(corrupt(nodes, 8, 7), "").Geometries.empty());
+    // unknown primitive and index types
+    EXPECT_TRUE(BinarySceneParser().Parse(corrupt(meshes, 16, 0), "").Geometries.empty());
+    EXPECT_TRUE(BinarySceneParser().Parse(corrupt(meshes, 28, 0), "").Geometries.empty());
+    // unknown vertex data type
+    EXPECT_TRUE(BinarySceneParser().Parse(corrupt(vertexArrays, 8, 0), "").Geometries.empty());
+
+    std::vector<uint8_t> junk(16, 7);
+    EXPECT_FALSE(IsBinaryScene(Core::Buffer(junk.data(), junk.size())));
+    EXPECT_TRUE(BinarySceneParser().Parse(Core::Buffer(junk.data(), junk.size()), "").Geometries.empty());
+}
+
+int main(int argc, char* argv[]) {
+    g_MemoryManager->Initialize();
+    g_FileIOManager->Initialize();
+    g_AssetManager->Initialize();
+
+    ::testing::InitGoogleTest(&argc, argv);
+    int testResult = RUN_ALL_TESTS();
+
+    g_AssetManager->Finalize();
+    g_FileIOManager->Finalize();
+    g_MemoryManager->Finalize();
+
+    return testResult;
+}
@@ -0,0 +1,120 @@
+#include <gtest/gtest.h>
+
+#include "MemoryManager.hpp"
+#include "ThreadManager.hpp"
+#include "BoundingVolumeHierarchy.hpp"
+
+#include <random>
+#include <set>
+
+using namespace Hitagi;
+using namespace Hitagi::Asset;
+
+class BoundingVolumeHierarchyTest : public ::testing::Test {
+protected:
+    // Unit cubes at random positions in [-100, 100]^3
+    void SetUp() override {
+        root = std::make_shared<BaseSceneNode>("root");
+        std::mt19937                          generator(42);
+        std::uniform_real_distribution<float> position(-100.0f, 100.0f);
+        for (size_t i = 0; i < 5000; i++) {
+            auto node = std::make_shared<SceneGeometryNode>(fmt::format("node{}", i));
+            node->AppendTransform(std::make_shared<SceneObjectTranslation>(position(generator), position(generator), position(generator)));
+            nodes.emplace_back(node.get());
+            root->AppendChild(std::move(node));
+        }
+        hierarchy.Build(*root);
+        hierarchy.Update();
+        Build();
+    }
+
+    void Build() {
+        std::vector<BoundingVolumeHierarchy::Item> items;
+        for (size_t i = 0; i < hierarchy.Size(); i++)
+            if (auto node = dynamic_cast<SceneGeometryNode*>(hierarchy.GetNode(i)))
+                items.emplace_back(BoundingVolumeHierarchy::Item{node, i, Box(vec3f(-0.5f), vec3f(0.5f))});
+        bvh.Build(hierarchy, std::move(items));
+    }
+
+    template <typename Overlap>
+    std::set<const SceneGeometryNode*> BruteForce(Overlap&& overlap) {
+        std::set<const SceneGeometryNode*> result;
+        for (auto node : nodes)
+            if (overlap(Transform(Box(vec3f(-0.5f), vec3f(0.5f)), node->GetWorldTransform()))) result.emplace(node);
+        return result;
+    }
+
+    static std::set<const SceneGeometryNode*> ToSet(const std::vector<std::reference_wrapper<SceneGeometryNode>>& nodes) {
+        std::set<const SceneGeometryNode*> result;
+        for (auto&& node : nodes) EXPECT_TRUE(result.emplace(&node.get()).second) << "duplicated node";
+        return result;
+    }
+
+    void ExpectQueries() {
+        Frustum frustum(perspective(radians(60.0f), 16.0f / 9.0f, 0.1f, 80.0f) * lookAt(vec3f(-50.0f, 0.0f, 0.0f), vec3f(1, 0.2f, 0), vec3f(0, 0, 1)));
+        EXPECT_EQ(ToSet(bvh.Query(frustum)), BruteForce([&](const Box& box) { return Intersect(frustum, box); }));
+
+        Box box(vec3f(-30.0f, -10.0f, 0.0f), vec3f(20.0f, 40.0f, 25.0f));
+        EXPECT_EQ(ToSet(bvh.Query(box)), BruteForce([&](const Box& other) { return Intersect(box, other); }));
+
+        Sphere sphere(vec3f(10.0f, -20.0f, 5.0f), 30.0f);
+        EXPECT_EQ(ToSet(bvh.Query(sphere)), BruteForce([&](const Box& other) { return Intersect(other, sphere); }));
+
+        Ray   ray(vec3f(-150.0f, 1.0f, 2.0f), normalize(vec3f(1.0f, 0.01f, 0.02f)));
+        float nearest = std::numeric_limits<float>::infinity();
+        for (auto node : nodes)
+            nearest = std::min(nearest, Intersect(ray, Transform(Box(vec3f(-0.5f), vec3f(0.5f)), node->GetWorldTransform())).value_or(nearest));
+        auto hit = bvh.Raycast(ray);
+        ASSERT_EQ(hit.has_value(), nearest != std::numeric_limits<float>::infinity());
+        if (hit) EXPECT_FLOAT_EQ(hit->distance, nearest);
+    }
+
+    std::shared_ptr<BaseSceneNode>  root;
+    std::vector<SceneGeometryNode*> nodes;
+    TransformHierarchy              hierarchy;
+    BoundingVolumeHierarchy         bvh;
+};
+
+TEST_F(BoundingVolumeHierarchyTest, Build) {
+    EXPECT_EQ(bvh.Size(), nodes.size());
+    const Box bound = bvh.GetBound();
+    for (auto node : nodes) EXPECT_TRUE(Contains(bound, GetOrigin(node->GetWorldTransform())));
+}
+
+TEST_F(BoundingVolumeHierarchyTest, Query) {
+    ExpectQueries();
+
+    // a ray missing everything
+    EXPECT_FALSE(bvh.Raycast(Ray(vec3f(0.0f, 0.0f, 200.0f), vec3f(0.0f, 0.0f, 1.0f))).has_value());
+}
+
+TEST_F(BoundingVolumeHierarchyTest, Refit) {
+    // a few nodes move, then all of them
+    for (size_t i = 0; i < 10; i++) nodes[i * 97]->ApplyTransform(translate(mat4f(1.0f), vec3f(30.0f, -20.0f, 10.0f)));
+    hierarchy.Update();
+    bvh.Refit(hierarchy);
+    ExpectQueries();
+
+    root->ApplyTransform(translate(mat4f(1.0f), vec3f(5.0f, 5.0f, 5.0f)));
+    hierarchy.Update();
+    bvh.Refit(hierarchy);
+    ExpectQueries();
+
+    // nothing moved
+    hierarchy.Update();
+    bvh.Refit(hierarchy);
+    ExpectQueries();
+}
+
+int main(int argc, char* argv[]) {
+    g_MemoryManager->Initialize();
+    g_ThreadManager->Initialize();
+
+    ::testing::InitGoogleTest(&argc, argv);
+    int testResult = RUN_ALL_TESTS();
+
+    g_ThreadManager->Finalize();
+    g_MemoryManager->Finalize();
+
+    return testResult;
+}
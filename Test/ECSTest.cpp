@@ -0,0 +1,137 @@
+#include <gtest/gtest.h>
+
+#include "MemoryManager.hpp"
+#include "ThreadManager.hpp"
+#include "SceneEntities.hpp"
+
+using namespace Hitagi;
+using namespace Hitagi::ECS;
+
+struct Position {
+    vec3f value;
+};
+struct Velocity {
+    vec3f value;
+};
+
+TEST(ECSTest, Entity) {
+    World world;
+    auto  a = world.CreateEntity();
+    auto  b = world.CreateEntity();
+    EXPECT_NE(a, b);
+    EXPECT_EQ(world.GetEntityCount(), 2);
+
+    world.DestroyEntity(a);
+    EXPECT_FALSE(world.Valid(a));
+    EXPECT_EQ(world.GetEntityCount(), 1);
+
+    // the index is reused with a new generation
+    auto c = world.CreateEntity();
+    EXPECT_EQ(c.index, a.index);
+    EXPECT_NE(c.generation, a.generation);
+    EXPECT_TRUE(world.Valid(c));
+    EXPECT_THROW(world.Emplace<Position>(a), std::invalid_argument);
+}
+
+TEST(ECSTest, Components) {
+    World world;
+    auto  a = world.CreateEntity();
+    auto  b = world.CreateEntity();
+    world.Emplace<Position>(a, vec3f(1.0f, 0.0f, 0.0f));
+    world.Emplace<Position>(b, vec3f(2.0f, 0.0f, 0.0f));
+    world.Emplace<Velocity>(b, vec3f(0.0f, 1.0f, 0.0f));
+    EXPECT_THROW(world.Emplace<Position>(a), std::logic_error);
+
+    EXPECT_TRUE(world.Has<Position>(a));
+    EXPECT_FALSE(world.Has<Velocity>(a));
+    EXPECT_EQ(world.Get<Position>(b).value.x, 2.0f);
+    EXPECT_EQ(world.TryGet<Velocity>(a), nullptr);
+
+    // the last component is moved into the hole
+    world.Remove<Position>(a);
+    EXPECT_FALSE(world.Has<Position>(a));
+    EXPECT_EQ(world.GetPool<Position>().Size(), 1);
+    EXPECT_EQ(world.Get<Position>(b).value.x, 2.0f);
+
+    // the components of a destroyed entity are removed, and not seen by the new entity of the same index
+    world.DestroyEntity(b);
+    EXPECT_EQ(world.GetPool<Position>().Size(), 0);
+    auto c = world.CreateEntity();
+    EXPECT_FALSE(world.Has<Velocity>(c));
+}
+
+TEST(ECSTest, Query) {
+    World world;
+    for (int i = 0; i < 10000; i++) {
+        auto entity = world.CreateEntity();
+        world.Emplace<Position>(entity, vec3f(i, 0.0f, 0.0f));
+        if (i % 3 == 0) world.Emplace<Velocity>(entity, vec3f(1.0f, 0.0f, 0.0f));
+    }
+
+    size_t count = 0;
+    world.Each<Position, Velocity>([&](Entity, Position& position, Velocity& velocity) {
+        EXPECT_EQ(static_cast<int>(position.value.x) % 3, 0);
+        count++;
+    });
+    EXPECT_EQ(count, 3334);
+
+    world.ParallelEach<Position, Velocity>([](Entity, Position& position, const Velocity& velocity) {
+        position.value += velocity.value;
+    });
+    size_t sum = 0;
+    world.Each<Position>([&](Entity, const Position& position) { sum += static_cast<size_t>(position.value.x); });
+    EXPECT_EQ(sum, 9999 * 10000 / 2 + 3334);
+}
+
+TEST(ECSTest, ImportScene) {
+    Asset::Scene scene("root");
+    auto         geometry = std::make_shared<Asset::SceneObjectGeometry>();
+    auto         light    = std::make_shared<Asset::SceneObjectPointLight>();
+    auto         group    = std::make_shared<Asset::BaseSceneNode>("group");
+    auto         cube     = std::make_shared<Asset::SceneGeometryNode>("cube");
+    auto         lamp     = std::make_shared<Asset::SceneLightNode>("lamp");
+    cube->AddSceneObjectRef(geometry);
+    lamp->AddSceneObjectRef(light);
+    group->AppendTransform(std::make_shared<Asset::SceneObjectTranslation>(1.0f, 2.0f, 3.0f));
+    group->AppendChild(std::shared_ptr(cube));
+    scene.SceneGraph->AppendChild(std::shared_ptr(group));
+    scene.SceneGraph->AppendChild(std::shared_ptr(lamp));
+    scene.BuildTransformHierarchy();
+    scene.UpdateTransforms();
+
+    World world;
+    auto  root = Asset::ImportScene(scene, world);
+    EXPECT_EQ(world.GetEntityCount(), 4);
+    EXPECT_EQ(world.Get<Asset::NameComponent>(root).name, "root");
+    EXPECT_FALSE(world.Has<Asset::HierarchyComponent>(root));
+
+    std::vector<Entity> geometries;
+    world.Each<Asset::GeometryComponent, Asset::HierarchyComponent>([&](Entity entity, Asset::GeometryComponent& component, Asset::HierarchyComponent& hierarchy) {
+        EXPECT_EQ(component.geometry, geometry);
+        EXPECT_EQ(world.Get<Asset::NameComponent>(hierarchy.parent).name, "group");
+        geometries.emplace_back(entity);
+    });
+    ASSERT_EQ(geometries.size(), 1);
+    EXPECT_EQ(world.GetPool<Asset::LightComponent>().Size(), 1);
+    EXPECT_NEAR((GetOrigin(world.Get<Asset::TransformComponent>(geometries[0]).world) - vec3f(1.0f, 2.0f, 3.0f)).norm(), 0.0f, 1e-5f);
+
+    // only the moved nodes are copied
+    group->ApplyTransform(translate(mat4f(1.0f), vec3f(1.0f, 0.0f, 0.0f)));
+    scene.UpdateTransforms();
+    Asset::SyncTransforms(world);
+    EXPECT_NEAR((GetOrigin(world.Get<Asset::TransformComponent>(geometries[0]).world) - vec3f(2.0f, 2.0f, 3.0f)).norm(), 0.0f, 1e-5f);
+    EXPECT_EQ(world.Get<Asset::TransformComponent>(geometries[0]).version, cube->GetTransformVersion());
+}
+
+int main(int argc, char* argv[]) {
+    g_MemoryManager->Initialize();
+    g_ThreadManager->Initialize();
+
+    ::testing::InitGoogleTest(&argc, argv);
+    int testResult = RUN_ALL_TESTS();
+
+    g_ThreadManager->Finalize();
+    g_MemoryManager->Finalize();
+
+    return testResult;
+}
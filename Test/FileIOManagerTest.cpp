@@ -11,8 +11,8 @@ int main(int argc, char const* argv[]) {
 
     auto buffer = g_FileIOManager->SyncOpenAndReadBinary("Asset/Shaders/basic.vs");
 
-    for (size_t i = 0; i < buffer.GetDataSize(); i++) {
-        std::cout << buffer.GetData()[i];
+    for (size_t i = 0; i < buffer->GetDataSize(); i++) {
+        std::cout << buffer->GetData()[i];
     }
     std::cout << std::endl;
 
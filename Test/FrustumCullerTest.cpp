@@ -0,0 +1,67 @@
+#include <gtest/gtest.h>
+
+#include "MemoryManager.hpp"
+#include "ThreadManager.hpp"
+#include "FrustumCuller.hpp"
+
+#include <random>
+#include <set>
+
+using namespace Hitagi;
+using namespace Hitagi::Asset;
+
+TEST(FrustumCullerTest, Cull) {
+    // More nodes than a chunk, so the chunks are tested on the thread pool
+    auto                                  root = std::make_shared<BaseSceneNode>("root");
+    std::vector<SceneGeometryNode*>       nodes;
+    std::mt19937                          generator(7);
+    std::uniform_real_distribution<float> position(-100.0f, 100.0f);
+    for (size_t i = 0; i < 3 * Graphics::FrustumCuller::chunkSize + 17; i++) {
+        auto node = std::make_shared<SceneGeometryNode>(fmt::format("node{}", i));
+        node->AppendTransform(std::make_shared<SceneObjectTranslation>(position(generator), position(generator), position(generator)));
+        nodes.emplace_back(node.get());
+        root->AppendChild(std::move(node));
+    }
+    TransformHierarchy hierarchy(*root);
+    hierarchy.Update();
+
+    const Box                                  unit(vec3f(-0.5f), vec3f(0.5f));
+    std::vector<BoundingVolumeHierarchy::Item> items;
+    for (size_t i = 0; i < hierarchy.Size(); i++)
+        if (auto node = dynamic_cast<SceneGeometryNode*>(hierarchy.GetNode(i)))
+            items.emplace_back(BoundingVolumeHierarchy::Item{node, i, unit});
+    BoundingVolumeHierarchy bvh;
+    bvh.Build(hierarchy, std::move(items));
+
+    Graphics::FrustumCuller culler;
+    Frustum                 frustum(perspective(radians(60.0f), 16.0f / 9.0f, 0.1f, 120.0f) * lookAt(vec3f(0.0f), vec3f(1.0f, 0.3f, 0.1f), vec3f(0, 0, 1)));
+
+    std::set<const SceneGeometryNode*> expected;
+    for (auto node : nodes)
+        if (Intersect(frustum, Transform(unit, node->GetWorldTransform()))) expected.emplace(node);
+
+    std::set<const SceneGeometryNode*> visible;
+    for (auto&& node : culler.Cull(bvh, frustum)) visible.emplace(&node.get());
+    EXPECT_FALSE(expected.empty());
+    EXPECT_LT(expected.size(), nodes.size());
+    EXPECT_EQ(visible, expected);
+
+    // The visible nodes change after the nodes move
+    root->ApplyTransform(translate(mat4f(1.0f), vec3f(500.0f, 0.0f, 0.0f)));
+    hierarchy.Update();
+    bvh.Refit(hierarchy);
+    EXPECT_TRUE(culler.Cull(bvh, frustum).empty());
+}
+
+int main(int argc, char* argv[]) {
+    g_MemoryManager->Initialize();
+    g_ThreadManager->Initialize();
+
+    ::testing::InitGoogleTest(&argc, argv);
+    int testResult = RUN_ALL_TESTS();
+
+    g_ThreadManager->Finalize();
+    g_MemoryManager->Finalize();
+
+    return testResult;
+}
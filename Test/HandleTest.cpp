@@ -0,0 +1,74 @@
+#include <gtest/gtest.h>
+
+#include "MemoryManager.hpp"
+#include "ThreadManager.hpp"
+#include "Scene.hpp"
+
+using namespace Hitagi;
+
+TEST(HandleTest, Pool) {
+    Core::HandlePool<int> pool;
+    auto                  a = pool.Add(std::make_shared<int>(1));
+    auto                  b = pool.Add(std::make_shared<int>(2));
+    EXPECT_EQ(*pool.Get(a), 1);
+    EXPECT_EQ(*pool.Get(b), 2);
+    EXPECT_EQ(pool.Get(Core::Handle<int>{}), nullptr);
+    EXPECT_EQ(pool.Size(), 2);
+
+    // the slot is reused with a new generation, so the old handle is invalid
+    pool.Remove(a);
+    EXPECT_FALSE(pool.Valid(a));
+    auto c = pool.Add(std::make_shared<int>(3));
+    EXPECT_EQ(c.index, a.index);
+    EXPECT_EQ(pool.Get(a), nullptr);
+    EXPECT_EQ(*pool.Get(c), 3);
+
+    pool.Clear();
+    EXPECT_EQ(pool.Size(), 0);
+    EXPECT_EQ(pool.Get(b), nullptr);
+    EXPECT_EQ(pool.Get(c), nullptr);
+}
+
+TEST(HandleTest, SceneObjects) {
+    Asset::Scene scene("root");
+    auto         material = std::make_shared<Asset::SceneObjectMaterial>("material");
+    auto         mesh     = std::make_unique<Asset::SceneObjectMesh>();
+    mesh->SetMaterial(material);
+    auto meshPtr  = mesh.get();
+    auto geometry = std::make_shared<Asset::SceneObjectGeometry>();
+    geometry->AddMesh(std::move(mesh));
+    auto light = std::make_shared<Asset::SceneObjectPointLight>();
+
+    auto cube = std::make_shared<Asset::SceneGeometryNode>("cube");
+    auto lamp = std::make_shared<Asset::SceneLightNode>("lamp");
+    cube->AddSceneObjectRef(geometry);
+    lamp->AddSceneObjectRef(light);
+    // the geometry and the material are not in the object maps, but referenced by the nodes only
+    scene.GeometryNodes.emplace("cube", cube);
+    scene.LightNodes.emplace("lamp", lamp);
+    scene.Lights.emplace("light", light);
+    scene.RegisterObjects();
+
+    EXPECT_EQ(scene.GetGeometry(cube->GetSceneObjectHandle()), geometry.get());
+    EXPECT_EQ(scene.GetLight(lamp->GetSceneObjectHandle()), light.get());
+    EXPECT_EQ(scene.GetMaterial(meshPtr->GetMaterialHandle()), material.get());
+
+    // the handles of the last registration are invalid
+    auto oldHandle = cube->GetSceneObjectHandle();
+    scene.RegisterObjects();
+    EXPECT_EQ(scene.GetGeometry(oldHandle), nullptr);
+    EXPECT_EQ(scene.GetGeometry(cube->GetSceneObjectHandle()), geometry.get());
+}
+
+int main(int argc, char* argv[]) {
+    g_MemoryManager->Initialize();
+    g_ThreadManager->Initialize();
+
+    ::testing::InitGoogleTest(&argc, argv);
+    int testResult = RUN_ALL_TESTS();
+
+    g_ThreadManager->Finalize();
+    g_MemoryManager->Finalize();
+
+    return testResult;
+}
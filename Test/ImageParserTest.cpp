@@ -1,7 +1,18 @@
 #include <gtest/gtest.h>
 
 #include "MemoryManager.hpp"
+#include "ThreadManager.hpp"
 #include "AssetManager.hpp"
+#include "PixelConversion.hpp"
+#include "TGA.hpp"
+#include "BMP.hpp"
+#include "PNG.hpp"
+#include "JPEG.hpp"
+#include "BinaryImage.hpp"
+
+#include <array>
+#include <cstring>
+#include <numeric>
 
 using namespace Hitagi;
 
@@ -17,6 +28,21 @@ TEST(ImageParserTest, Jpeg) {
     EXPECT_TRUE(!image.Empty());
 }
 
+TEST(ImageParserTest, JpegScale) {
+    const auto buffer = g_FileIOManager->SyncOpenAndReadBinary("Asset/Textures/avatar.jpg");
+    auto       full   = Asset::JpegParser().Parse(*buffer);
+    ASSERT_FALSE(full.Empty());
+    for (unsigned scale : {2u, 4u, 8u}) {
+        auto image = Asset::JpegParser(scale).Parse(*buffer);
+        EXPECT_EQ(image.GetWidth(), (full.GetWidth() + scale - 1) / scale);
+        EXPECT_EQ(image.GetHeight(), (full.GetHeight() + scale - 1) / scale);
+    }
+    EXPECT_THROW(Asset::JpegParser(3), std::invalid_argument);
+
+    std::vector<uint8_t> junk(100, 7);
+    EXPECT_TRUE(Asset::JpegParser().Parse(Core::Buffer(junk.data(), junk.size())).Empty());
+}
+
 TEST(ImageParserTest, Tga) {
     auto image = g_AssetManager->ParseImage("Asset/Textures/avatar.tga");
     EXPECT_TRUE(!image.Empty());
@@ -32,15 +58,280 @@ TEST(ImageParserTest, bmp) {
     EXPECT_TRUE(!image.Empty());
 }
 
+std::array<uint8_t, 4> GetPixel(const Asset::Image& image, uint32_t x, uint32_t y) {
+    const uint8_t* p = image.GetData() + y * image.GetPitch() + 4 * x;
+    return {p[0], p[1], p[2], p[3]};
+}
+
+TEST(ImageParserTest, PixelConversion) {
+    std::array<uint8_t, 8> out;
+
+    const std::array<uint8_t, 6> bgr = {1, 2, 3, 4, 5, 6};
+    Asset::BGRToRGBA8(bgr, out);
+    EXPECT_EQ(out, (std::array<uint8_t, 8>{3, 2, 1, 255, 6, 5, 4, 255}));
+
+    const std::array<uint8_t, 4> grayAlpha = {10, 20, 30, 40};
+    Asset::GrayAlphaToRGBA8(grayAlpha, out);
+    EXPECT_EQ(out, (std::array<uint8_t, 8>{10, 10, 10, 20, 30, 30, 30, 40}));
+
+    // 5 and 6 bits channels are expanded to the full range
+    const std::array<uint8_t, 4> rgb565 = {0xff, 0xff, 0x1f, 0x00};
+    Asset::RGB565ToRGBA8(rgb565, out);
+    EXPECT_EQ(out, (std::array<uint8_t, 8>{255, 255, 255, 255, 0, 0, 255, 255}));
+
+    // blue 0x10, the alpha bit is clear
+    const std::array<uint8_t, 4> rgb555 = {0x10, 0x00, 0x00, 0xfc};
+    Asset::RGB555ToRGBA8(rgb555, out, true);
+    EXPECT_EQ(out, (std::array<uint8_t, 8>{0, 0, 132, 0, 255, 0, 0, 255}));
+}
+
+TEST(ImageParserTest, TgaPixelFormats) {
+    // 2x2 pixels, 24 bits BGR, the first row in file is the top row when the origin bit is set
+    std::vector<uint8_t> file = {0, 0, 2, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2, 0, 2, 0, 24, 0x20};
+    file.insert(file.end(), {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12});
+
+    Asset::TgaParser parser;
+    auto             image = parser.Parse(Core::Buffer(file.data(), file.size()));
+    ASSERT_FALSE(image.Empty());
+    // bottom up rows
+    EXPECT_EQ(GetPixel(image, 0, 1), (std::array<uint8_t, 4>{3, 2, 1, 255}));
+    EXPECT_EQ(GetPixel(image, 1, 0), (std::array<uint8_t, 4>{12, 11, 10, 255}));
+
+    // 16 bits with 1 bit alpha and the default bottom left origin
+    file  = {0, 0, 2, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 1, 0, 16, 0x01, 0xe0, 0x83};
+    image = parser.Parse(Core::Buffer(file.data(), file.size()));
+    ASSERT_FALSE(image.Empty());
+    EXPECT_EQ(GetPixel(image, 0, 0), (std::array<uint8_t, 4>{0, 255, 0, 255}));
+
+    // truncated
+    file.pop_back();
+    EXPECT_TRUE(parser.Parse(Core::Buffer(file.data(), file.size())).Empty());
+}
+
+TEST(ImageParserTest, BmpPixelFormats) {
+    // 3x2 pixels, 24 bits, rows are padded to 12 bytes
+    std::vector<uint8_t> file(54, 0);
+    auto                 write = [&](size_t offset, uint32_t value, size_t size) {
+        for (size_t i = 0; i < size; i++) file[offset + i] = (value >> (8 * i)) & 0xff;
+    };
+    write(0, 0x4D42, 2);
+    write(10, 54, 4);
+    write(14, 40, 4);
+    write(18, 3, 4);
+    write(22, 2, 4);
+    write(26, 1, 2);
+    write(28, 24, 2);
+    file.insert(file.end(), {1, 2, 3, 4, 5, 6, 7, 8, 9, 0, 0, 0, 11, 12, 13, 14, 15, 16, 17, 18, 19, 0, 0, 0});
+
+    Asset::BmpParser parser;
+    auto             image = parser.Parse(Core::Buffer(file.data(), file.size()));
+    ASSERT_FALSE(image.Empty());
+    EXPECT_EQ(GetPixel(image, 0, 0), (std::array<uint8_t, 4>{3, 2, 1, 255}));
+    EXPECT_EQ(GetPixel(image, 2, 1), (std::array<uint8_t, 4>{19, 18, 17, 255}));
+
+    // negative height, the rows are from top to bottom
+    write(22, static_cast<uint32_t>(-2), 4);
+    image = parser.Parse(Core::Buffer(file.data(), file.size()));
+    EXPECT_EQ(GetPixel(image, 0, 1), (std::array<uint8_t, 4>{3, 2, 1, 255}));
+    EXPECT_EQ(GetPixel(image, 2, 0), (std::array<uint8_t, 4>{19, 18, 17, 255}));
+
+    // 1x1 16 bits BI_BITFIELDS with a BITMAPV5HEADER, the 5-6-5 masks are in the header
+    file.assign(14 + 124, 0);
+    write(0, 0x4D42, 2);
+    write(10, 14 + 124, 4);
+    write(14, 124, 4);
+    write(18, 1, 4);
+    write(22, 1, 4);
+    write(26, 1, 2);
+    write(28, 16, 2);
+    write(30, 3, 4);
+    write(54, 0xF800, 4);
+    write(58, 0x07E0, 4);
+    write(62, 0x001F, 4);
+    file.insert(file.end(), {0xE0, 0x07, 0, 0});
+    image = parser.Parse(Core::Buffer(file.data(), file.size()));
+    ASSERT_FALSE(image.Empty());
+    EXPECT_EQ(GetPixel(image, 0, 0), (std::array<uint8_t, 4>{0, 255, 0, 255}));
+
+    // a BITMAPINFOHEADER whose masks are cut off
+    file.resize(14 + 40 + 4);
+    write(14, 40, 4);
+    write(10, 14 + 40, 4);
+    EXPECT_TRUE(parser.Parse(Core::Buffer(file.data(), file.size())).Empty());
+}
+
+TEST(ImageParserTest, PngTransforms) {
+    // 2x1 16 bits RGB: {0x1234, 0x5678, 0x9abc}, {0xffff, 0x0000, 0x8001}
+    const std::vector<uint8_t> rgb16 = {
+        0x89, 0x50, 0x4e, 0x47, 0x0d, 0x0a, 0x1a, 0x0a, 0x00, 0x00, 0x00, 0x0d, 0x49, 0x48, 0x44, 0x52,
+        0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x01, 0x10, 0x02, 0x00, 0x00, 0x00, 0x2b, 0xd0, 0x34,
+        0x9e, 0x00, 0x00, 0x00, 0x15, 0x49, 0x44, 0x41, 0x54, 0x78, 0xda, 0x63, 0x10, 0x32, 0x09, 0xab,
+        0x98, 0xb5, 0xe7, 0xff, 0x7f, 0x06, 0x86, 0x06, 0x46, 0x00, 0x20, 0x9f, 0x04, 0xea, 0x7c, 0x07,
+        0xd8, 0x5b, 0x00, 0x00, 0x00, 0x00, 0x49, 0x45, 0x4e, 0x44, 0xae, 0x42, 0x60, 0x82,
+    };
+    // 2x1 palette with tRNS: opaque red, blue with alpha 0x40
+    const std::vector<uint8_t> palette = {
+        0x89, 0x50, 0x4e, 0x47, 0x0d, 0x0a, 0x1a, 0x0a, 0x00, 0x00, 0x00, 0x0d, 0x49, 0x48, 0x44, 0x52,
+        0x00, 0x00, 0x00, 0x02, 0x00, 0x00, 0x00, 0x01, 0x08, 0x03, 0x00, 0x00, 0x00, 0xc3, 0xfc, 0x8f,
+        0xb8, 0x00, 0x00, 0x00, 0x06, 0x50, 0x4c, 0x54, 0x45, 0xff, 0x00, 0x00, 0x00, 0x00, 0xff, 0x6c,
+        0xa1, 0xfd, 0x8e, 0x00, 0x00, 0x00, 0x02, 0x74, 0x52, 0x4e, 0x53, 0xff, 0x40, 0x93, 0x6b, 0x71,
+        0xda, 0x00, 0x00, 0x00, 0x0b, 0x49, 0x44, 0x41, 0x54, 0x78, 0xda, 0x63, 0x60, 0x60, 0x04, 0x00,
+        0x00, 0x04, 0x00, 0x02, 0x2c, 0xde, 0x48, 0xad, 0x00, 0x00, 0x00, 0x00, 0x49, 0x45, 0x4e, 0x44,
+        0xae, 0x42, 0x60, 0x82,
+    };
+    // 3x3 Adam7 interlaced gray, the pixel value is 10 * (3 * y + x) from the top left
+    const std::vector<uint8_t> interlaced = {
+        0x89, 0x50, 0x4e, 0x47, 0x0d, 0x0a, 0x1a, 0x0a, 0x00, 0x00, 0x00, 0x0d, 0x49, 0x48, 0x44, 0x52,
+        0x00, 0x00, 0x00, 0x03, 0x00, 0x00, 0x00, 0x03, 0x08, 0x00, 0x00, 0x00, 0x01, 0x04, 0x44, 0xda,
+        0xf5, 0x00, 0x00, 0x00, 0x17, 0x49, 0x44, 0x41, 0x54, 0x78, 0xda, 0x63, 0x60, 0x60, 0x10, 0x61,
+        0xb0, 0x09, 0x60, 0xe0, 0x62, 0x70, 0x63, 0x90, 0xd3, 0x30, 0x02, 0x00, 0x08, 0xa7, 0x01, 0x69,
+        0x85, 0x60, 0xee, 0x25, 0x00, 0x00, 0x00, 0x00, 0x49, 0x45, 0x4e, 0x44, 0xae, 0x42, 0x60, 0x82,
+    };
+
+    Asset::PngParser parser;
+    auto             image = parser.Parse(Core::Buffer(rgb16.data(), rgb16.size()));
+    ASSERT_FALSE(image.Empty());
+    EXPECT_EQ(image.GetFormat(), Asset::PixelFormat::R8G8B8A8_UNORM);
+    EXPECT_EQ(GetPixel(image, 0, 0), (std::array<uint8_t, 4>{0x12, 0x56, 0x9a, 0xff}));
+
+    Asset::PngParser parser16(true);
+    image = parser16.Parse(Core::Buffer(rgb16.data(), rgb16.size()));
+    ASSERT_FALSE(image.Empty());
+    EXPECT_EQ(image.GetFormat(), Asset::PixelFormat::R16G16B16A16_UNORM);
+    const auto* pixels = reinterpret_cast<const uint16_t*>(image.GetData());
+    EXPECT_EQ(std::vector<uint16_t>(pixels, pixels + 8), (std::vector<uint16_t>{0x1234, 0x5678, 0x9abc, 0xffff, 0xffff, 0x0000, 0x8001, 0xffff}));
+    // 8 bits png is not widened
+    EXPECT_EQ(parser16.Parse(Core::Buffer(palette.data(), palette.size())).GetFormat(), Asset::PixelFormat::R8G8B8A8_UNORM);
+
+    image = parser.Parse(Core::Buffer(palette.data(), palette.size()));
+    ASSERT_FALSE(image.Empty());
+    EXPECT_EQ(GetPixel(image, 0, 0), (std::array<uint8_t, 4>{255, 0, 0, 255}));
+    EXPECT_EQ(GetPixel(image, 1, 0), (std::array<uint8_t, 4>{0, 0, 255, 0x40}));
+
+    image = parser.Parse(Core::Buffer(interlaced.data(), interlaced.size()));
+    ASSERT_FALSE(image.Empty());
+    for (uint32_t y = 0; y < 3; y++) {
+        for (uint32_t x = 0; x < 3; x++) {
+            const auto value = static_cast<uint8_t>(10 * (3 * y + x));
+            // bottom up rows
+            EXPECT_EQ(GetPixel(image, x, 2 - y), (std::array<uint8_t, 4>{value, value, value, 255}));
+        }
+    }
+}
+
+TEST(ImageParserTest, BinaryImage) {
+    Asset::Image image(8, 4, Asset::PixelFormat::R8G8B8A8_UNORM, 32, 128);
+    std::iota(image.GetData(), image.GetData() + image.GetDataSize(), 0);
+    const auto buffer = Asset::WriteBinaryImage(image);
+
+    Asset::BinaryImageParser parser;
+    auto                     result = parser.Parse(buffer);
+    ASSERT_FALSE(result.Empty());
+    EXPECT_EQ(result.GetWidth(), 8);
+    EXPECT_TRUE(std::equal(result.GetData(), result.GetData() + result.GetDataSize(), image.GetData()));
+
+    // The header is magic, version, format and mip levels, then a record of width, height, pitch,
+    // offset and size per level, all 4 bytes
+    auto corrupt = [&](size_t offset, uint32_t value) {
+        Core::Buffer corrupted(buffer);
+        std::memcpy(corrupted.GetData() + offset, &value, sizeof(value));
+        return parser.Parse(corrupted);
+    };
+    // unknown format
+    EXPECT_TRUE(corrupt(8, 99).Empty());
+    EXPECT_TRUE(corrupt(8, static_cast<uint32_t>(Asset::PixelFormat::UNKNOWN)).Empty());
+    // empty level
+    EXPECT_TRUE(corrupt(16, 0).Empty());
+    // the pitch is smaller than a row
+    EXPECT_TRUE(corrupt(24, 16).Empty());
+    // the level is smaller than pitch * height
+    EXPECT_TRUE(corrupt(32, 64).Empty());
+}
+
+TEST(ImageParserTest, DetectFormat) {
+    auto detect = [](std::vector<uint8_t> data) {
+        return Asset::DetectImageFormat(Core::Buffer(data.data(), data.size()));
+    };
+    EXPECT_EQ(detect({0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n', 0}), Asset::ImageFormat::PNG);
+    EXPECT_EQ(detect({0xff, 0xd8, 0xff, 0xe0}), Asset::ImageFormat::JPEG);
+    EXPECT_EQ(detect({'B', 'M', 0, 0}), Asset::ImageFormat::BMP);
+    EXPECT_EQ(detect({'H', 'T', 'E', 'X', 1, 0}), Asset::ImageFormat::HTEX);
+    EXPECT_EQ(detect({0x89, 'P', 'N'}), Asset::ImageFormat::NUM_SUPPORT);
+
+    std::vector<uint8_t> tga(18 + 26, 0);
+    std::string_view     footer = "TRUEVISION-XFILE.";
+    std::copy(footer.begin(), footer.end(), tga.end() - footer.size() - 1);
+    EXPECT_EQ(detect(tga), Asset::ImageFormat::TGA);
+    EXPECT_EQ(detect(std::vector<uint8_t>(44, 0)), Asset::ImageFormat::NUM_SUPPORT);
+
+    // the content wins over a wrong extension
+    auto path = std::filesystem::temp_directory_path() / "hitagi_detect_format.tga";
+    std::filesystem::copy_file("Asset/Textures/avatar.png", path, std::filesystem::copy_options::overwrite_existing);
+    auto image = g_AssetManager->ParseImage(path);
+    EXPECT_FALSE(image.Empty());
+    EXPECT_EQ(image.GetWidth(), g_AssetManager->ParseImage("Asset/Textures/avatar.png").GetWidth());
+    std::filesystem::remove(path);
+}
+
+TEST(ImageParserTest, ParseImagesAsync) {
+    std::vector<std::filesystem::path> paths = {
+        "Asset/Textures/avatar.jpg",
+        "Asset/Textures/avatar.png",
+        "Asset/Textures/avatar.tga",
+        "Asset/Textures/test.bmp",
+        "Asset/Textures/a.jpg",
+        "Asset/Textures/avatar.png",
+    };
+    auto futures = g_AssetManager->ParseImagesAsync(paths);
+    ASSERT_EQ(futures.size(), paths.size());
+    for (size_t i = 0; i < paths.size(); i++) {
+        auto image    = futures[i].get();
+        auto expected = g_AssetManager->ParseImage(paths[i]);
+        ASSERT_EQ(image.Empty(), expected.Empty()) << paths[i];
+        if (expected.Empty()) continue;
+        EXPECT_EQ(image.GetWidth(), expected.GetWidth());
+        EXPECT_EQ(image.GetHeight(), expected.GetHeight());
+        EXPECT_TRUE(std::equal(image.GetData(), image.GetData() + image.GetDataSize(), expected.GetData())) << paths[i];
+    }
+}
+
+TEST(ImageParserTest, TextureCache) {
+    std::weak_ptr<const Asset::Image> released;
+    {
+        std::vector<std::future<std::shared_ptr<const Asset::Image>>> futures;
+        for (size_t i = 0; i < 16; i++)
+            futures.emplace_back(g_ThreadManager->RunTask([] { return g_AssetManager->LoadTextureImage("Asset/Textures/avatar.png", true); }));
+
+        auto image = g_AssetManager->LoadTextureImage("Asset/Textures/avatar.png", true);
+        ASSERT_FALSE(image->Empty());
+        for (auto&& future : futures) EXPECT_EQ(future.get(), image);
+
+        // the settings are part of the key
+        g_AssetManager->SetTextureMipGeneration(false);
+        auto withoutMips = g_AssetManager->LoadTextureImage("Asset/Textures/avatar.png", true);
+        g_AssetManager->SetTextureMipGeneration(true);
+        EXPECT_NE(withoutMips, image);
+        EXPECT_EQ(withoutMips->GetMipLevels(), 1);
+        EXPECT_GT(image->GetMipLevels(), 1);
+
+        released = image;
+    }
+    // released with the last user
+    EXPECT_TRUE(released.expired());
+    EXPECT_FALSE(g_AssetManager->LoadTextureImage("Asset/Textures/avatar.png", true)->Empty());
+}
+
 int main(int argc, char* argv[]) {
     g_MemoryManager->Initialize();
     g_FileIOManager->Initialize();
+    g_ThreadManager->Initialize();
     g_AssetManager->Initialize();
 
     ::testing::InitGoogleTest(&argc, argv);
     int testResult = RUN_ALL_TESTS();
 
     g_AssetManager->Finalize();
+    g_ThreadManager->Finalize();
     g_FileIOManager->Finalize();
     g_MemoryManager->Finalize();
 
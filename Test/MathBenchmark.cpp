@@ -0,0 +1,275 @@
+#include "HitagiMath.hpp"
+#include <benchmark/benchmark.h>
+
+#include <random>
+
+using namespace Hitagi;
+
+// The first argument of every benchmark selects the path:
+// 0 the ispc kernels (the dispatcher picks the best ISA), 1 the scalar fallback.
+enum struct Path : int64_t {
+    Ispc   = 0,
+    Scalar = 1,
+};
+
+void SelectPath(benchmark::State& state) {
+    const bool scalar = static_cast<Path>(state.range(0)) == Path::Scalar;
+#if defined(USE_ISPC)
+    ispc::ForceScalar(scalar);
+    if (scalar) {
+        state.SetLabel("scalar");
+        return;
+    }
+    switch (ispc::GetISA()) {
+        case ispc::ISA::SSE4:
+            state.SetLabel("ispc-sse4");
+            break;
+        case ispc::ISA::AVX2:
+            state.SetLabel("ispc-avx2");
+            break;
+        case ispc::ISA::AVX512:
+            state.SetLabel("ispc-avx512");
+            break;
+        default:
+            state.SetLabel(ispc::IsSupported() ? "ispc-host" : "scalar");
+    }
+#else
+    if (!scalar) state.SkipWithError("built without USE_ISPC");
+    state.SetLabel("scalar");
+#endif
+}
+
+// ns per element and element throughput
+void ReportItems(benchmark::State& state, int64_t itemsPerIteration) {
+    state.SetItemsProcessed(state.iterations() * itemsPerIteration);
+    state.counters["time/item"] = benchmark::Counter(
+        static_cast<double>(itemsPerIteration),
+        benchmark::Counter::kIsIterationInvariantRate | benchmark::Counter::kInvert);
+}
+
+template <typename T>
+std::vector<T> RandomVectors(size_t count, float min = -10.0f, float max = 10.0f) {
+    std::mt19937                          engine(42);
+    std::uniform_real_distribution<float> dist(min, max);
+
+    std::vector<T> result(count);
+    for (auto&& v : result)
+        for (auto&& e : v.data) e = dist(engine);
+    return result;
+}
+
+mat4f RandomTransform(std::mt19937& engine) {
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+    return translate(rotate(scale(mat4f(1.0f), vec3f(1.5f)), dist(engine), vec3f(dist(engine), dist(engine), 1.0f)),
+                     vec3f(dist(engine), dist(engine), dist(engine)) * 10.0f);
+}
+
+//---------------------------------------------------------------
+// Vector
+//---------------------------------------------------------------
+template <typename Vec>
+void BM_VectorAdd(benchmark::State& state) {
+    SelectPath(state);
+    auto a = RandomVectors<Vec>(1), b = RandomVectors<Vec>(1);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(a[0] = a[0] + b[0]);
+    }
+    ReportItems(state, 1);
+}
+
+template <typename Vec>
+void BM_VectorDot(benchmark::State& state) {
+    SelectPath(state);
+    auto a = RandomVectors<Vec>(1), b = RandomVectors<Vec>(1);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(dot(a[0], b[0]));
+        benchmark::ClobberMemory();
+    }
+    ReportItems(state, 1);
+}
+
+void BM_VectorNormalize(benchmark::State& state) {
+    SelectPath(state);
+    auto v = RandomVectors<vec3f>(1);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(normalize(v[0]));
+        benchmark::ClobberMemory();
+    }
+    ReportItems(state, 1);
+}
+
+//---------------------------------------------------------------
+// Matrix
+//---------------------------------------------------------------
+void BM_MatrixMultiply(benchmark::State& state) {
+    SelectPath(state);
+    std::mt19937 engine(42);
+    mat4f        a = RandomTransform(engine), b = RandomTransform(engine);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(a * b);
+        benchmark::ClobberMemory();
+    }
+    ReportItems(state, 1);
+}
+
+void BM_MatrixVector(benchmark::State& state) {
+    SelectPath(state);
+    std::mt19937 engine(42);
+    mat4f        a = RandomTransform(engine);
+    vec4f        v(1, 2, 3, 1);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(a * v);
+        benchmark::ClobberMemory();
+    }
+    ReportItems(state, 1);
+}
+
+void BM_MatrixInverse(benchmark::State& state) {
+    SelectPath(state);
+    std::mt19937 engine(42);
+    mat4f        a = RandomTransform(engine);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(inverse(a));
+        benchmark::ClobberMemory();
+    }
+    ReportItems(state, 1);
+}
+
+void BM_MatrixTranspose(benchmark::State& state) {
+    SelectPath(state);
+    std::mt19937 engine(42);
+    mat4f        a = RandomTransform(engine);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(transpose(a));
+        benchmark::ClobberMemory();
+    }
+    ReportItems(state, 1);
+}
+
+void BM_LookAt(benchmark::State& state) {
+    SelectPath(state);
+    vec3f position(1, 2, 3), direction(-1, -2, -3), up(0, 0, 1);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(lookAt(position, direction, up));
+        benchmark::ClobberMemory();
+    }
+    ReportItems(state, 1);
+}
+
+void BM_Perspective(benchmark::State& state) {
+    SelectPath(state);
+    float fov = radians(60.0f);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(perspective(fov, 16.0f / 9.0f, 0.1f, 1000.0f));
+        benchmark::ClobberMemory();
+    }
+    ReportItems(state, 1);
+}
+
+//---------------------------------------------------------------
+// Batches, the second argument is the batch size
+//---------------------------------------------------------------
+void BM_TransformPoints(benchmark::State& state) {
+    SelectPath(state);
+    const size_t count  = state.range(1);
+    auto         points = RandomVectors<vec4f>(count);
+    for (auto&& p : points) p.w = 1.0f;
+    std::mt19937       engine(42);
+    mat4f              trans = RandomTransform(engine);
+    std::vector<vec4f> result(count);
+    for (auto _ : state) {
+        for (size_t i = 0; i < count; i++) result[i] = trans * points[i];
+        benchmark::ClobberMemory();
+    }
+    ReportItems(state, count);
+}
+
+std::vector<Box> RandomBoxes(size_t count) {
+    auto             centers = RandomVectors<vec3f>(count, -100.0f, 100.0f);
+    auto             extents = RandomVectors<vec3f>(count, 0.1f, 5.0f);
+    std::vector<Box> boxes;
+    boxes.reserve(count);
+    for (size_t i = 0; i < count; i++) boxes.emplace_back(centers[i] - extents[i], centers[i] + extents[i]);
+    return boxes;
+}
+
+void BM_TransformBoxes(benchmark::State& state) {
+    SelectPath(state);
+    const size_t       count = state.range(1);
+    auto               boxes = RandomBoxes(count);
+    std::mt19937       engine(42);
+    std::vector<mat4f> transforms(count);
+    for (auto&& trans : transforms) trans = RandomTransform(engine);
+    std::vector<Box> result(count);
+    for (auto _ : state) {
+        Transform(boxes, transforms, result);
+        benchmark::ClobberMemory();
+    }
+    ReportItems(state, count);
+}
+
+void BM_FrustumCullBoxes(benchmark::State& state) {
+    SelectPath(state);
+    const size_t         count = state.range(1);
+    auto                 boxes = RandomBoxes(count);
+    Frustum              frustum(perspective(radians(60.0f), 16.0f / 9.0f, 0.1f, 1000.0f) * lookAt(vec3f(0), vec3f(1, 0, 0), vec3f(0, 0, 1)));
+    std::vector<uint8_t> visible(count);
+    for (auto _ : state) {
+        Intersect(frustum, boxes, visible);
+        benchmark::ClobberMemory();
+    }
+    ReportItems(state, count);
+}
+
+void BM_PackHalf(benchmark::State& state) {
+    SelectPath(state);
+    const size_t        count  = state.range(1);
+    auto                values = RandomVectors<vec4f>(count);
+    std::vector<half_t> packed(4 * count);
+    for (auto _ : state) {
+        PackHalf({reinterpret_cast<const float*>(values.data()), 4 * count}, packed);
+        benchmark::ClobberMemory();
+    }
+    ReportItems(state, 4 * count);
+}
+
+void BM_OctEncode(benchmark::State& state) {
+    SelectPath(state);
+    const size_t count   = state.range(1);
+    auto         normals = RandomVectors<vec3f>(count);
+    for (auto&& n : normals) n = normalize(n);
+    std::vector<Vector<int16_t, 2>> packed(count);
+    for (auto _ : state) {
+        OctEncode(normals, packed);
+        benchmark::ClobberMemory();
+    }
+    ReportItems(state, count);
+}
+
+#if defined(USE_ISPC)
+#define PATHS {static_cast<int64_t>(Path::Ispc), static_cast<int64_t>(Path::Scalar)}
+#else
+#define PATHS {static_cast<int64_t>(Path::Scalar)}
+#endif  // USE_ISPC
+
+BENCHMARK_TEMPLATE(BM_VectorAdd, vec3f)->ArgsProduct({PATHS});
+BENCHMARK_TEMPLATE(BM_VectorAdd, vec4f)->ArgsProduct({PATHS});
+BENCHMARK_TEMPLATE(BM_VectorAdd, vec4d)->ArgsProduct({PATHS});
+BENCHMARK_TEMPLATE(BM_VectorDot, vec3f)->ArgsProduct({PATHS});
+BENCHMARK_TEMPLATE(BM_VectorDot, vec4f)->ArgsProduct({PATHS});
+BENCHMARK(BM_VectorNormalize)->ArgsProduct({PATHS});
+
+BENCHMARK(BM_MatrixMultiply)->ArgsProduct({PATHS});
+BENCHMARK(BM_MatrixVector)->ArgsProduct({PATHS});
+BENCHMARK(BM_MatrixInverse)->ArgsProduct({PATHS});
+BENCHMARK(BM_MatrixTranspose)->ArgsProduct({PATHS});
+BENCHMARK(BM_LookAt)->ArgsProduct({PATHS});
+BENCHMARK(BM_Perspective)->ArgsProduct({PATHS});
+
+BENCHMARK(BM_TransformPoints)->ArgsProduct({PATHS, {64, 4096}});
+BENCHMARK(BM_TransformBoxes)->ArgsProduct({PATHS, {64, 4096}});
+BENCHMARK(BM_FrustumCullBoxes)->ArgsProduct({PATHS, {64, 4096, 65536}});
+BENCHMARK(BM_PackHalf)->ArgsProduct({PATHS, {4096}});
+BENCHMARK(BM_OctEncode)->ArgsProduct({PATHS, {4096}});
+
+BENCHMARK_MAIN();
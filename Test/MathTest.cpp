@@ -1,25 +1,10 @@
 #include <iostream>
 #include "HitagiMath.hpp"
 #include <gtest/gtest.h>
+#include "MathTestHelper.hpp"
 
 using namespace Hitagi;
 
-template <typename T, unsigned D>
-void vector_eq(const Vector<T, D>& v1, const Vector<T, D>& v2) {
-    for (size_t i = 0; i < D; i++) {
-        EXPECT_NEAR(v1[i], v2[i], 1E-8) << "difference at index: " << i;
-    }
-}
-
-template <typename T, unsigned D>
-void matrix_eq(const Matrix<T, D>& mat1, const Matrix<T, D>& mat2, double epsilon = 1E-5) {
-    for (int i = 0; i < D; i++) {
-        for (int j = 0; j < D; j++) {
-            EXPECT_NEAR(mat1[i][j], mat2[i][j], epsilon) << "difference at index: [" << i << "][" << j << "]";
-        }
-    }
-}
-
 TEST(VectorTest, VectorInit) {
     vec2f v2(1, 2);
     vec3f v3(1, 2, 3);
@@ -138,6 +123,226 @@ TEST(TransformTest, InverseSingularMatrix) {
     matrix_eq(inverse(a), mat3f(1.0f));
 }
 
+TEST(GeometryTest, BoxMergeAndTransform) {
+    Box box;
+    EXPECT_TRUE(box.Empty());
+    std::vector<vec3f> points = {vec3f(1, -2, 3), vec3f(-1, 2, 0), vec3f(0, 0, -3)};
+    box                       = BoundingBox(points);
+    vector_eq(box.bbMin, vec3f(-1, -2, -3));
+    vector_eq(box.bbMax, vec3f(1, 2, 3));
+
+    Box moved = Transform(Box(vec3f(-1), vec3f(1)), translate(rotateZ(mat4f(1.0f), radians(45.0f)), vec3f(1, 2, 3)));
+    float r   = std::sqrt(2.0f);
+    EXPECT_NEAR(moved.bbMin.x, 1 - r, 1E-5);
+    EXPECT_NEAR(moved.bbMax.y, 2 + r, 1E-5);
+    EXPECT_NEAR(moved.bbMin.z, 2, 1E-5);
+}
+
+TEST(GeometryTest, Intersect) {
+    Box    a(vec3f(0), vec3f(1));
+    Sphere s(vec3f(2, 0.5, 0.5), 1.0f);
+    EXPECT_TRUE(Intersect(a, Box(vec3f(0.5), vec3f(2))));
+    EXPECT_FALSE(Intersect(a, Box(vec3f(1.5), vec3f(2))));
+    EXPECT_TRUE(Intersect(a, s));
+    EXPECT_FALSE(Intersect(a, Sphere(vec3f(3), 1.0f)));
+    EXPECT_TRUE(Intersect(s, Sphere(vec3f(3.5, 0.5, 0.5), 0.6f)));
+
+    // rotated box overlaps only on the corner
+    OBB o1(a, mat4f(1.0f));
+    OBB o2(a, translate(rotateZ(mat4f(1.0f), radians(45.0f)), vec3f(1.3, 0.5, 0)));
+    OBB o3(a, translate(rotateZ(mat4f(1.0f), radians(45.0f)), vec3f(1.6, 0.5, 0)));
+    EXPECT_TRUE(Intersect(o1, o2));
+    EXPECT_FALSE(Intersect(o1, o3));
+}
+
+TEST(GeometryTest, RayCast) {
+    Ray ray(vec3f(-1, 0.5, 0.5), vec3f(1, 0, 0));
+    EXPECT_NEAR(Intersect(ray, Box(vec3f(0), vec3f(1))).value(), 1.0f, 1E-6);
+    EXPECT_FALSE(Intersect(ray, Box(vec3f(0, 1, 0), vec3f(1, 2, 1))).has_value());
+    EXPECT_NEAR(Intersect(ray, Sphere(vec3f(2, 0.5, 0.5), 1.0f)).value(), 2.0f, 1E-6);
+    EXPECT_NEAR(Intersect(ray, Plane(vec3f(3, 0, 0), vec3f(-1, 0, 0))).value(), 4.0f, 1E-6);
+    EXPECT_NEAR(Intersect(ray, Triangle(vec3f(0, 0, 0), vec3f(0, 2, 0), vec3f(0, 0, 2))).value(), 1.0f, 1E-6);
+    EXPECT_FALSE(Intersect(ray, Triangle(vec3f(0, 1, 1), vec3f(0, 2, 1), vec3f(0, 1, 2))).has_value());
+}
+
+TEST(GeometryTest, ClosestPoint) {
+    Triangle triangle(vec3f(0, 0, 0), vec3f(1, 0, 0), vec3f(0, 1, 0));
+    vector_eq(ClosestPoint(triangle, vec3f(0.2, 0.2, 1)), vec3f(0.2, 0.2, 0), 1E-6);
+    vector_eq(ClosestPoint(triangle, vec3f(2, -1, 0)), vec3f(1, 0, 0));
+    vector_eq(ClosestPoint(Box(vec3f(0), vec3f(1)), vec3f(2, 0.5, -1)), vec3f(1, 0.5, 0));
+    vector_eq(ClosestPoint(Line(vec3f(0), vec3f(2, 0, 0)), vec3f(1, 1, 0)), vec3f(1, 0, 0));
+    EXPECT_NEAR(Distance(Plane(vec3f(0), vec3f(0, 2, 0)), vec3f(3, 4, 5)), 4.0f, 1E-6);
+}
+
+TEST(GeometryTest, FrustumCulling) {
+    mat4f   projView = perspective(radians(90.0f), 1.0f, 1.0f, 100.0f) * lookAt(vec3f(0), vec3f(0, 0, -1), vec3f(0, 1, 0));
+    Frustum frustum(projView);
+
+    std::vector<Box> boxes = {
+        Box(vec3f(-1, -1, -11), vec3f(1, 1, -9)),      // inside
+        Box(vec3f(-1, -1, 9), vec3f(1, 1, 11)),        // behind the camera
+        Box(vec3f(9, -1, -11), vec3f(12, 1, -9)),      // crossing the right plane
+        Box(vec3f(-1, -1, -200), vec3f(1, 1, -150)),   // beyond far plane
+        Box(vec3f(-30, -1, -11), vec3f(-20, 1, -9)),   // left outside
+    };
+    EXPECT_EQ(Classify(frustum, boxes[0]), ContainmentType::Contains);
+    EXPECT_EQ(Classify(frustum, boxes[2]), ContainmentType::Intersects);
+
+    std::vector<uint8_t> result(boxes.size());
+    Intersect(frustum, boxes, result);
+    EXPECT_EQ(result, std::vector<uint8_t>({1, 0, 1, 0, 0}));
+
+    std::vector<Sphere> spheres = {Sphere(vec3f(0, 0, -10), 1), Sphere(vec3f(0, 0, 10), 1), Sphere(vec3f(0, 0, 0), 1.5)};
+    result.resize(spheres.size());
+    Intersect(frustum, spheres, result);
+    EXPECT_EQ(result, std::vector<uint8_t>({1, 0, 1}));
+}
+
+TEST(GeometryTest, BatchMatchesScalar) {
+    std::vector<Box>   boxes;
+    std::vector<mat4f> transforms;
+    for (int i = 0; i < 37; i++) {
+        vec3f p(i % 5 - 2.0f, i % 7 - 3.0f, i % 3 - 1.0f);
+        boxes.emplace_back(p, p + vec3f(0.5f + 0.1f * i));
+        transforms.emplace_back(translate(rotateY(mat4f(1.0f), radians(10.0f * i)), p));
+    }
+
+    Box                  query(vec3f(-1), vec3f(1));
+    Sphere               sphere(vec3f(0.5), 1.5f);
+    Ray                  ray(vec3f(-5, 0.1, 0.2), vec3f(1, 0, 0));
+    std::vector<uint8_t> overlap(boxes.size()), touched(boxes.size());
+    std::vector<float>   distance(boxes.size());
+    std::vector<Box>     transformed(boxes.size());
+    Intersect(query, boxes, overlap);
+    Intersect(sphere, boxes, touched);
+    Intersect(ray, boxes, distance);
+    Transform(boxes, transforms, transformed);
+
+    for (size_t i = 0; i < boxes.size(); i++) {
+        EXPECT_EQ(overlap[i], Intersect(query, boxes[i]));
+        EXPECT_EQ(touched[i], Intersect(boxes[i], sphere));
+        if (auto hit = Intersect(ray, boxes[i]); hit.has_value())
+            EXPECT_NEAR(distance[i], hit.value(), 1E-5);
+        else
+            EXPECT_TRUE(std::isinf(distance[i]));
+        auto expect = Transform(boxes[i], transforms[i]);
+        for (unsigned j = 0; j < 3; j++) {
+            EXPECT_NEAR(transformed[i].bbMin[j], expect.bbMin[j], 1E-5);
+            EXPECT_NEAR(transformed[i].bbMax[j], expect.bbMax[j], 1E-5);
+        }
+    }
+}
+
+#if defined(USE_ISPC)
+TEST(IspcTest, ScalarFallback) {
+    vec4f a(1, 2, 3, 4), b(4, 3, 2, 1);
+    Frustum frustum(perspective(radians(90.0f), 1.0f, 1.0f, 100.0f));
+    std::vector<Box> boxes = {Box(vec3f(-1, -1, -11), vec3f(1, 1, -9)), Box(vec3f(-1, -1, 9), vec3f(1, 1, 11))};
+
+    std::vector<uint8_t> ispcResult(boxes.size()), scalarResult(boxes.size());
+    auto                 ispcSum = a + b;
+    auto                 ispcDot = dot(a, b);
+    Intersect(frustum, boxes, ispcResult);
+
+    ispc::ForceScalar(true);
+    EXPECT_FALSE(ispc::IsSupported());
+    vector_eq(a + b, ispcSum);
+    EXPECT_EQ(dot(a, b), ispcDot);
+    Intersect(frustum, boxes, scalarResult);
+    ispc::ForceScalar(false);
+
+    EXPECT_EQ(ispcResult, scalarResult);
+}
+#endif  // USE_ISPC
+
+TEST(PackingTest, Half) {
+    std::vector<float> values = {0.0f, -0.0f, 1.0f, -2.5f, 65504.0f, 1E-5f, 3.14159f, 1E10f};
+    for (auto v : values) {
+        if (std::abs(v) > 65504.0f)
+            EXPECT_TRUE(std::isinf(HalfToFloat(FloatToHalf(v))));
+        else
+            EXPECT_NEAR(HalfToFloat(FloatToHalf(v)), v, std::abs(v) * 1E-3 + 1E-7);
+    }
+    EXPECT_EQ(FloatToHalf(1.0f), 0x3c00);
+    EXPECT_EQ(FloatToHalf(-2.0f), 0xc000);
+
+    std::vector<half_t> packed(values.size());
+    std::vector<float>  unpacked(values.size());
+    PackHalf(values, packed);
+    UnpackHalf(packed, unpacked);
+    for (size_t i = 0; i < values.size(); i++) {
+        EXPECT_EQ(packed[i], FloatToHalf(values[i]));
+        EXPECT_EQ(std::bit_cast<uint32_t>(unpacked[i]), std::bit_cast<uint32_t>(HalfToFloat(packed[i])));
+    }
+}
+
+TEST(PackingTest, Unorm) {
+    std::vector<float>    values = {-1.0f, 0.0f, 0.5f, 1.0f, 2.0f};
+    std::vector<uint8_t>  unorm8(values.size());
+    std::vector<uint16_t> unorm16(values.size());
+    PackUnorm8(values, unorm8);
+    PackUnorm16(values, unorm16);
+    EXPECT_EQ(unorm8, std::vector<uint8_t>({0, 0, 128, 255, 255}));
+    EXPECT_EQ(unorm16, std::vector<uint16_t>({0, 0, 32768, 65535, 65535}));
+
+    std::vector<float> unpacked(values.size());
+    UnpackUnorm16(unorm16, unpacked);
+    EXPECT_NEAR(unpacked[2], 0.5f, 1E-4);
+    UnpackUnorm8(unorm8, unpacked);
+    EXPECT_NEAR(unpacked[3], 1.0f, 1E-6);
+}
+
+TEST(PackingTest, Octahedral) {
+    std::vector<vec3f> normals;
+    for (int i = 0; i < 64; i++) {
+        float theta = 0.1f + i * 0.37f, phi = i * 0.05f;
+        normals.push_back(normalize(vec3f(std::cos(theta) * std::sin(phi * 3), std::sin(theta) * std::sin(phi * 3), std::cos(phi * 3))));
+    }
+    normals.push_back(vec3f(0, 0, -1));
+
+    std::vector<Vector<int16_t, 2>> packed(normals.size());
+    std::vector<vec3f>              unpacked(normals.size());
+    OctEncode(normals, packed);
+    OctDecode(packed, unpacked);
+    for (size_t i = 0; i < normals.size(); i++) {
+        EXPECT_EQ(packed[i].x, OctEncode(normals[i]).x);
+        EXPECT_EQ(packed[i].y, OctEncode(normals[i]).y);
+        vector_eq(unpacked[i], normals[i], 1E-4);
+    }
+}
+
+TEST(PackingTest, OctahedralDegenerate) {
+    std::vector<vec3f> normals = {vec3f(0.0f), vec3f(std::numeric_limits<float>::quiet_NaN(), 0.0f, 0.0f), vec3f(std::numeric_limits<float>::infinity(), 0.0f, 0.0f)};
+
+    std::vector<Vector<int16_t, 2>> packed(normals.size());
+    OctEncode(normals, packed);
+    for (size_t i = 0; i < normals.size(); i++) {
+        EXPECT_EQ(packed[i].x, 0);
+        EXPECT_EQ(packed[i].y, 0);
+        EXPECT_EQ(OctEncode(normals[i]).x, 0);
+        EXPECT_EQ(OctEncode(normals[i]).y, 0);
+        vector_eq(OctDecode(packed[i]), vec3f(0.0f, 0.0f, 1.0f), 1E-4);
+    }
+}
+
+TEST(PackingTest, TangentFrame) {
+    std::vector<vec3f> normals    = {vec3f(0, 0, 1), vec3f(0, 1, 0)};
+    std::vector<vec3f> tangents   = {vec3f(1, 0, 0), vec3f(0, 0, -1)};
+    std::vector<vec3f> bitangents = {vec3f(0, 1, 0), vec3f(1, 0, 0)};
+
+    std::vector<Vector<int16_t, 4>> frames(normals.size());
+    EncodeTangentFrame(normals, tangents, bitangents, frames);
+    EXPECT_GT(frames[0].z, 0);
+    EXPECT_LT(frames[1].z, 0);
+
+    std::vector<vec3f> t(normals.size()), b(normals.size());
+    DecodeTangentFrame(normals, frames, t, b);
+    for (size_t i = 0; i < normals.size(); i++) {
+        vector_eq(t[i], tangents[i], 1E-4);
+        vector_eq(b[i], bitangents[i], 1E-4);
+    }
+}
+
 TEST(BenchmarkTest, MatrixOperator) {
     mat4f a = {{1, 2, 3, 4}, {5, 6, 7, 8}, {9, 10, 11, 12}, {13, 14, 15, 16}};
     mat4f b = {{1, 2, 3, 4}, {5, 6, 7, 8}, {9, 10, 11, 12}, {13, 14, 15, 16}};
@@ -0,0 +1,250 @@
+#include <gtest/gtest.h>
+
+#include "MemoryManager.hpp"
+#include "AssetManager.hpp"
+#include "MeshOptimizer.hpp"
+
+#include <array>
+#include <numbers>
+#include <random>
+
+using namespace Hitagi;
+using namespace Hitagi::Asset;
+
+struct Grid {
+    std::vector<vec3f>    positions;
+    std::vector<uint32_t> indices;
+};
+
+// size x size quads at the height z, the triangles are shuffled
+Grid CreateGrid(uint32_t size, float z = 0.0f, uint32_t seed = 42) {
+    Grid grid;
+    for (uint32_t y = 0; y <= size; y++)
+        for (uint32_t x = 0; x <= size; x++)
+            grid.positions.emplace_back(static_cast<float>(x), static_cast<float>(y), z);
+
+    std::vector<std::array<uint32_t, 3>> triangles;
+    for (uint32_t y = 0; y < size; y++) {
+        for (uint32_t x = 0; x < size; x++) {
+            uint32_t v = y * (size + 1) + x;
+            triangles.push_back({v, v + 1, v + size + 2});
+            triangles.push_back({v, v + size + 2, v + size + 1});
+        }
+    }
+    std::shuffle(triangles.begin(), triangles.end(), std::mt19937(seed));
+    for (auto&& triangle : triangles) grid.indices.insert(grid.indices.end(), triangle.begin(), triangle.end());
+    return grid;
+}
+
+// A unit sphere without duplicated vertices
+Grid CreateSphere(uint32_t rings, uint32_t segments) {
+    Grid grid;
+    grid.positions.emplace_back(0.0f, 0.0f, 1.0f);
+    for (uint32_t ring = 1; ring < rings; ring++) {
+        const float theta = std::numbers::pi_v<float> * ring / rings;
+        for (uint32_t segment = 0; segment < segments; segment++) {
+            const float phi = 2.0f * std::numbers::pi_v<float> * segment / segments;
+            grid.positions.emplace_back(std::sin(theta) * std::cos(phi), std::sin(theta) * std::sin(phi), std::cos(theta));
+        }
+    }
+    grid.positions.emplace_back(0.0f, 0.0f, -1.0f);
+
+    auto vertex = [&](uint32_t ring, uint32_t segment) { return 1 + (ring - 1) * segments + segment % segments; };
+    for (uint32_t segment = 0; segment < segments; segment++) {
+        grid.indices.insert(grid.indices.end(), {0, vertex(1, segment), vertex(1, segment + 1)});
+        for (uint32_t ring = 1; ring + 1 < rings; ring++) {
+            grid.indices.insert(grid.indices.end(), {vertex(ring, segment), vertex(ring + 1, segment), vertex(ring + 1, segment + 1)});
+            grid.indices.insert(grid.indices.end(), {vertex(ring, segment), vertex(ring + 1, segment + 1), vertex(ring, segment + 1)});
+        }
+        const uint32_t south = grid.positions.size() - 1;
+        grid.indices.insert(grid.indices.end(), {vertex(rings - 1, segment), south, vertex(rings - 1, segment + 1)});
+    }
+    return grid;
+}
+
+// The triangles as the positions of their vertices, sorted
+std::vector<std::array<float, 9>> GetTriangles(std::span<const uint32_t> indices, std::span<const vec3f> positions) {
+    std::vector<std::array<float, 9>> result;
+    for (size_t t = 0; t < indices.size() / 3; t++) {
+        std::array<float, 9> triangle;
+        for (size_t k = 0; k < 3; k++)
+            for (size_t i = 0; i < 3; i++) triangle[3 * k + i] = positions[indices[3 * t + k]][i];
+        result.emplace_back(triangle);
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+TEST(MeshOptimizerTest, VertexCache) {
+    auto       grid   = CreateGrid(32);
+    auto       origin = grid.indices;
+    const auto before = GetACMR(grid.indices, grid.positions.size());
+
+    OptimizeVertexCache(grid.indices, grid.positions.size());
+    const auto after = GetACMR(grid.indices, grid.positions.size());
+    EXPECT_LT(after, before);
+    EXPECT_LT(after, 0.8f);
+    EXPECT_EQ(GetTriangles(grid.indices, grid.positions), GetTriangles(origin, grid.positions));
+}
+
+TEST(MeshOptimizerTest, Overdraw) {
+    // the lower grid is hidden by the upper one when seen from above
+    auto lower = CreateGrid(8, 0.0f, 1);
+    auto upper = CreateGrid(8, 1.0f, 2);
+    Grid grid  = lower;
+    grid.positions.insert(grid.positions.end(), upper.positions.begin(), upper.positions.end());
+    for (auto index : upper.indices) grid.indices.push_back(index + lower.positions.size());
+    auto origin = grid.indices;
+
+    OptimizeVertexCache(grid.indices, grid.positions.size());
+    const auto acmr = GetACMR(grid.indices, grid.positions.size());
+    OptimizeOverdraw(grid.indices, grid.positions);
+
+    EXPECT_EQ(GetTriangles(grid.indices, grid.positions), GetTriangles(origin, grid.positions));
+    EXPECT_EQ(grid.positions[grid.indices.front()].z, 1.0f);
+    EXPECT_EQ(grid.positions[grid.indices.back()].z, 0.0f);
+    EXPECT_LT(GetACMR(grid.indices, grid.positions.size()), acmr * 1.5f);
+}
+
+TEST(MeshOptimizerTest, OverdrawDegenerateFirstTriangle) {
+    auto grid = CreateGrid(8);
+    OptimizeVertexCache(grid.indices, grid.positions.size());
+    // the first triangle misses less than 3 vertices, but it still starts the first cluster
+    grid.indices.insert(grid.indices.begin(), {0, 0, 1});
+    auto origin = grid.indices;
+
+    OptimizeOverdraw(grid.indices, grid.positions);
+    EXPECT_EQ(GetTriangles(grid.indices, grid.positions), GetTriangles(origin, grid.positions));
+}
+
+TEST(MeshOptimizerTest, VertexFetch) {
+    std::vector<uint32_t> indices = {4, 2, 0, 2, 4, 5};
+    auto                  remap   = OptimizeVertexFetch(indices, 6);
+    EXPECT_EQ(indices, (std::vector<uint32_t>{0, 1, 2, 1, 0, 3}));
+    EXPECT_EQ(remap, (std::vector<uint32_t>{2, ~0u, 1, ~0u, 0, 3}));
+}
+
+TEST(MeshOptimizerTest, SimplifyPlane) {
+    auto  grid  = CreateGrid(16);
+    float error = -1.0f;
+    auto  result = Simplify(grid.indices, grid.positions, 0, 0.01f, &error);
+    EXPECT_LT(result.size(), grid.indices.size() / 4);
+    EXPECT_NEAR(error, 0.0f, 1e-5f);
+
+    // the border is kept and no triangle is flipped, so the area is the same
+    float area = 0.0f;
+    for (size_t t = 0; t < result.size() / 3; t++) {
+        const vec3f &a = grid.positions[result[3 * t]], &b = grid.positions[result[3 * t + 1]], &c = grid.positions[result[3 * t + 2]];
+        const float  z = cross(b - a, c - a).z;
+        EXPECT_GT(z, 0.0f);
+        area += 0.5f * z;
+    }
+    EXPECT_NEAR(area, 256.0f, 1e-3f);
+}
+
+TEST(MeshOptimizerTest, SimplifySphere) {
+    auto         sphere = CreateSphere(32, 64);
+    const size_t target = sphere.indices.size() / 4 / 3 * 3;
+    float        error  = 0.0f;
+    auto         result = Simplify(sphere.indices, sphere.positions, target, 1.0f, &error);
+    EXPECT_LE(result.size(), target);
+    EXPECT_GT(error, 0.0f);
+    EXPECT_LT(error, 0.1f);
+    // the surface stays close to the sphere
+    for (auto index : result) EXPECT_NEAR(sphere.positions[index].norm(), 1.0f, 1e-5f);
+
+    // the error target stops the simplification, only the tiny triangles near the poles are removed
+    result = Simplify(sphere.indices, sphere.positions, target, 1e-4f, &error);
+    EXPECT_GT(result.size(), sphere.indices.size() * 9 / 10);
+    EXPECT_LE(error, 1e-4f);
+}
+
+std::unique_ptr<SceneObjectMesh> CreateMesh(const Grid& grid) {
+    auto mesh = std::make_unique<SceneObjectMesh>();
+    mesh->SetPrimitiveType(PrimitiveType::TRI_LIST);
+    mesh->AddVertexArray(SceneObjectVertexArray("POSITION", VertexDataType::FLOAT3, Core::Buffer(grid.positions.data(), grid.positions.size() * sizeof(vec3f))));
+    // the texcoord is the position, so the vertex arrays must be reordered together
+    std::vector<vec2f> texcoords;
+    for (auto&& position : grid.positions) texcoords.emplace_back(position.x, position.y);
+    mesh->AddVertexArray(SceneObjectVertexArray("TEXCOORD", VertexDataType::FLOAT2, Core::Buffer(texcoords.data(), texcoords.size() * sizeof(vec2f))));
+    mesh->AddIndexArray(SceneObjectIndexArray(IndexDataType::INT32, Core::Buffer(grid.indices.data(), grid.indices.size() * sizeof(uint32_t))));
+    return mesh;
+}
+
+TEST(MeshOptimizerTest, OptimizeMesh) {
+    auto grid = CreateGrid(16);
+    auto mesh = CreateMesh(grid);
+    OptimizeMesh(*mesh);
+
+    auto& indexArray = mesh->GetIndexArray();
+    ASSERT_EQ(indexArray.GetIndexType(), IndexDataType::INT16);
+    ASSERT_EQ(indexArray.GetIndexCount(), grid.indices.size());
+    std::vector<uint32_t> indices(reinterpret_cast<const uint16_t*>(indexArray.GetData()),
+                                  reinterpret_cast<const uint16_t*>(indexArray.GetData()) + indexArray.GetIndexCount());
+
+    auto positions = reinterpret_cast<const vec3f*>(mesh->GetVertexByName("POSITION").GetData());
+    auto texcoords = reinterpret_cast<const vec2f*>(mesh->GetVertexByName("TEXCOORD").GetData());
+    EXPECT_EQ(GetTriangles(indices, std::span(positions, grid.positions.size())), GetTriangles(grid.indices, grid.positions));
+    for (auto index : indices) {
+        EXPECT_EQ(texcoords[index].x, positions[index].x);
+        EXPECT_EQ(texcoords[index].y, positions[index].y);
+    }
+    EXPECT_LT(GetACMR(indices, grid.positions.size()), GetACMR(grid.indices, grid.positions.size()));
+}
+
+TEST(MeshOptimizerTest, KeepIndexType) {
+    // too many vertices for 16 bits indices
+    auto grid = CreateGrid(300);
+    auto mesh = CreateMesh(grid);
+    OptimizeMesh(*mesh);
+    EXPECT_EQ(mesh->GetIndexArray().GetIndexType(), IndexDataType::INT32);
+
+    // only triangle lists are optimized
+    auto lines = CreateMesh(CreateGrid(2));
+    lines->SetPrimitiveType(PrimitiveType::LINE_LIST);
+    OptimizeMesh(*lines);
+    EXPECT_EQ(lines->GetIndexArray().GetIndexType(), IndexDataType::INT32);
+}
+
+TEST(MeshOptimizerTest, GenerateLODs) {
+    SceneObjectGeometry geometry;
+    geometry.AddMesh(CreateMesh(CreateSphere(32, 64)));
+    const std::vector<LODLevel> levels = {{0.5f, 0.05f}, {0.25f, 0.1f}};
+    GenerateLODs(geometry, levels);
+    ASSERT_EQ(geometry.GetLODCount(), 3);
+
+    EXPECT_EQ(geometry.GetLODError(0), 0.0f);
+    for (size_t lod = 1; lod < geometry.GetLODCount(); lod++) {
+        ASSERT_EQ(geometry.GetMeshes(lod).size(), 1);
+        EXPECT_LE(geometry.GetMeshes(lod).front()->GetIndexArray().GetIndexCount(),
+                  geometry.GetMeshes(lod - 1).front()->GetIndexArray().GetIndexCount() * 0.8);
+        EXPECT_GT(geometry.GetLODError(lod), geometry.GetLODError(lod - 1));
+        EXPECT_LE(geometry.GetLODError(lod), levels[lod - 1].error);
+    }
+
+    // large on the screen uses LOD 0, small uses the coarsest
+    EXPECT_EQ(geometry.SelectLOD(10.0f, 0.002f), 0);
+    EXPECT_EQ(geometry.SelectLOD(1e-4f, 0.002f), 2);
+    EXPECT_EQ(geometry.SelectLOD(0.002f / geometry.GetLODError(1), 0.002f), 1);
+
+    // the LODs added without errors are never selected
+    SceneObjectGeometry manual;
+    manual.AddMesh(CreateMesh(CreateGrid(2)));
+    manual.AddMesh(CreateMesh(CreateGrid(1)), 1);
+    EXPECT_EQ(manual.SelectLOD(1e-4f, 0.002f), 0);
+}
+
+int main(int argc, char* argv[]) {
+    g_MemoryManager->Initialize();
+    g_FileIOManager->Initialize();
+    g_AssetManager->Initialize();
+
+    ::testing::InitGoogleTest(&argc, argv);
+    int testResult = RUN_ALL_TESTS();
+
+    g_AssetManager->Finalize();
+    g_FileIOManager->Finalize();
+    g_MemoryManager->Finalize();
+
+    return testResult;
+}
@@ -0,0 +1,119 @@
+#include <gtest/gtest.h>
+
+#include "MemoryManager.hpp"
+#include "ThreadManager.hpp"
+#include "MipGenerator.hpp"
+#include "TextureCompressor.hpp"
+
+#include <cstring>
+
+using namespace Hitagi;
+using namespace Hitagi::Asset;
+
+Image CreateImage(uint32_t width, uint32_t height, uint32_t channels, std::function<uint8_t(uint32_t, uint32_t, uint32_t)> pixel) {
+    const uint32_t pitch = (width * channels + 3) & ~3u;
+    Image          image(width, height, channels * 8, pitch, pitch * height);
+    for (uint32_t y = 0; y < height; y++)
+        for (uint32_t x = 0; x < width; x++)
+            for (uint32_t c = 0; c < channels; c++)
+                image.GetData()[y * pitch + x * channels + c] = pixel(x, y, c);
+    return image;
+}
+
+uint8_t GetPixel(const Image& image, uint32_t x, uint32_t y, uint32_t c) {
+    return image.GetData()[y * image.GetPitch() + x * image.GetBitcount() / 8 + c];
+}
+
+TEST(MipGeneratorTest, ChainSize) {
+    auto image = CreateImage(256, 64, 4, [](auto, auto, auto) { return 0; });
+    auto mips  = GenerateMips(image);
+    ASSERT_EQ(mips.size(), 8);
+    for (size_t level = 0; level < mips.size(); level++) {
+        EXPECT_EQ(mips[level].GetWidth(), 128 >> level);
+        EXPECT_EQ(mips[level].GetHeight(), std::max(1, 32 >> static_cast<int>(level)));
+        EXPECT_EQ(mips[level].GetFormat(), PixelFormat::R8G8B8A8_UNORM);
+    }
+
+    // non power of two
+    mips = GenerateMips(CreateImage(5, 3, 1, [](auto, auto, auto) { return 0; }));
+    ASSERT_EQ(mips.size(), 2);
+    EXPECT_EQ(mips[0].GetWidth(), 2);
+    EXPECT_EQ(mips[0].GetHeight(), 1);
+    EXPECT_EQ(mips[1].GetWidth(), 1);
+    EXPECT_EQ(mips[1].GetHeight(), 1);
+}
+
+TEST(MipGeneratorTest, ConstantColor) {
+    auto image = CreateImage(37, 20, 4, [](auto, auto, auto c) { return std::array<uint8_t, 4>{200, 30, 90, 128}[c]; });
+    for (auto filter : {MipFilter::Box, MipFilter::Kaiser}) {
+        for (auto&& mip : GenerateMips(image, filter)) {
+            for (uint32_t y = 0; y < mip.GetHeight(); y++)
+                for (uint32_t x = 0; x < mip.GetWidth(); x++)
+                    for (uint32_t c = 0; c < 4; c++)
+                        EXPECT_EQ(GetPixel(mip, x, y, c), GetPixel(image, 0, 0, c));
+        }
+    }
+}
+
+TEST(MipGeneratorTest, GammaCorrect) {
+    auto checker = [](uint32_t x, uint32_t y, uint32_t) -> uint8_t { return (x + y) % 2 ? 255 : 0; };
+
+    // the average of black and white is 0.5 in linear, that is 188 in sRGB
+    auto mips = GenerateMips(CreateImage(16, 16, 4, checker), MipFilter::Box);
+    EXPECT_NEAR(GetPixel(mips[0], 3, 3, 0), 188, 1);
+    // alpha is linear
+    EXPECT_NEAR(GetPixel(mips[0], 3, 3, 3), 128, 1);
+
+    mips = GenerateMips(CreateImage(16, 16, 4, checker), MipFilter::Box, false);
+    EXPECT_NEAR(GetPixel(mips[0], 3, 3, 0), 128, 1);
+
+    // single channel images are not color
+    mips = GenerateMips(CreateImage(16, 16, 1, checker), MipFilter::Kaiser);
+    EXPECT_NEAR(GetPixel(mips[0], 3, 3, 0), 128, 1);
+}
+
+TEST(MipGeneratorTest, PrepareTextureColorSpace) {
+    auto checker = [](uint32_t x, uint32_t y, uint32_t) -> uint8_t { return (x + y) % 2 ? 255 : 0; };
+
+    // the color maps are filtered in linear space, the others, e.g. normal maps, as they are
+    auto color = PrepareTexture(CreateImage(16, 16, 4, checker), true, PixelFormat::UNKNOWN, true);
+    auto data  = PrepareTexture(CreateImage(16, 16, 4, checker), true, PixelFormat::UNKNOWN, false);
+    ASSERT_EQ(color.GetMipLevels(), 5);
+    ASSERT_EQ(data.GetMipLevels(), 5);
+    EXPECT_GT(GetPixel(color.GetMip(1), 3, 3, 0), 170);
+    EXPECT_NEAR(GetPixel(data.GetMip(1), 3, 3, 0), 128, 10);
+}
+
+TEST(MipGeneratorTest, Compress) {
+    auto image = CreateImage(64, 32, 4, [](auto x, auto y, auto c) { return static_cast<uint8_t>(4 * x + 2 * y + 50 * c); });
+    image.SetMips(GenerateMips(image));
+
+    auto compressed = CompressImage(image, PixelFormat::BC7_UNORM);
+    ASSERT_EQ(compressed.GetMipLevels(), 7);
+    for (size_t level = 1; level < compressed.GetMipLevels(); level++) {
+        auto& mip = compressed.GetMip(level);
+        EXPECT_EQ(mip.GetFormat(), PixelFormat::BC7_UNORM);
+        EXPECT_EQ(mip.GetWidth(), image.GetMip(level).GetWidth());
+        // the small levels are still a whole block
+        EXPECT_EQ(mip.GetDataSize(), ((mip.GetWidth() + 3) / 4) * ((mip.GetHeight() + 3) / 4) * 16);
+    }
+}
+
+TEST(MipGeneratorTest, ErrorPath) {
+    EXPECT_TRUE(GenerateMips(Image{}).empty());
+    auto image = CreateImage(8, 8, 4, [](auto, auto, auto) { return 0; });
+    EXPECT_TRUE(GenerateMips(CompressImage(image, PixelFormat::BC1_UNORM)).empty());
+}
+
+int main(int argc, char* argv[]) {
+    g_MemoryManager->Initialize();
+    g_ThreadManager->Initialize();
+
+    ::testing::InitGoogleTest(&argc, argv);
+    int testResult = RUN_ALL_TESTS();
+
+    g_ThreadManager->Finalize();
+    g_MemoryManager->Finalize();
+
+    return testResult;
+}
@@ -0,0 +1,150 @@
+#include <gtest/gtest.h>
+
+#include "MemoryManager.hpp"
+#include "ThreadManager.hpp"
+#include "OcclusionCuller.hpp"
+#include "MeshOptimizer.hpp"
+
+using namespace Hitagi;
+using namespace Hitagi::Asset;
+
+// The camera is at the origin looking at -z, a wall of [-5, 5] x [-5, 5] is at z = -10
+const mat4f                   projView = perspective(radians(60.0f), 2.0f, 0.1f, 100.0f) * lookAt(vec3f(0.0f), vec3f(0.0f, 0.0f, -1.0f), vec3f(0.0f, 1.0f, 0.0f));
+const std::vector<vec3f>      wall     = {vec3f(-5.0f, -5.0f, -10.0f), vec3f(5.0f, -5.0f, -10.0f), vec3f(5.0f, 5.0f, -10.0f), vec3f(-5.0f, 5.0f, -10.0f)};
+const std::vector<uint32_t>   indices  = {0, 1, 2, 0, 2, 3};
+constexpr float               farthest = std::numeric_limits<float>::max();
+
+TEST(OcclusionCullerTest, Rasterize) {
+    Graphics::OcclusionCuller culler;
+    culler.Begin(projView);
+    culler.AddOccluder(wall, indices, mat4f(1.0f));
+    culler.End();
+
+    const size_t centerX = culler.GetWidth() / 2, centerY = culler.GetHeight() / 2;
+    const vec4f  clip    = projView * vec4f(0.0f, 0.0f, -10.0f, 1.0f);
+    EXPECT_NEAR(culler.GetDepth(centerX, centerY), clip.z / clip.w, 1e-4f);
+    EXPECT_EQ(culler.GetDepth(0, 0), farthest);
+
+    // the upper levels keep the farthest depth
+    EXPECT_NEAR(culler.GetDepth(centerX / 2, centerY / 2, 1), clip.z / clip.w, 1e-4f);
+    EXPECT_EQ(culler.GetDepth(0, 0, culler.GetLevelCount() - 1), farthest);
+}
+
+TEST(OcclusionCullerTest, Visibility) {
+    Graphics::OcclusionCuller culler;
+    culler.Begin(projView);
+    // nothing is occluded without occluders
+    culler.End();
+    EXPECT_TRUE(culler.IsVisible(Box(vec3f(-1.0f, -1.0f, -21.0f), vec3f(1.0f, 1.0f, -19.0f))));
+
+    culler.Begin(projView);
+    culler.AddOccluder(wall, indices, mat4f(1.0f));
+    culler.End();
+    // behind the wall
+    EXPECT_FALSE(culler.IsVisible(Box(vec3f(-1.0f, -1.0f, -21.0f), vec3f(1.0f, 1.0f, -19.0f))));
+    // in front of the wall
+    EXPECT_TRUE(culler.IsVisible(Box(vec3f(-1.0f, -1.0f, -6.0f), vec3f(1.0f, 1.0f, -4.0f))));
+    // behind the wall, but beside it on the screen
+    EXPECT_TRUE(culler.IsVisible(Box(vec3f(14.0f, -1.0f, -21.0f), vec3f(16.0f, 1.0f, -19.0f))));
+    // behind the wall across its edge
+    EXPECT_TRUE(culler.IsVisible(Box(vec3f(8.0f, -1.0f, -21.0f), vec3f(12.0f, 1.0f, -19.0f))));
+    // across the near plane
+    EXPECT_TRUE(culler.IsVisible(Box(vec3f(-1.0f, -1.0f, -1.0f), vec3f(1.0f, 1.0f, 1.0f))));
+}
+
+std::shared_ptr<SceneObjectGeometry> CreateGeometry(const std::vector<vec3f>& positions, const std::vector<uint32_t>& indices, bool optimize = false) {
+    auto mesh = std::make_unique<SceneObjectMesh>();
+    mesh->AddVertexArray(SceneObjectVertexArray("POSITION", VertexDataType::FLOAT3, Core::Buffer(positions.data(), positions.size() * sizeof(vec3f))));
+    mesh->AddIndexArray(SceneObjectIndexArray(IndexDataType::INT32, Core::Buffer(indices.data(), indices.size() * sizeof(uint32_t))));
+    mesh->SetPrimitiveType(PrimitiveType::TRI_LIST);
+    // as the imported meshes, whose indices are narrowed to 16 bits
+    if (optimize) OptimizeMesh(*mesh);
+    auto geometry = std::make_shared<SceneObjectGeometry>();
+    geometry->AddMesh(std::move(mesh));
+    return geometry;
+}
+
+TEST(OcclusionCullerTest, Scene) {
+    Scene scene("root");
+    auto  wallGeometry = CreateGeometry(wall, indices);
+    auto  cubeGeometry = CreateGeometry({vec3f(-0.5f), vec3f(0.5f)}, {0, 1, 1});
+    scene.Geometries.emplace("wall", wallGeometry);
+    scene.Geometries.emplace("cube", cubeGeometry);
+
+    auto addNode = [&](std::string name, std::shared_ptr<SceneObjectGeometry> geometry, vec3f position) {
+        auto node = std::make_shared<SceneGeometryNode>(name);
+        node->AddSceneObjectRef(geometry);
+        node->AppendTransform(std::make_shared<SceneObjectTranslation>(position.x, position.y, position.z));
+        scene.GeometryNodes.emplace(name, node);
+        scene.SceneGraph->AppendChild(std::shared_ptr(node));
+        return node;
+    };
+    auto wallNode   = addNode("wall", wallGeometry, vec3f(0.0f));
+    auto hiddenNode = addNode("hidden", cubeGeometry, vec3f(0.0f, 0.0f, -20.0f));
+    auto besideNode = addNode("beside", cubeGeometry, vec3f(15.0f, 0.0f, -20.0f));
+    scene.RegisterObjects();
+    scene.BuildTransformHierarchy();
+    scene.UpdateTransforms();
+
+    std::vector<std::reference_wrapper<SceneGeometryNode>> nodes = {*wallNode, *hiddenNode, *besideNode};
+
+    Graphics::OcclusionCuller culler;
+    culler.Begin(projView);
+    culler.AddOccluders(scene, nodes);
+    culler.End();
+    // the cubes are too small on the screen to be occluders
+    EXPECT_EQ(culler.GetOccluderCount(), 1);
+
+    auto visible = culler.Cull(scene, nodes);
+    ASSERT_EQ(visible.size(), 2);
+    EXPECT_EQ(&visible[0].get(), wallNode.get());
+    EXPECT_EQ(&visible[1].get(), besideNode.get());
+}
+
+TEST(OcclusionCullerTest, OptimizedOccluder) {
+    Scene scene("root");
+    auto  wallGeometry = CreateGeometry(wall, indices, true);
+    auto  cubeGeometry = CreateGeometry({vec3f(-0.5f), vec3f(0.5f)}, {0, 1, 1});
+    ASSERT_EQ(wallGeometry->GetMeshes(0).front()->GetIndexArray().GetIndexType(), IndexDataType::INT16);
+    scene.Geometries.emplace("wall", wallGeometry);
+    scene.Geometries.emplace("cube", cubeGeometry);
+
+    auto addNode = [&](std::string name, std::shared_ptr<SceneObjectGeometry> geometry, vec3f position) {
+        auto node = std::make_shared<SceneGeometryNode>(name);
+        node->AddSceneObjectRef(geometry);
+        node->AppendTransform(std::make_shared<SceneObjectTranslation>(position.x, position.y, position.z));
+        scene.GeometryNodes.emplace(name, node);
+        scene.SceneGraph->AppendChild(std::shared_ptr(node));
+        return node;
+    };
+    auto wallNode   = addNode("wall", wallGeometry, vec3f(0.0f));
+    auto hiddenNode = addNode("hidden", cubeGeometry, vec3f(0.0f, 0.0f, -20.0f));
+    scene.RegisterObjects();
+    scene.BuildTransformHierarchy();
+    scene.UpdateTransforms();
+
+    std::vector<std::reference_wrapper<SceneGeometryNode>> nodes = {*wallNode, *hiddenNode};
+
+    Graphics::OcclusionCuller culler;
+    culler.Begin(projView);
+    culler.AddOccluders(scene, nodes);
+    culler.End();
+    EXPECT_EQ(culler.GetOccluderCount(), 1);
+
+    auto visible = culler.Cull(scene, nodes);
+    ASSERT_EQ(visible.size(), 1);
+    EXPECT_EQ(&visible[0].get(), wallNode.get());
+}
+
+int main(int argc, char* argv[]) {
+    g_MemoryManager->Initialize();
+    g_ThreadManager->Initialize();
+
+    ::testing::InitGoogleTest(&argc, argv);
+    int testResult = RUN_ALL_TESTS();
+
+    g_ThreadManager->Finalize();
+    g_MemoryManager->Finalize();
+
+    return testResult;
+}
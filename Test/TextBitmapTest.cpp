@@ -41,7 +41,7 @@ int main(int argc, char const* argv[]) {
             Finalize("Initialize FreeType failed!");
             return -1;
         }
-        error = FT_New_Memory_Face(library, fontBuffer.GetData(), fontBuffer.GetDataSize(), 0, &face);
+        error = FT_New_Memory_Face(library, fontBuffer->GetData(), fontBuffer->GetDataSize(), 0, &face);
         if (error) {
             Finalize("Load font face failed!");
             return -1;
@@ -0,0 +1,238 @@
+#include <gtest/gtest.h>
+
+#include "MemoryManager.hpp"
+#include "ThreadManager.hpp"
+#include "TextureCompressor.hpp"
+
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <random>
+
+using namespace Hitagi;
+using namespace Hitagi::Asset;
+
+using Pixel = std::array<uint8_t, 4>;
+using Block = std::array<Pixel, 16>;
+
+// Reference decoders, they follow the D3D block compression specification
+Pixel FromRGB565(uint16_t color) {
+    const unsigned r = color >> 11, g = (color >> 5) & 0x3f, b = color & 0x1f;
+    return {static_cast<uint8_t>((r << 3) | (r >> 2)), static_cast<uint8_t>((g << 2) | (g >> 4)), static_cast<uint8_t>((b << 3) | (b >> 2)), 255};
+}
+
+void DecodeBC1(const uint8_t* data, Block& block) {
+    uint16_t c0, c1;
+    uint32_t indices;
+    std::memcpy(&c0, data, 2);
+    std::memcpy(&c1, data + 2, 2);
+    std::memcpy(&indices, data + 4, 4);
+
+    std::array<Pixel, 4> palette{FromRGB565(c0), FromRGB565(c1)};
+    for (size_t c = 0; c < 3; c++) {
+        if (c0 > c1) {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+        } else {
+            palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+            palette[3][c] = 0;
+        }
+    }
+    palette[2][3] = 255;
+    palette[3][3] = c0 > c1 ? 255 : 0;
+    for (size_t i = 0; i < 16; i++) {
+        auto& pixel = palette[(indices >> (2 * i)) & 0x3];
+        for (size_t c = 0; c < 3; c++) block[i][c] = pixel[c];
+    }
+}
+
+void DecodeBC4(const uint8_t* data, Block& block, size_t channel) {
+    uint64_t bits;
+    std::memcpy(&bits, data, 8);
+    const int a0 = bits & 0xff, a1 = (bits >> 8) & 0xff;
+
+    std::array<uint8_t, 8> palette{static_cast<uint8_t>(a0), static_cast<uint8_t>(a1)};
+    for (int k = 2; k < 8; k++) {
+        if (a0 > a1)
+            palette[k] = ((8 - k) * a0 + (k - 1) * a1) / 7;
+        else
+            palette[k] = k < 6 ? ((6 - k) * a0 + (k - 1) * a1) / 5 : (k == 6 ? 0 : 255);
+    }
+    for (size_t i = 0; i < 16; i++) block[i][channel] = palette[(bits >> (16 + 3 * i)) & 0x7];
+}
+
+// Mode 6 only
+void DecodeBC7(const uint8_t* data, Block& block) {
+    std::array<uint64_t, 2> bits;
+    std::memcpy(bits.data(), data, 16);
+    unsigned position = 0;
+    auto     read     = [&](unsigned count) {
+        uint64_t result = 0;
+        for (unsigned i = 0; i < count; i++, position++)
+            result |= ((bits[position / 64] >> (position % 64)) & 1) << i;
+        return static_cast<int>(result);
+    };
+
+    ASSERT_EQ(read(7), 1 << 6);
+    std::array<int, 4> e0, e1;
+    for (size_t c = 0; c < 4; c++) {
+        e0[c] = read(7);
+        e1[c] = read(7);
+    }
+    const int p0 = read(1), p1 = read(1);
+    for (size_t c = 0; c < 4; c++) {
+        e0[c] = (e0[c] << 1) | p0;
+        e1[c] = (e1[c] << 1) | p1;
+    }
+    constexpr std::array<int, 16> weights = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+    for (size_t i = 0; i < 16; i++) {
+        const int w = weights[read(i == 0 ? 3 : 4)];
+        for (size_t c = 0; c < 4; c++) block[i][c] = ((64 - w) * e0[c] + w * e1[c] + 32) >> 6;
+    }
+}
+
+Image Decode(const Image& compressed) {
+    Image result(compressed.GetWidth(), compressed.GetHeight(), 32, compressed.GetWidth() * 4, compressed.GetWidth() * compressed.GetHeight() * 4);
+
+    const uint32_t blockSize = GetPixelFormatBitSize(compressed.GetFormat()) * 16 / 8;
+    for (uint32_t by = 0; by < compressed.GetHeight() / 4; by++) {
+        for (uint32_t bx = 0; bx < compressed.GetWidth() / 4; bx++) {
+            const uint8_t* data = compressed.GetData() + by * compressed.GetPitch() + bx * blockSize;
+
+            Block block;
+            for (auto&& pixel : block) pixel = {0, 0, 0, 255};
+            switch (compressed.GetFormat()) {
+                case PixelFormat::BC1_UNORM:
+                    DecodeBC1(data, block);
+                    break;
+                case PixelFormat::BC3_UNORM:
+                    DecodeBC4(data, block, 3);
+                    DecodeBC1(data + 8, block);
+                    break;
+                case PixelFormat::BC4_UNORM:
+                    DecodeBC4(data, block, 0);
+                    break;
+                case PixelFormat::BC5_UNORM:
+                    DecodeBC4(data, block, 0);
+                    DecodeBC4(data + 8, block, 1);
+                    break;
+                case PixelFormat::BC7_UNORM:
+                    DecodeBC7(data, block);
+                    break;
+                default:
+                    break;
+            }
+            for (uint32_t y = 0; y < 4; y++)
+                std::memcpy(result.GetData() + (4 * by + y) * result.GetPitch() + 4 * bx * 4, block.data() + 4 * y, 16);
+        }
+    }
+    return result;
+}
+
+// Smooth gradients with a little noise, like a photo
+Image CreateTestImage(uint32_t width, uint32_t height) {
+    Image                              image(width, height, 32, width * 4, width * height * 4);
+    std::mt19937                       engine(42);
+    std::uniform_int_distribution<int> noise(-6, 6);
+    for (uint32_t y = 0; y < height; y++) {
+        for (uint32_t x = 0; x < width; x++) {
+            uint8_t*   pixel = image.GetData() + y * image.GetPitch() + 4 * x;
+            const auto u = static_cast<float>(x) / width, v = static_cast<float>(y) / height;
+
+            const std::array<float, 4> color = {
+                255.0f * u,
+                255.0f * v,
+                127.5f + 127.5f * std::sin(6.0f * u + 4.0f * v),
+                255.0f * (1.0f - u * v),
+            };
+            for (size_t c = 0; c < 4; c++) pixel[c] = static_cast<uint8_t>(std::clamp(static_cast<int>(color[c]) + noise(engine), 0, 255));
+        }
+    }
+    return image;
+}
+
+double PSNR(const Image& a, const Image& b, std::initializer_list<size_t> channels) {
+    double error = 0;
+    for (uint32_t y = 0; y < a.GetHeight(); y++) {
+        for (uint32_t x = 0; x < a.GetWidth(); x++) {
+            const uint8_t* pa = a.GetData() + y * a.GetPitch() + 4 * x;
+            const uint8_t* pb = b.GetData() + y * b.GetPitch() + 4 * x;
+            for (auto c : channels) error += (pa[c] - pb[c]) * (pa[c] - pb[c]);
+        }
+    }
+    error /= static_cast<double>(a.GetWidth()) * a.GetHeight() * channels.size();
+    return error == 0 ? std::numeric_limits<double>::infinity() : 10.0 * std::log10(255.0 * 255.0 / error);
+}
+
+class TextureCompressionTest : public ::testing::Test {
+protected:
+    Image m_Image = CreateTestImage(128, 64);
+};
+
+TEST_F(TextureCompressionTest, BC1) {
+    auto compressed = CompressImage(m_Image, PixelFormat::BC1_UNORM);
+    ASSERT_EQ(compressed.GetFormat(), PixelFormat::BC1_UNORM);
+    EXPECT_EQ(compressed.GetDataSize(), 128 * 64 / 2);
+    EXPECT_EQ(compressed.GetPitch(), 32 * 8);
+    EXPECT_GT(PSNR(m_Image, Decode(compressed), {0, 1, 2}), 32.0);
+}
+
+TEST_F(TextureCompressionTest, BC3) {
+    auto compressed = CompressImage(m_Image, PixelFormat::BC3_UNORM);
+    ASSERT_EQ(compressed.GetFormat(), PixelFormat::BC3_UNORM);
+    EXPECT_EQ(compressed.GetDataSize(), 128 * 64);
+    auto decoded = Decode(compressed);
+    EXPECT_GT(PSNR(m_Image, decoded, {0, 1, 2}), 32.0);
+    EXPECT_GT(PSNR(m_Image, decoded, {3}), 36.0);
+}
+
+TEST_F(TextureCompressionTest, BC4AndBC5) {
+    auto bc4 = CompressImage(m_Image, PixelFormat::BC4_UNORM);
+    ASSERT_EQ(bc4.GetFormat(), PixelFormat::BC4_UNORM);
+    EXPECT_GT(PSNR(m_Image, Decode(bc4), {0}), 36.0);
+
+    auto bc5 = CompressImage(m_Image, PixelFormat::BC5_UNORM);
+    ASSERT_EQ(bc5.GetFormat(), PixelFormat::BC5_UNORM);
+    EXPECT_GT(PSNR(m_Image, Decode(bc5), {0, 1}), 36.0);
+}
+
+TEST_F(TextureCompressionTest, BC7) {
+    auto compressed = CompressImage(m_Image, PixelFormat::BC7_UNORM);
+    ASSERT_EQ(compressed.GetFormat(), PixelFormat::BC7_UNORM);
+    EXPECT_EQ(compressed.GetDataSize(), 128 * 64);
+    auto decoded = Decode(compressed);
+    EXPECT_GT(PSNR(m_Image, decoded, {0, 1, 2, 3}), 36.0);
+    // mode 6 is better than BC1 on the same color
+    EXPECT_GT(PSNR(m_Image, decoded, {0, 1, 2}), PSNR(m_Image, Decode(CompressImage(m_Image, PixelFormat::BC1_UNORM)), {0, 1, 2}));
+}
+
+TEST_F(TextureCompressionTest, SolidColor) {
+    Image image(8, 8, 32, 32, 256);
+    for (size_t i = 0; i < 64; i++) std::memcpy(image.GetData() + 4 * i, std::array<uint8_t, 4>{200, 100, 50, 128}.data(), 4);
+    for (auto format : {PixelFormat::BC3_UNORM, PixelFormat::BC7_UNORM}) {
+        auto decoded = Decode(CompressImage(image, format));
+        EXPECT_GT(PSNR(image, decoded, {0, 1, 2, 3}), 40.0);
+    }
+}
+
+TEST_F(TextureCompressionTest, ErrorPath) {
+    // not a multiple of 4
+    EXPECT_TRUE(CompressImage(CreateTestImage(30, 16), PixelFormat::BC1_UNORM).Empty());
+    // not a block compressed format
+    EXPECT_TRUE(CompressImage(m_Image, PixelFormat::R8G8B8A8_UNORM).Empty());
+    // already compressed
+    EXPECT_TRUE(CompressImage(CompressImage(m_Image, PixelFormat::BC1_UNORM), PixelFormat::BC7_UNORM).Empty());
+}
+
+int main(int argc, char* argv[]) {
+    g_MemoryManager->Initialize();
+    g_ThreadManager->Initialize();
+
+    ::testing::InitGoogleTest(&argc, argv);
+    int testResult = RUN_ALL_TESTS();
+
+    g_ThreadManager->Finalize();
+    g_MemoryManager->Finalize();
+
+    return testResult;
+}
@@ -1,5 +1,9 @@
 #include "ThreadManager.hpp"
 
+#include <atomic>
+#include <chrono>
+#include <thread>
+
 using namespace Hitagi;
 
 int main() {
@@ -9,6 +13,30 @@ int main() {
         return 3;
     });
 
+    std::vector<int> values(10000, 0);
+    g_ThreadManager->ParallelFor(0, values.size(), [&](size_t i) { values[i] = static_cast<int>(i); });
+    for (size_t i = 0; i < values.size(); i++)
+        if (values[i] != static_cast<int>(i)) return 1;
+
+    // the exception of a chunk is rethrown after all the chunks are finished
+    std::atomic<int> running = 0;
+    bool             thrown  = false;
+    try {
+        g_ThreadManager->ParallelFor(0, values.size(), [&](size_t i) {
+            running++;
+            if (i == 0) {
+                running--;
+                throw std::runtime_error("chunk failed");
+            }
+            // the other chunks are still running when the first one throws
+            if (i % 1000 == 1) std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            running--;
+        });
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    if (!thrown || running != 0) return 1;
+
     g_ThreadManager->Finalize();
-    return 0;
+    return x.get() == 3 ? 0 : 1;
 }
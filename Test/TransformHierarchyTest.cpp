@@ -0,0 +1,146 @@
+#include <gtest/gtest.h>
+
+#include "MemoryManager.hpp"
+#include "ThreadManager.hpp"
+#include "TransformHierarchy.hpp"
+#include "MathTestHelper.hpp"
+
+#include <random>
+
+using namespace Hitagi;
+using namespace Hitagi::Asset;
+
+// root -> a -> c
+//      -> b
+TEST(TransformHierarchyTest, Build) {
+    auto root = std::make_shared<BaseSceneNode>("root");
+    auto a    = std::make_shared<BaseSceneNode>("a");
+    auto b    = std::make_shared<BaseSceneNode>("b");
+    auto c    = std::make_shared<BaseSceneNode>("c");
+    a->AppendChild(std::shared_ptr(c));
+    root->AppendChild(std::shared_ptr(a));
+    root->AppendChild(std::shared_ptr(b));
+
+    TransformHierarchy hierarchy(*root);
+    ASSERT_EQ(hierarchy.Size(), 4);
+    EXPECT_EQ(hierarchy.GetNode(0), root.get());
+    EXPECT_EQ(hierarchy.GetNode(1), a.get());
+    EXPECT_EQ(hierarchy.GetNode(2), c.get());
+    EXPECT_EQ(hierarchy.GetNode(3), b.get());
+    EXPECT_EQ(hierarchy.GetParent(0), TransformHierarchy::nullIndex);
+    EXPECT_EQ(hierarchy.GetParent(1), 0);
+    EXPECT_EQ(hierarchy.GetParent(2), 1);
+    EXPECT_EQ(hierarchy.GetParent(3), 0);
+    EXPECT_EQ(hierarchy.GetSubtreeSize(0), 4);
+    EXPECT_EQ(hierarchy.GetSubtreeSize(1), 2);
+    EXPECT_EQ(hierarchy.GetSubtreeSize(3), 1);
+}
+
+TEST(TransformHierarchyTest, Update) {
+    auto root  = std::make_shared<BaseSceneNode>("root");
+    auto arm   = std::make_shared<BaseSceneNode>("arm");
+    auto hand  = std::make_shared<BaseSceneNode>("hand");
+    auto other = std::make_shared<BaseSceneNode>("other");
+    root->AppendTransform(std::make_shared<SceneObjectTranslation>(1.0f, 0.0f, 0.0f));
+    arm->AppendTransform(std::make_shared<SceneObjectRotation>('z', 90.0f));
+    hand->AppendTransform(std::make_shared<SceneObjectTranslation>(1.0f, 0.0f, 0.0f));
+    arm->AppendChild(std::shared_ptr(hand));
+    root->AppendChild(std::shared_ptr(arm));
+    root->AppendChild(std::shared_ptr(other));
+
+    TransformHierarchy hierarchy(*root);
+    hierarchy.Update();
+    EXPECT_NEAR((GetOrigin(hand->GetWorldTransform()) - vec3f(1.0f, 1.0f, 0.0f)).norm(), 0.0f, 1e-5f);
+    EXPECT_NEAR((GetOrigin(other->GetWorldTransform()) - vec3f(1.0f, 0.0f, 0.0f)).norm(), 0.0f, 1e-5f);
+
+    // the runtime transform of a parent moves its children
+    root->ApplyTransform(translate(mat4f(1.0f), vec3f(0.0f, 0.0f, 2.0f)));
+    hierarchy.Update();
+    EXPECT_NEAR((GetOrigin(hand->GetWorldTransform()) - vec3f(1.0f, 1.0f, 2.0f)).norm(), 0.0f, 1e-5f);
+
+    // Propagate uses the local transforms in the hierarchy only
+    hierarchy.SetLocalTransform(1, mat4f(1.0f));
+    hierarchy.Propagate();
+    EXPECT_NEAR((GetOrigin(hierarchy.GetWorldTransform(2)) - vec3f(2.0f, 0.0f, 2.0f)).norm(), 0.0f, 1e-5f);
+    EXPECT_NEAR((GetOrigin(hand->GetWorldTransform()) - vec3f(1.0f, 1.0f, 2.0f)).norm(), 0.0f, 1e-5f);
+}
+
+TEST(TransformHierarchyTest, Incremental) {
+    auto root = std::make_shared<BaseSceneNode>("root");
+    auto arm  = std::make_shared<BaseSceneNode>("arm");
+    auto hand = std::make_shared<BaseSceneNode>("hand");
+    auto leg  = std::make_shared<BaseSceneNode>("leg");
+    arm->AppendChild(std::shared_ptr(hand));
+    root->AppendChild(std::shared_ptr(arm));
+    root->AppendChild(std::shared_ptr(leg));
+
+    TransformHierarchy hierarchy(*root);
+    hierarchy.Update();
+    EXPECT_EQ(hierarchy.GetChangedNodes().size(), 4);
+    EXPECT_FALSE(arm->Dirty());
+
+    // nothing moved
+    hierarchy.Update();
+    EXPECT_TRUE(hierarchy.GetChangedNodes().empty());
+    const auto version = leg->GetTransformVersion();
+
+    // the children of a moved node are changed, and the others keep their version
+    arm->ApplyTransform(translate(mat4f(1.0f), vec3f(0.0f, 1.0f, 0.0f)));
+    EXPECT_TRUE(arm->Dirty());
+    hierarchy.Update();
+    EXPECT_EQ(hierarchy.GetChangedNodes(), (std::vector<size_t>{1, 2}));
+    EXPECT_EQ(hand->GetTransformVersion(), hierarchy.GetVersion());
+    EXPECT_EQ(leg->GetTransformVersion(), version);
+    EXPECT_NEAR((GetOrigin(hand->GetWorldTransform()) - vec3f(0.0f, 1.0f, 0.0f)).norm(), 0.0f, 1e-5f);
+
+    hierarchy.SetLocalTransform(3, translate(mat4f(1.0f), vec3f(1.0f, 0.0f, 0.0f)));
+    hierarchy.Propagate();
+    EXPECT_EQ(hierarchy.GetChangedNodes(), (std::vector<size_t>{3}));
+}
+
+// A random tree larger than the subtree grain is propagated in parallel,
+// and a long chain is propagated on the spine
+TEST(TransformHierarchyTest, LargeScene) {
+    constexpr size_t                            count = 100000;
+    std::mt19937                                generator(42);
+    std::uniform_real_distribution<float>       offset(-1.0f, 1.0f);
+    std::vector<std::shared_ptr<BaseSceneNode>> nodes;
+    std::vector<mat4f>                          expected;
+    nodes.reserve(count);
+    expected.reserve(count);
+
+    auto add = [&](size_t parent) {
+        auto  node  = std::make_shared<BaseSceneNode>();
+        mat4f local = rotateZ(translate(mat4f(1.0f), vec3f(offset(generator), offset(generator), offset(generator))), 0.1f * offset(generator));
+        node->AppendTransform(std::make_shared<SceneObjectTransform>(local));
+        expected.emplace_back(parent == count ? local : expected[parent] * local);
+        if (parent != count) nodes[parent]->AppendChild(std::shared_ptr(node));
+        nodes.emplace_back(std::move(node));
+    };
+    add(count);
+    for (size_t i = 1; i < 5000; i++) add(i - 1);
+    for (size_t i = 5000; i < count; i++) add(std::uniform_int_distribution<size_t>(0, i - 1)(generator) % 100 + i / 2);
+
+    TransformHierarchy hierarchy(*nodes.front());
+    ASSERT_EQ(hierarchy.Size(), count);
+    hierarchy.Update();
+    for (size_t i = 0; i < count; i += 97) {
+        matrix_eq(nodes[i]->GetWorldTransform(), expected[i], 1e-2);
+    }
+    for (size_t i = 1; i < hierarchy.Size(); i++) {
+        ASSERT_LT(hierarchy.GetParent(i), i);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    g_MemoryManager->Initialize();
+    g_ThreadManager->Initialize();
+
+    ::testing::InitGoogleTest(&argc, argv);
+    int testResult = RUN_ALL_TESTS();
+
+    g_ThreadManager->Finalize();
+    g_MemoryManager->Finalize();
+
+    return testResult;
+}
@@ -0,0 +1,115 @@
+#include <gtest/gtest.h>
+
+#include "MemoryManager.hpp"
+#include "AssetManager.hpp"
+
+#include <numeric>
+
+using namespace Hitagi;
+using namespace Hitagi::Asset;
+
+Core::Buffer CreateBuffer(size_t size, uint8_t seed) {
+    Core::Buffer buffer(size);
+    std::iota(buffer.GetData(), buffer.GetData() + size, seed);
+    return buffer;
+}
+
+// 4 vertices with a position, a normal, two texcoords and a custom array
+SceneObjectMesh CreateMesh() {
+    SceneObjectMesh mesh;
+    mesh.SetPrimitiveType(PrimitiveType::TRI_LIST);
+    mesh.AddVertexArray(SceneObjectVertexArray("NORMAL", VertexDataType::OCT_NORMAL, CreateBuffer(4 * 4, 0)));
+    mesh.AddVertexArray(SceneObjectVertexArray("POSITION", VertexDataType::FLOAT3, CreateBuffer(4 * 12, 100)));
+    mesh.AddVertexArray(SceneObjectVertexArray("TEXCOORD", VertexDataType::FLOAT2, CreateBuffer(4 * 8, 150)));
+    mesh.AddVertexArray(SceneObjectVertexArray("TEXCOORD1", VertexDataType::UNORM16_2, CreateBuffer(4 * 4, 200)));
+    mesh.AddVertexArray(SceneObjectVertexArray("WEIGHT", VertexDataType::FLOAT1, CreateBuffer(4 * 4, 220)));
+    return mesh;
+}
+
+TEST(VertexLayoutTest, ParseAttributeName) {
+    using Result = std::pair<VertexAttribute, uint32_t>;
+    EXPECT_EQ(SceneObjectVertexArray::ParseAttributeName("POSITION"), Result(VertexAttribute::POSITION, 0));
+    EXPECT_EQ(SceneObjectVertexArray::ParseAttributeName("TEXCOORD"), Result(VertexAttribute::TEXCOORD, 0));
+    EXPECT_EQ(SceneObjectVertexArray::ParseAttributeName("TEXCOORD0"), Result(VertexAttribute::TEXCOORD, 0));
+    EXPECT_EQ(SceneObjectVertexArray::ParseAttributeName("COLOR12"), Result(VertexAttribute::COLOR, 12));
+    EXPECT_EQ(SceneObjectVertexArray::ParseAttributeName("TEXCOORDS"), Result(VertexAttribute::CUSTOM, 0));
+    EXPECT_EQ(SceneObjectVertexArray::ParseAttributeName("WEIGHT"), Result(VertexAttribute::CUSTOM, 0));
+}
+
+TEST(VertexLayoutTest, GetVertexArray) {
+    auto mesh = CreateMesh();
+    ASSERT_NE(mesh.GetVertexArray(VertexAttribute::TEXCOORD, 1), nullptr);
+    EXPECT_EQ(mesh.GetVertexArray(VertexAttribute::TEXCOORD, 1)->GetAttributeName(), "TEXCOORD1");
+    EXPECT_EQ(mesh.GetVertexArray(VertexAttribute::COLOR), nullptr);
+
+    EXPECT_EQ(&mesh.GetVertexByName("TEXCOORD0"), mesh.GetVertexArray(VertexAttribute::TEXCOORD));
+    EXPECT_EQ(mesh.GetVertexByName("WEIGHT").GetAttribute(), VertexAttribute::CUSTOM);
+    EXPECT_THROW(mesh.GetVertexByName("COLOR"), std::range_error);
+}
+
+TEST(VertexLayoutTest, Separate) {
+    auto mesh    = CreateMesh();
+    auto streams = mesh.CreateVertexStreams();
+    ASSERT_EQ(streams.size(), mesh.GetVertexArraysCount());
+    for (size_t i = 0; i < streams.size(); i++) {
+        auto& array = mesh.GetVertexArrays()[i];
+        ASSERT_EQ(streams[i].elements.size(), 1);
+        EXPECT_EQ(streams[i].elements[0].attribute, array.GetAttribute());
+        EXPECT_EQ(streams[i].stride, array.GetVertexSize());
+        EXPECT_EQ(streams[i].vertexCount, 4);
+        ASSERT_EQ(streams[i].data.GetDataSize(), array.GetDataSize());
+        EXPECT_TRUE(std::equal(array.GetData(), array.GetData() + array.GetDataSize(), streams[i].data.GetData()));
+    }
+}
+
+TEST(VertexLayoutTest, Interleaved) {
+    auto mesh = CreateMesh();
+    mesh.SetVertexLayout(VertexLayout::INTERLEAVED);
+    auto streams = mesh.CreateVertexStreams();
+    ASSERT_EQ(streams.size(), 2);
+
+    // the position has its own stream
+    ASSERT_EQ(streams[0].elements.size(), 1);
+    EXPECT_EQ(streams[0].elements[0].attribute, VertexAttribute::POSITION);
+    EXPECT_EQ(streams[0].stride, sizeof(vec3f));
+
+    // the others are interleaved in the order of the arrays
+    auto& stream = streams[1];
+    ASSERT_EQ(stream.elements.size(), 4);
+    EXPECT_EQ(stream.stride, 4 + 8 + 4 + 4);
+    EXPECT_EQ(stream.vertexCount, 4);
+    ASSERT_EQ(stream.data.GetDataSize(), stream.vertexCount * stream.stride);
+    const std::array<std::pair<VertexAttribute, uint32_t>, 4> expected = {{
+        {VertexAttribute::NORMAL, 0},
+        {VertexAttribute::TEXCOORD, 0},
+        {VertexAttribute::TEXCOORD, 1},
+        {VertexAttribute::CUSTOM, 0},
+    }};
+    for (size_t i = 0; i < expected.size(); i++) {
+        auto& element = stream.elements[i];
+        EXPECT_EQ(element.attribute, expected[i].first);
+        EXPECT_EQ(element.semanticIndex, expected[i].second);
+
+        auto& array = element.attribute == VertexAttribute::CUSTOM ? mesh.GetVertexByName("WEIGHT") : *mesh.GetVertexArray(element.attribute, element.semanticIndex);
+        EXPECT_EQ(element.dataType, array.GetDataType());
+        for (size_t v = 0; v < stream.vertexCount; v++) {
+            const uint8_t* data = stream.data.GetData() + v * stream.stride + element.offset;
+            EXPECT_TRUE(std::equal(data, data + array.GetVertexSize(), array.GetData() + v * array.GetVertexSize()));
+        }
+    }
+}
+
+int main(int argc, char* argv[]) {
+    g_MemoryManager->Initialize();
+    g_FileIOManager->Initialize();
+    g_AssetManager->Initialize();
+
+    ::testing::InitGoogleTest(&argc, argv);
+    int testResult = RUN_ALL_TESTS();
+
+    g_AssetManager->Finalize();
+    g_FileIOManager->Finalize();
+    g_MemoryManager->Finalize();
+
+    return testResult;
+}
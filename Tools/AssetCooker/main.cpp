@@ -0,0 +1,66 @@
+#include "MemoryManager.hpp"
+#include "FileIOManager.hpp"
+#include "ThreadManager.hpp"
+#include "AssetManager.hpp"
+#include "AssetCooker.hpp"
+
+#include <iostream>
+#include <string_view>
+
+using namespace Hitagi;
+
+void PrintUsage() {
+    std::cerr << "Usage: AssetCooker <source dir> <output dir> [--no-mips] [--pack] [--no-interleave] [--no-lod] [--compression bc1|bc3|bc7|none]" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        PrintUsage();
+        return 1;
+    }
+
+    Asset::CookOptions options;
+    for (int i = 3; i < argc; i++) {
+        std::string_view arg = argv[i];
+        if (arg == "--no-mips") {
+            options.generateMips = false;
+        } else if (arg == "--pack") {
+            options.packVertices = true;
+        } else if (arg == "--no-interleave") {
+            options.interleaveVertices = false;
+        } else if (arg == "--no-lod") {
+            options.lodLevels.clear();
+        } else if (arg == "--compression" && i + 1 < argc) {
+            std::string_view format = argv[++i];
+            if (format == "bc1")
+                options.textureCompression = Asset::PixelFormat::BC1_UNORM;
+            else if (format == "bc3")
+                options.textureCompression = Asset::PixelFormat::BC3_UNORM;
+            else if (format == "bc7")
+                options.textureCompression = Asset::PixelFormat::BC7_UNORM;
+            else if (format == "none")
+                options.textureCompression = Asset::PixelFormat::UNKNOWN;
+            else {
+                PrintUsage();
+                return 1;
+            }
+        } else {
+            PrintUsage();
+            return 1;
+        }
+    }
+
+    g_MemoryManager->Initialize();
+    g_FileIOManager->Initialize();
+    g_ThreadManager->Initialize();
+    g_AssetManager->Initialize();
+
+    auto statistics = Asset::AssetCooker(argv[1], argv[2], options).Cook();
+
+    g_AssetManager->Finalize();
+    g_ThreadManager->Finalize();
+    g_FileIOManager->Finalize();
+    g_MemoryManager->Finalize();
+
+    return statistics.failed == 0 ? 0 : 1;
+}